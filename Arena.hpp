@@ -0,0 +1,160 @@
+#ifndef __ARENA_HPP__
+#define __ARENA_HPP__
+
+/* 	Arena.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Zone d'allocation (arena) d'objets d'un même type. Les objets sont
+ * construits à la suite dans de grands blocs contigus et ne sont jamais
+ * déplacés (leurs adresses restent valides) : un réseau peut donc garder des
+ * pointeurs vers ses systèmes locaux et ses connexions. Ils sont tous détruits
+ * avec l'arena. Construire un million de systèmes ne fait ainsi que quelques
+ * allocations au lieu d'un million (pas de fragmentation du tas).
+ *
+ *		"reserve(n)" garantit que les n prochains objets seront dans un seul
+ * bloc. ArenaBase permet à un propriétaire (voir Network::own) de détruire
+ * des arenas de types différents.
+ *
+ */
+
+#include <stddef.h>
+
+#include <new>
+#include <utility>
+#include <vector>
+
+class ArenaBase
+{
+	public:
+		ArenaBase(void){};
+		virtual ~ArenaBase(void){};
+
+		ArenaBase(const ArenaBase&) = delete;
+		ArenaBase &operator=(const ArenaBase&) = delete;
+};
+
+template<typename U>
+class Arena: public ArenaBase
+{
+	protected:
+		struct Block
+		{
+			U *data;
+			size_t capacity, used;
+		};
+
+		std::vector<Block> blocks;
+		size_t blocksize;
+		size_t count;
+
+		void grow(const size_t capacity);
+
+	public:
+		Arena(const size_t blocksize = 4096);
+		virtual ~Arena(void);
+
+		void reserve(const size_t n);
+
+		template<typename... A> U &create(A&&... arguments);
+
+		inline size_t size(void) const;
+};
+
+template<typename U>
+Arena<U>::Arena(const size_t blocksize)
+{
+	this->blocksize = (blocksize > 0) ? blocksize : 1;
+	this->count = 0;
+	return;
+}
+
+template<typename U>
+Arena<U>::~Arena(void)
+/*    Destruction dans l'ordre inverse de la construction.
+ */
+{
+	for (size_t b = this->blocks.size(); b > 0; --b)
+	{
+		Block &block = this->blocks[b-1];
+
+		for (size_t i = block.used; i > 0; --i)
+		{
+			block.data[i-1].~U();
+		}
+		::operator delete(block.data);
+	}
+	return;
+}
+
+template<typename U>
+void Arena<U>::grow(const size_t capacity)
+{
+	Block block;
+
+	block.data = static_cast<U*>(::operator new(capacity * sizeof(U)));
+	block.capacity = capacity;
+	block.used = 0;
+	this->blocks.push_back(block);
+	return;
+}
+
+template<typename U>
+void Arena<U>::reserve(const size_t n)
+{
+	if ( this->blocks.empty() || (this->blocks.back().capacity - this->blocks.back().used < n) )
+	{
+		this->grow( (n > this->blocksize) ? n : this->blocksize );
+	}
+	return;
+}
+
+template<typename U>
+template<typename... A>
+U &Arena<U>::create(A&&... arguments)
+{
+	U *object;
+
+	this->reserve(1);
+	Block &block = this->blocks.back();
+	object = new (block.data + block.used) U(std::forward<A>(arguments)...);
+	++block.used;
+	++this->count;
+	return *object;
+}
+
+template<typename U>
+inline size_t Arena<U>::size(void) const
+{
+	return this->count;
+}
+
+#endif
@@ -0,0 +1,336 @@
+#ifndef __ASYNCSINK_HPP__
+#define __ASYNCSINK_HPP__
+
+/* 	AsyncSink.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Sortie asynchrone : les échantillons sont copiés dans un anneau de blocs
+ * préalloués et une tâche de fond (std::thread) les transmet à une autre
+ * sortie (TextSink, BinarySink, ...) qui les formate, les compresse et les
+ * écrit. La boucle d'intégration ne fait donc qu'une copie par échantillon.
+ *
+ *		L'anneau est à un seul producteur (Simulation::run) et un seul
+ * consommateur (la tâche de fond) et ne prend aucun verrou : les positions de
+ * lecture et d'écriture sont des compteurs atomiques.
+ *
+ *		Lorsque l'anneau est plein (la sortie est plus lente que la simulation),
+ * le comportement dépend de la politique choisie :
+ *		- BLOCK : la simulation attend qu'un bloc se libère (aucune perte) ;
+ *		- DROP : les échantillons sont abandonnés jusqu'à ce qu'un bloc se
+ *		  libère, et comptés (voir "getdropped").
+ *
+ *		La tâche de fond est démarrée par "open" et arrêtée par "close" (après
+ * avoir vidé l'anneau). Une exception levée par la sortie dans la tâche de fond
+ * est relancée par "close", après la fermeture de la sortie. Si "close" n'a
+ * pas été appelé, le destructeur vide l'anneau et ferme la sortie ; une erreur
+ * est alors ignorée.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "OutputSink.hpp"
+
+template<typename T>
+class AsyncSink: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	public:
+		enum Policy { BLOCK, DROP };
+
+	protected:
+		OutputSink<T> *sink;
+		Policy policy;
+
+		size_t blockrows, nblocks;
+		size_type dimension;
+
+		std::vector<T> storage;				// nblocks * blockrows * (dimension+1)
+		std::vector<size_t> counts;			// Nombre de lignes de chaque bloc.
+
+		alignas(64) std::atomic<uint64_t> head;	// Blocs publiés par le producteur.
+		alignas(64) std::atomic<uint64_t> tail;	// Blocs traités par le consommateur.
+		alignas(64) std::atomic<bool> stopping;
+		std::atomic<bool> failed;
+
+		size_t rows;						// Lignes du bloc en cours de remplissage.
+		unsigned long dropped;
+
+		std::thread worker;
+		std::exception_ptr error;
+
+		inline T *block(const uint64_t index);
+		inline void publish(void);
+		static inline void backoff(unsigned int &spins);
+
+		void consume(void);
+
+	public:
+		AsyncSink(OutputSink<T> &sink, const size_t blockrows = 1024, const size_t nblocks = 8, const Policy policy = BLOCK);
+		virtual ~AsyncSink(void);
+
+		inline unsigned long getdropped(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+AsyncSink<T>::AsyncSink(OutputSink<T> &sink, const size_t blockrows, const size_t nblocks, const Policy policy)
+{
+	this->sink = &sink;
+	this->policy = policy;
+	this->blockrows = (blockrows > 0) ? blockrows : 1;
+	this->nblocks = (nblocks > 1) ? nblocks : 2;
+	this->dimension = 0;
+	this->head = 0;
+	this->tail = 0;
+	this->stopping = false;
+	this->failed = false;
+	this->rows = 0;
+	this->dropped = 0;
+	return;
+}
+
+template<typename T>
+AsyncSink<T>::~AsyncSink(void)
+{
+	try
+	{
+		this->close();
+	}
+	catch (...)
+	{
+		// Pas d'exception hors d'un destructeur : l'erreur est perdue.
+	}
+	return;
+}
+
+template<typename T>
+inline unsigned long AsyncSink<T>::getdropped(void) const
+{
+	return this->dropped;
+}
+
+
+
+template<typename T>
+inline T* AsyncSink<T>::block(const uint64_t index)
+{
+	return &this->storage[(index % this->nblocks) * this->blockrows * (this->dimension + 1)];
+}
+
+template<typename T>
+inline void AsyncSink<T>::backoff(unsigned int &spins)
+{
+	if (spins < 64)
+	{
+		std::this_thread::yield();
+	}
+	else
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds(50));
+	}
+	++spins;
+	return;
+}
+
+template<typename T>
+inline void AsyncSink<T>::publish(void)
+{
+	const uint64_t h = this->head.load(std::memory_order_relaxed);
+
+	this->counts[h % this->nblocks] = this->rows;
+	this->head.store(h + 1, std::memory_order_release);
+	this->rows = 0;
+	return;
+}
+
+
+
+template<typename T>
+void AsyncSink<T>::open(const size_type dimension, const T samplingstep)
+{
+	if (this->worker.joinable())
+	{
+		this->close();
+	}
+
+	this->dimension = dimension;
+	this->storage.assign(this->nblocks * this->blockrows * (dimension + 1), (T)0);
+	this->counts.assign(this->nblocks, 0);
+	this->head.store(0, std::memory_order_relaxed);
+	this->tail.store(0, std::memory_order_relaxed);
+	this->stopping.store(false, std::memory_order_relaxed);
+	this->failed.store(false, std::memory_order_relaxed);
+	this->rows = 0;
+	this->error = std::exception_ptr();
+
+	this->sink->open(dimension, samplingstep);
+	this->worker = std::thread(&AsyncSink<T>::consume, this);
+	return;
+}
+
+template<typename T>
+void AsyncSink<T>::write(const T t, const SystemStates<T> &states)
+{
+	T *row;
+	unsigned int spins = 0;
+
+	if (this->rows == 0)
+	{
+		// Début d'un bloc : il faut qu'un bloc de l'anneau soit libre.
+		while (this->head.load(std::memory_order_relaxed) - this->tail.load(std::memory_order_acquire) >= this->nblocks)
+		{
+			if ( (this->policy == DROP) || this->failed.load(std::memory_order_acquire) )
+			{
+				++this->dropped;
+				return;
+			}
+			backoff(spins);
+		}
+	}
+
+	row = this->block(this->head.load(std::memory_order_relaxed)) + this->rows * (this->dimension + 1);
+	row[0] = t;
+	std::copy(states.data(), states.data() + this->dimension, row + 1);
+
+	if (++this->rows >= this->blockrows)
+	{
+		this->publish();
+	}
+	return;
+}
+
+template<typename T>
+void AsyncSink<T>::close(void)
+{
+	std::exception_ptr error;
+
+	if (!this->worker.joinable())
+	{
+		return;
+	}
+
+	if (this->rows > 0)
+	{
+		// Il reste toujours un bloc libre pour le bloc en cours.
+		this->publish();
+	}
+	this->stopping.store(true, std::memory_order_release);
+	this->worker.join();
+
+	error = this->error;
+	this->error = std::exception_ptr();
+	if (error)
+	{
+		// La sortie est fermée malgré l'échec, sans masquer l'erreur d'origine.
+		try
+		{
+			this->sink->close();
+		}
+		catch (...)
+		{
+		}
+		std::rethrow_exception(error);
+	}
+
+	this->sink->close();
+	return;
+}
+
+
+
+template<typename T>
+void AsyncSink<T>::consume(void)
+/*    Tâche de fond : transmet les blocs publiés à la sortie, jusqu'à l'arrêt.
+ */
+{
+	SystemStates<T> states(this->dimension);
+	unsigned int spins = 0;
+	uint64_t t, h;
+	const T *row;
+
+	try
+	{
+		for (;;)
+		{
+			t = this->tail.load(std::memory_order_relaxed);
+			h = this->head.load(std::memory_order_acquire);
+
+			if (t < h)
+			{
+				row = this->block(t);
+				for (size_t r = 0; r < this->counts[t % this->nblocks]; ++r)
+				{
+					std::copy(row + 1, row + 1 + this->dimension, states.data());
+					this->sink->write(row[0], states);
+					row += this->dimension + 1;
+				}
+				this->tail.store(t + 1, std::memory_order_release);
+				spins = 0;
+			}
+			else if (this->stopping.load(std::memory_order_acquire))
+			{
+				// Les publications précèdent l'arrêt : l'anneau est vide.
+				if (this->head.load(std::memory_order_acquire) == t)
+				{
+					return;
+				}
+			}
+			else
+			{
+				backoff(spins);
+			}
+		}
+	}
+	catch (...)
+	{
+		this->error = std::current_exception();
+		// Libère le producteur (politique BLOCK) : les échantillons suivants sont perdus.
+		this->failed.store(true, std::memory_order_release);
+	}
+	return;
+}
+
+
+#endif
@@ -0,0 +1,643 @@
+#ifndef __BASINMAPPER_HPP__
+#define __BASINMAPPER_HPP__
+
+/* 	BasinMapper.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Carte des bassins d'attraction sur une tranche 2D de conditions
+ * initiales : pour chaque pixel (les états "ix" et "iy" varient, les autres
+ * valent ceux de l'état de base), on détermine l'attracteur atteint.
+ *
+ *		- Les attracteurs connus sont stockés dans une table de hachage
+ *		  spatiale (AttractorSet) : l'espace d'état est découpé en cellules de
+ *		  côté "radius" et chaque cellule visitée par un attracteur porte son
+ *		  numéro. La table est partagée par les tâches de fond (lectures
+ *		  concurrentes, écritures exclusives : std::shared_mutex).
+ *		- Arrêt anticipé : après "tmin", l'état est testé tous les "checkevery"
+ *		  pas ; dès que "confirm" tests tombent dans des cellules d'un même
+ *		  attracteur, le pixel lui est attribué. Une trajectoire qui sort de la
+ *		  boule de rayon "escape" (ou devient non finie) est marquée ESCAPED.
+ *		- Si aucun attracteur connu n'est atteint à "tmax", la trajectoire est
+ *		  prolongée de "trecord" et les cellules visitées forment un nouvel
+ *		  attracteur (ou complètent un attracteur connu qu'elles rencontrent).
+ *		- Raffinement adaptatif : seuls les coins de carrés de 2^levels pixels
+ *		  sont intégrés. Un carré dont les quatre coins ont le même attracteur
+ *		  est rempli sans intégration ; les autres (près des frontières des
+ *		  bassins) sont découpés en quatre, et ainsi de suite jusqu'au pixel.
+ *		  Un bassin plus petit qu'un carré initial peut donc être manqué :
+ *		  "setlevels(0)" intègre tous les pixels (2 par défaut : carrés de 4
+ *		  pixels de côté).
+ *
+ *		Les systèmes et intégrateurs des tâches de fond sont créés par une
+ * SweepFactory (voir Sweep.hpp) dont "parameters" est appelée une fois avec
+ * les paramètres donnés par "setparameters".
+ *
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "DynamicalSystem.hpp"
+#include "Integrators.hpp"
+#include "Simulation.hpp"
+#include "Sweep.hpp"
+#include "ThreadPool.hpp"
+
+/*	AttractorSet
+ */
+template<typename T>
+class AttractorSet
+{
+	public:
+		typedef std::vector<int64_t> Cell;
+
+	protected:
+		struct CellHash
+		{
+			inline size_t operator()(const Cell &cell) const
+			{
+				uint64_t hash = 14695981039346656037ULL;
+				for (size_t i = 0; i < cell.size(); ++i)
+				{
+					hash ^= (uint64_t)cell[i];
+					hash *= 1099511628211ULL;
+				}
+				return (size_t)hash;
+			}
+		};
+
+		T radius;
+		std::unordered_map<Cell, int, CellHash> cells;
+		int count;
+
+		mutable std::shared_mutex mutex;
+
+	public:
+		AttractorSet(const T radius = (T)0.5);
+		virtual ~AttractorSet(void){};
+
+		void clear(const T radius);
+
+		inline void cell(const T *x, const size_t size, Cell &cell) const;
+
+		int find(const Cell &cell) const;
+		int insert(const std::vector<Cell> &cells);
+
+		inline int size(void) const;
+};
+
+template<typename T>
+AttractorSet<T>::AttractorSet(const T radius)
+{
+	this->clear(radius);
+	return;
+}
+
+template<typename T>
+void AttractorSet<T>::clear(const T radius)
+{
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+
+	if (!(radius > (T)0))
+	{
+		throw std::invalid_argument("AttractorSet::clear");
+	}
+	this->radius = radius;
+	this->cells.clear();
+	this->count = 0;
+	return;
+}
+
+template<typename T>
+inline void AttractorSet<T>::cell(const T *x, const size_t size, Cell &cell) const
+{
+	cell.resize(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		cell[i] = (int64_t)floor((double)(x[i] / this->radius));
+	}
+	return;
+}
+
+template<typename T>
+int AttractorSet<T>::find(const Cell &cell) const
+/*    Numéro de l'attracteur qui a visité la cellule, -1 sinon.
+ */
+{
+	std::shared_lock<std::shared_mutex> lock(this->mutex);
+	typename std::unordered_map<Cell, int, CellHash>::const_iterator it = this->cells.find(cell);
+
+	return (it == this->cells.end()) ? -1 : it->second;
+}
+
+template<typename T>
+int AttractorSet<T>::insert(const std::vector<Cell> &cells)
+/*    Ajoute les cellules d'une trajectoire asymptotique. Si l'une d'elles
+ * appartient déjà à un attracteur (découvert entre-temps par une autre tâche),
+ * les cellules lui sont ajoutées ; sinon un nouvel attracteur est créé.
+ * Renvoie son numéro.
+ */
+{
+	std::unique_lock<std::shared_mutex> lock(this->mutex);
+	typename std::unordered_map<Cell, int, CellHash>::const_iterator it;
+	int label = -1;
+
+	for (size_t i = 0; (i < cells.size()) && (label < 0); ++i)
+	{
+		it = this->cells.find(cells[i]);
+		if (it != this->cells.end())
+		{
+			label = it->second;
+		}
+	}
+	if (label < 0)
+	{
+		label = this->count++;
+	}
+	for (size_t i = 0; i < cells.size(); ++i)
+	{
+		this->cells.insert(std::make_pair(cells[i], label));
+	}
+	return label;
+}
+
+template<typename T>
+inline int AttractorSet<T>::size(void) const
+{
+	std::shared_lock<std::shared_mutex> lock(this->mutex);
+	return this->count;
+}
+
+
+
+/*	BasinMapper
+ */
+template<typename T>
+class BasinMapper
+{
+	public: typedef typename std::vector<T>::size_type size_type;
+
+	public:
+		enum { UNKNOWN = -2, ESCAPED = -1 };
+
+	protected:
+		struct Workspace
+		{
+			DynamicalSystem<T> *system;
+			Integrator<T> *integrator;
+			Simulation<T> *simulation;
+		};
+
+		/* Carré de pixels [x0, x1] x [y0, y1] (coins compris). */
+		struct Square
+		{
+			size_type x0, y0, x1, y1;
+		};
+
+		SweepFactory<T> *factory;
+		T p1, p2;
+
+		std::vector<T> x0;
+		size_type ix, iy, nx, ny;
+		T xmin, xmax, ymin, ymax;
+
+		unsigned int levels;
+		T tmin, tmax, trecord;
+		T radius, escape;
+		unsigned int confirm, checkevery;
+
+		AttractorSet<T> attractors;
+		std::vector<int> labels;
+		unsigned long integrated;
+
+		int classify(Workspace &workspace, const size_type i, const size_type j);
+		inline bool escaped(const DynamicalSystem<T> &system) const;
+		inline bool uniform(const Square &square, int &label) const;
+		void fill(const Square &square, const int label);
+		static void release(std::vector<Workspace> &workspaces);
+
+	public:
+		BasinMapper(SweepFactory<T> &factory);
+		virtual ~BasinMapper(void){};
+
+		inline void setparameters(const T p1, const T p2 = (T)0);
+		inline void initial(const std::vector<T> &x0);
+		void slice(const size_type ix, const T xmin, const T xmax, const size_type nx, const size_type iy, const T ymin, const T ymax, const size_type ny);
+
+		inline void setlevels(const unsigned int levels);
+		inline void settimes(const T tmin, const T tmax, const T trecord);
+		inline void setneighbourhood(const T radius, const unsigned int confirm, const unsigned int checkevery);
+		inline void setescape(const T escape);
+
+		void run(ThreadPool &pool);
+
+		inline int getlabel(const size_type i, const size_type j) const;
+		inline const std::vector<int> &getlabels(void) const;
+		inline int getattractors(void) const;
+		inline unsigned long getintegrated(void) const;
+};
+
+template<typename T>
+BasinMapper<T>::BasinMapper(SweepFactory<T> &factory)
+{
+	this->factory = &factory;
+	this->p1 = (T)0;
+	this->p2 = (T)0;
+	this->ix = 0;
+	this->iy = 1;
+	this->nx = 0;
+	this->ny = 0;
+	this->xmin = this->xmax = this->ymin = this->ymax = (T)0;
+	this->levels = 2;
+	this->settimes((T)50, (T)1000, (T)200);
+	this->setneighbourhood((T)0.5, 10, 10);
+	this->escape = (T)1e6;
+	this->integrated = 0;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::setparameters(const T p1, const T p2)
+{
+	this->p1 = p1;
+	this->p2 = p2;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::initial(const std::vector<T> &x0)
+/*    État de base (les états hors de la tranche). Par défaut, l'état du
+ * système créé par la fabrique.
+ */
+{
+	this->x0 = x0;
+	return;
+}
+
+template<typename T>
+void BasinMapper<T>::slice(const size_type ix, const T xmin, const T xmax, const size_type nx, const size_type iy, const T ymin, const T ymax, const size_type ny)
+{
+	if ( (ix == iy) || (nx < 2) || (ny < 2) )
+	{
+		throw std::invalid_argument("BasinMapper::slice");
+	}
+	this->ix = ix;
+	this->iy = iy;
+	this->nx = nx;
+	this->ny = ny;
+	this->xmin = xmin;
+	this->xmax = xmax;
+	this->ymin = ymin;
+	this->ymax = ymax;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::setlevels(const unsigned int levels)
+{
+	this->levels = (levels < 16) ? levels : 16;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::settimes(const T tmin, const T tmax, const T trecord)
+{
+	this->tmin = tmin;
+	this->tmax = tmax;
+	this->trecord = trecord;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::setneighbourhood(const T radius, const unsigned int confirm, const unsigned int checkevery)
+{
+	this->radius = radius;
+	this->confirm = (confirm > 0) ? confirm : 1;
+	this->checkevery = (checkevery > 0) ? checkevery : 1;
+	return;
+}
+
+template<typename T>
+inline void BasinMapper<T>::setescape(const T escape)
+{
+	this->escape = escape;
+	return;
+}
+
+template<typename T>
+inline int BasinMapper<T>::getlabel(const size_type i, const size_type j) const
+{
+	return this->labels.at(j * this->nx + i);
+}
+
+template<typename T>
+inline const std::vector<int>& BasinMapper<T>::getlabels(void) const
+{
+	return this->labels;
+}
+
+template<typename T>
+inline int BasinMapper<T>::getattractors(void) const
+{
+	return this->attractors.size();
+}
+
+template<typename T>
+inline unsigned long BasinMapper<T>::getintegrated(void) const
+/*    Nombre de pixels effectivement intégrés (les autres sont déduits).
+ */
+{
+	return this->integrated;
+}
+
+
+
+template<typename T>
+inline bool BasinMapper<T>::escaped(const DynamicalSystem<T> &system) const
+{
+	const T *x = system.data();
+
+	for (long k = 0; k < system.size(); ++k)
+	{
+		if ( !(x[k] <= this->escape) || !(x[k] >= -this->escape) )
+		{
+			return true;	// Hors de la boule, ou NaN.
+		}
+	}
+	return false;
+}
+
+template<typename T>
+int BasinMapper<T>::classify(Workspace &workspace, const size_type i, const size_type j)
+{
+	DynamicalSystem<T> &system = *workspace.system;
+	Simulation<T> &simulation = *workspace.simulation;
+	FixedStepIntegrator<T> *fixedstep = dynamic_cast< FixedStepIntegrator<T>* >(workspace.integrator);
+	typename AttractorSet<T>::Cell cell;
+	std::vector<typename AttractorSet<T>::Cell> visited;
+	unsigned long steps = 0;
+	unsigned int hits = 0;
+	int label, last = -1;
+
+	for (long k = 0; k < system.size(); ++k)
+	{
+		system[k] = this->x0[k];
+	}
+	system[this->ix] = this->xmin + (this->xmax - this->xmin) * (T)i / (T)(this->nx - 1);
+	system[this->iy] = this->ymin + (this->ymax - this->ymin) * (T)j / (T)(this->ny - 1);
+	if (fixedstep != NULL)
+	{
+		fixedstep->resetcompensation();
+	}
+	simulation.setTime((T)0);
+
+	while (simulation.getTime() < this->tmax)
+	{
+		simulation.step();
+		if (++steps % this->checkevery != 0)
+		{
+			continue;
+		}
+		if (this->escaped(system))
+		{
+			return ESCAPED;
+		}
+		if (simulation.getTime() < this->tmin)
+		{
+			continue;
+		}
+
+		this->attractors.cell(system.data(), system.size(), cell);
+		label = this->attractors.find(cell);
+		if (label >= 0)
+		{
+			hits = (label == last) ? hits + 1 : 1;
+			last = label;
+			if (hits >= this->confirm)
+			{
+				return label;
+			}
+		}
+	}
+
+	// Aucun attracteur connu : la suite de la trajectoire en définit un.
+	while (simulation.getTime() < this->tmax + this->trecord)
+	{
+		simulation.step();
+		if (this->escaped(system))
+		{
+			return ESCAPED;
+		}
+		this->attractors.cell(system.data(), system.size(), cell);
+		if ( visited.empty() || (cell != visited.back()) )
+		{
+			visited.push_back(cell);
+		}
+	}
+	std::sort(visited.begin(), visited.end());
+	visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+	return this->attractors.insert(visited);
+}
+
+template<typename T>
+inline bool BasinMapper<T>::uniform(const Square &square, int &label) const
+{
+	label = this->labels[square.y0 * this->nx + square.x0];
+	return (this->labels[square.y0 * this->nx + square.x1] == label) &&
+		   (this->labels[square.y1 * this->nx + square.x0] == label) &&
+		   (this->labels[square.y1 * this->nx + square.x1] == label);
+}
+
+template<typename T>
+void BasinMapper<T>::fill(const Square &square, const int label)
+{
+	for (size_type j = square.y0; j <= square.y1; ++j)
+	{
+		for (size_type i = square.x0; i <= square.x1; ++i)
+		{
+			if (this->labels[j * this->nx + i] == UNKNOWN)
+			{
+				this->labels[j * this->nx + i] = label;
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void BasinMapper<T>::release(std::vector<Workspace> &workspaces)
+{
+	for (size_t w = 0; w < workspaces.size(); ++w)
+	{
+		delete workspaces[w].simulation;
+		delete workspaces[w].integrator;
+		delete workspaces[w].system;
+	}
+	workspaces.clear();
+	return;
+}
+
+template<typename T>
+void BasinMapper<T>::run(ThreadPool &pool)
+/*    Les attracteurs trouvés lors d'un "run" précédent sont conservés (même
+ * système, mêmes paramètres) : ils accélèrent les tranches suivantes.
+ */
+{
+	const size_type side = (size_type)1 << this->levels;
+	std::vector<Workspace> workspaces(pool.size());
+	std::vector<Square> squares, next;
+	std::vector<size_type> pending;
+	Square square, part;
+	size_type xm, ym;
+	int label;
+
+	if ( (this->nx < 2) || (this->ny < 2) )
+	{
+		throw std::logic_error("BasinMapper::run : no slice");
+	}
+	if (this->attractors.size() == 0)
+	{
+		this->attractors.clear(this->radius);
+	}
+
+	for (size_t w = 0; w < workspaces.size(); ++w)
+	{
+		workspaces[w].system = this->factory->system();
+		workspaces[w].integrator = this->factory->integrator();
+		workspaces[w].simulation = new Simulation<T>(*workspaces[w].system, *workspaces[w].integrator);
+		this->factory->parameters(*workspaces[w].system, this->p1, this->p2);
+	}
+	if (this->x0.empty())
+	{
+		const T *x = workspaces[0].system->data();
+		this->x0.assign(x, x + workspaces[0].system->size());
+	}
+
+	// Carrés initiaux (ceux du bord sont tronqués).
+	for (size_type y = 0; y + 1 < this->ny; y += side)
+	{
+		for (size_type x = 0; x + 1 < this->nx; x += side)
+		{
+			square.x0 = x;
+			square.y0 = y;
+			square.x1 = std::min(x + side, this->nx - 1);
+			square.y1 = std::min(y + side, this->ny - 1);
+			squares.push_back(square);
+		}
+	}
+
+	this->labels.assign(this->nx * this->ny, UNKNOWN);
+	this->integrated = 0;
+	try
+	{
+		if ( ((long)this->x0.size() != workspaces[0].system->size()) ||
+			 ((long)this->ix >= workspaces[0].system->size()) || ((long)this->iy >= workspaces[0].system->size()) )
+		{
+			throw std::invalid_argument("BasinMapper::run : state size mismatch");
+		}
+
+		while (!squares.empty())
+		{
+			// Coins non encore calculés.
+			pending.clear();
+			for (size_t s = 0; s < squares.size(); ++s)
+			{
+				const size_type corners[4] = {
+					squares[s].y0 * this->nx + squares[s].x0, squares[s].y0 * this->nx + squares[s].x1,
+					squares[s].y1 * this->nx + squares[s].x0, squares[s].y1 * this->nx + squares[s].x1 };
+				for (int c = 0; c < 4; ++c)
+				{
+					if (this->labels[corners[c]] == UNKNOWN)
+					{
+						pending.push_back(corners[c]);
+					}
+				}
+			}
+			std::sort(pending.begin(), pending.end());
+			pending.erase(std::unique(pending.begin(), pending.end()), pending.end());
+
+			pool.run(pending.size(), [&](size_t task, size_t worker)
+			{
+				const size_type k = pending[task];
+				this->labels[k] = this->classify(workspaces[worker], k % this->nx, k / this->nx);
+			});
+			this->integrated += pending.size();
+
+			// Remplissage des carrés homogènes, découpage des autres.
+			next.clear();
+			for (size_t s = 0; s < squares.size(); ++s)
+			{
+				square = squares[s];
+				if (this->uniform(square, label))
+				{
+					this->fill(square, label);
+					continue;
+				}
+				if ( (square.x1 - square.x0 <= 1) && (square.y1 - square.y0 <= 1) )
+				{
+					continue;		// Tous les pixels sont des coins.
+				}
+				xm = (square.x1 - square.x0 >= 2) ? (square.x0 + square.x1) / 2 : square.x1;
+				ym = (square.y1 - square.y0 >= 2) ? (square.y0 + square.y1) / 2 : square.y1;
+				for (int q = 0; q < 4; ++q)
+				{
+					part.x0 = (q & 1) ? xm : square.x0;
+					part.x1 = (q & 1) ? square.x1 : xm;
+					part.y0 = (q & 2) ? ym : square.y0;
+					part.y1 = (q & 2) ? square.y1 : ym;
+					if ( (part.x0 < part.x1) && (part.y0 < part.y1) )
+					{
+						next.push_back(part);
+					}
+				}
+			}
+			squares.swap(next);
+		}
+	}
+	catch (...)
+	{
+		release(workspaces);
+		throw;
+	}
+	release(workspaces);
+	return;
+}
+
+
+#endif
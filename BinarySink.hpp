@@ -0,0 +1,273 @@
+#ifndef __BINARYSINK_HPP__
+#define __BINARYSINK_HPP__
+
+/* 	BinarySink.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Sortie binaire en colonnes (voir TrajectoryFormat.hpp pour le format).
+ * Les échantillons sont rangés par blocs de "chunkrows" lignes : dans un bloc,
+ * le temps puis chaque état forment une colonne contiguë. Chaque bloc est
+ * écrit en une seule fois, sa taille étant un multiple de "alignment" (4096
+ * octets par défaut, arrondi au multiple de 64 et de sizeof(T) supérieur).
+ *		Le flux doit être ouvert en mode binaire (std::ios::binary). L'en-tête
+ * est écrit au premier "open" : plusieurs "run" peuvent se suivre sur la même
+ * sortie tant que la dimension ne change pas.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OutputSink.hpp"
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class BinarySink: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::ostream *ostream;
+
+		TrajectoryHeader header;
+		bool started;
+
+		uint64_t capacity;		// Nombre de lignes par bloc.
+		uint64_t rows;			// Nombre de lignes du bloc courant.
+		double tfirst, tlast;
+		std::vector<char> buffer;
+
+		inline char *column(const uint64_t c);
+		void flush(void);
+
+	public:
+		BinarySink(std::ostream &ostream);
+		BinarySink(std::ostream &ostream, const uint32_t chunkrows, const uint32_t alignment = 4096);
+		virtual ~BinarySink(void){};
+
+		void setnames(const std::vector<std::string> &names);
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+BinarySink<T>::BinarySink(std::ostream &ostream)
+{
+	this->ostream = &ostream;
+	this->started = false;
+	this->rows = 0;
+	this->capacity = 0;
+	this->header.alignment = 4096;
+	this->header.chunkrows = 0;
+	return;
+}
+
+template<typename T>
+BinarySink<T>::BinarySink(std::ostream &ostream, const uint32_t chunkrows, const uint32_t alignment)
+/*    L'alignement est arrondi au multiple de 64 (taille de l'en-tête de bloc)
+ * et de sizeof(T) supérieur, afin que les colonnes lues restent alignées.
+ */
+{
+	uint64_t unit = TrajectoryChunk::SIZE;
+	uint64_t rounded;
+
+	while (unit % sizeof(T) != 0)
+	{
+		unit += TrajectoryChunk::SIZE;
+	}
+	rounded = BinaryFormat::align((alignment > 0) ? alignment : 1, unit);
+	if (rounded > 0xFFFFFFFFu)
+	{
+		throw std::invalid_argument("BinarySink::BinarySink");
+	}
+
+	this->ostream = &ostream;
+	this->started = false;
+	this->rows = 0;
+	this->capacity = 0;
+	this->header.alignment = (uint32_t)rounded;
+	this->header.chunkrows = chunkrows;
+	return;
+}
+
+template<typename T>
+void BinarySink<T>::setnames(const std::vector<std::string> &names)
+{
+	if (this->started)
+	{
+		throw std::logic_error("BinarySink::setnames");
+	}
+	this->header.names = names;
+	return;
+}
+
+
+
+template<typename T>
+void BinarySink<T>::open(const size_type dimension, const T samplingstep)
+{
+	std::string encoded;
+
+	if (this->started)
+	{
+		if (dimension != this->header.dimension)
+		{
+			throw std::invalid_argument("BinarySink::open");
+		}
+		return;
+	}
+
+	if (this->header.names.empty())
+	{
+		for (size_type i = 0; i < dimension; ++i)
+		{
+			std::ostringstream oss;
+			oss << "x" << i;
+			this->header.names.push_back(oss.str());
+		}
+	}
+	else if (this->header.names.size() != dimension)
+	{
+		throw std::invalid_argument("BinarySink::open");
+	}
+
+	if (this->header.chunkrows == 0)
+	{
+		// Environ 1 Mo par bloc.
+		this->header.chunkrows = (uint32_t)( ((uint64_t)1 << 20) / ((dimension + 1) * sizeof(T)) );
+		if (this->header.chunkrows == 0)
+		{
+			this->header.chunkrows = 1;
+		}
+	}
+
+	this->header.layout = TrajectoryHeader::COLUMNAR;
+	this->header.typecode = BinaryType<T>::code;
+	this->header.typesize = sizeof(T);
+	this->header.dimension = dimension;
+	this->header.samplingstep = (double)samplingstep;
+	this->header.encode(encoded);
+
+	this->capacity = this->header.chunkrows;
+	this->rows = 0;
+	this->buffer.assign(BinaryFormat::align(TrajectoryChunk::SIZE + (dimension + 1) * this->capacity * sizeof(T), this->header.alignment), '\0');
+
+	this->ostream->write(encoded.data(), encoded.size());
+	this->started = true;
+	return;
+}
+
+template<typename T>
+inline char* BinarySink<T>::column(const uint64_t c)
+{
+	return &this->buffer[TrajectoryChunk::SIZE + c * this->capacity * sizeof(T)];
+}
+
+template<typename T>
+void BinarySink<T>::write(const T t, const SystemStates<T> &states)
+{
+	const T *x = states.data();
+	const uint64_t offset = this->rows * sizeof(T);
+
+	if (this->rows == 0)
+	{
+		this->tfirst = (double)t;
+	}
+	this->tlast = (double)t;
+
+	BinaryFormat::store(this->column(0) + offset, t);
+	for (uint64_t i = 0; i < this->header.dimension; ++i)
+	{
+		BinaryFormat::store(this->column(i + 1) + offset, x[i]);
+	}
+
+	if (++this->rows >= this->capacity)
+	{
+		this->flush();
+	}
+	return;
+}
+
+template<typename T>
+void BinarySink<T>::flush(void)
+/*    Écrit le bloc courant. Un bloc incomplet est d'abord compacté (colonnes de
+ * "rows" valeurs) puis complété par des zéros jusqu'à l'alignement.
+ */
+{
+	TrajectoryChunk chunk;
+	uint64_t used;
+
+	if (this->rows == 0)
+	{
+		return;
+	}
+
+	if (this->rows < this->capacity)
+	{
+		for (uint64_t c = 1; c <= this->header.dimension; ++c)
+		{
+			memmove(&this->buffer[TrajectoryChunk::SIZE + c * this->rows * sizeof(T)], this->column(c), this->rows * sizeof(T));
+		}
+	}
+
+	used = TrajectoryChunk::SIZE + (this->header.dimension + 1) * this->rows * sizeof(T);
+
+	chunk.rows = this->rows;
+	chunk.bytes = BinaryFormat::align(used, this->header.alignment);
+	chunk.tfirst = this->tfirst;
+	chunk.tlast = this->tlast;
+	chunk.encode(&this->buffer[0]);
+	memset(&this->buffer[used], 0, chunk.bytes - used);
+
+	this->ostream->write(&this->buffer[0], chunk.bytes);
+	this->rows = 0;
+	return;
+}
+
+template<typename T>
+void BinarySink<T>::close(void)
+{
+	this->flush();
+	this->ostream->flush();
+	return;
+}
+
+
+#endif
@@ -0,0 +1,359 @@
+#ifndef __CHECKPOINT_HPP__
+#define __CHECKPOINT_HPP__
+
+/* 	Checkpoint.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Point de reprise (checkpoint) d'une simulation : temps, compteur
+ * d'écriture, états et sorties du système dynamique (d'un réseau par exemple)
+ * et état interne de l'intégrateur (voir Integrator::save). Il est rempli par
+ * Simulation::snapshot et appliqué par Simulation::restore ; Checkpointer
+ * l'écrit périodiquement pendant la simulation.
+ *
+ *	Format du fichier (petit-boutiste) :
+ *		 0	char[8]		"SYSSIMCK"
+ *		 8	uint32		version
+ *		12	uint32		code du type des valeurs (voir BinaryType)
+ *		16	uint32		taille (octets) d'une valeur
+ *		20	uint32		réservé
+ *		24	uint64		taille des données
+ *		32	uint64		somme de contrôle des données (FNV-1a 64 bits)
+ *		40				données : temps, int64 WSmax, int64 WScount,
+ *						uint64 nx suivi des nx états, uint64 ny suivi des ny
+ *						sorties, uint64 n suivi des n octets de l'intégrateur.
+ *
+ *		"write" écrit d'abord un fichier temporaire ("path.tmp"), le synchronise
+ * sur le disque puis le renomme : un fichier de reprise est toujours complet,
+ * même si le programme est interrompu pendant l'écriture. "read" projette le
+ * fichier en mémoire (mmap) et vérifie la somme de contrôle.
+ *
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class Checkpoint
+{
+	public:
+		static const uint32_t version = 1;
+		static const size_t headersize = 40;
+
+		T time;
+		long WSmax, WScount;
+		std::vector<T> x;
+		std::vector<T> y;
+		std::string integrator;
+
+		Checkpoint(void);
+		virtual ~Checkpoint(void){};
+
+		void encode(std::string &buffer) const;
+		void decode(const char *data, const size_t size);
+
+		static uint64_t checksum(const char *data, const size_t size);
+		static inline bool take(const char *&p, const char *end, const uint64_t size);
+
+		static void write(const std::string &path, const std::string &buffer);
+		void write(const std::string &path) const;
+		bool read(const std::string &path);
+};
+
+template<typename T>
+Checkpoint<T>::Checkpoint(void)
+{
+	this->time = (T)0;
+	this->WSmax = 0;
+	this->WScount = 0;
+	return;
+}
+
+template<typename T>
+uint64_t Checkpoint<T>::checksum(const char *data, const size_t size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+template<typename T>
+inline bool Checkpoint<T>::take(const char *&p, const char *end, const uint64_t size)
+/*    Avance "p" de "size" octets s'il en reste assez avant "end".
+ */
+{
+	if (size > (uint64_t)(end - p))
+	{
+		return false;
+	}
+	p += size;
+	return true;
+}
+
+template<typename T>
+void Checkpoint<T>::encode(std::string &buffer) const
+{
+	std::string::size_type start;
+
+	buffer.clear();
+	buffer.reserve(headersize + sizeof(T) * (1 + this->x.size() + this->y.size()) + 40 + this->integrator.size());
+	buffer.append("SYSSIMCK", 8);
+	BinaryFormat::append(buffer, (uint32_t)version);
+	BinaryFormat::append(buffer, (uint32_t)BinaryType<T>::code);
+	BinaryFormat::append(buffer, (uint32_t)sizeof(T));
+	BinaryFormat::append(buffer, (uint32_t)0);
+	BinaryFormat::append(buffer, (uint64_t)0);		// Taille, complétée à la fin.
+	BinaryFormat::append(buffer, (uint64_t)0);		// Somme de contrôle.
+
+	start = buffer.size();
+	BinaryFormat::append(buffer, this->time);
+	BinaryFormat::append(buffer, (int64_t)this->WSmax);
+	BinaryFormat::append(buffer, (int64_t)this->WScount);
+	BinaryFormat::append(buffer, (uint64_t)this->x.size());
+	for (size_t i = 0; i < this->x.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->x[i]);
+	}
+	BinaryFormat::append(buffer, (uint64_t)this->y.size());
+	for (size_t i = 0; i < this->y.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->y[i]);
+	}
+	BinaryFormat::append(buffer, (uint64_t)this->integrator.size());
+	buffer.append(this->integrator);
+
+	BinaryFormat::store(&buffer[24], (uint64_t)(buffer.size() - start));
+	BinaryFormat::store(&buffer[32], checksum(buffer.data() + start, buffer.size() - start));
+	return;
+}
+
+template<typename T>
+void Checkpoint<T>::decode(const char *data, const size_t size)
+/*    Vérifie l'en-tête, la taille et la somme de contrôle avant de lire les
+ * valeurs. En cas d'erreur, une exception std::runtime_error est levée et
+ * l'objet n'est pas modifié.
+ */
+{
+	const char *p, *end, *xp, *yp;
+	uint64_t length, n, m, k;
+	long wsmax, wscount;
+	T time;
+
+	if ( (size < headersize) || (memcmp(data, "SYSSIMCK", 8) != 0) )
+	{
+		throw std::runtime_error("Checkpoint::decode : not a checkpoint");
+	}
+	if ( (BinaryFormat::load<uint32_t>(data + 8) != version) ||
+		 (BinaryFormat::load<uint32_t>(data + 12) != (uint32_t)BinaryType<T>::code) ||
+		 (BinaryFormat::load<uint32_t>(data + 16) != (uint32_t)sizeof(T)) )
+	{
+		throw std::runtime_error("Checkpoint::decode : incompatible checkpoint");
+	}
+	length = BinaryFormat::load<uint64_t>(data + 24);
+	if ( (length != size - headersize) || (checksum(data + headersize, length) != BinaryFormat::load<uint64_t>(data + 32)) )
+	{
+		throw std::runtime_error("Checkpoint::decode : corrupted checkpoint");
+	}
+
+	// Les valeurs sont lues dans des variables locales : l'objet n'est
+	// modifié que si tout le fichier est valide.
+	p = data + headersize;
+	end = data + size;
+
+	if (!take(p, end, sizeof(T) + 3 * sizeof(uint64_t)))
+	{
+		throw std::runtime_error("Checkpoint::decode : corrupted checkpoint");
+	}
+	time = BinaryFormat::load<T>(p - sizeof(T) - 3 * sizeof(uint64_t));
+	wsmax = (long)BinaryFormat::load<int64_t>(p - 3 * sizeof(uint64_t));
+	wscount = (long)BinaryFormat::load<int64_t>(p - 2 * sizeof(uint64_t));
+	n = BinaryFormat::load<uint64_t>(p - sizeof(uint64_t));
+
+	xp = p;
+	if ( (n > (uint64_t)(end - p) / sizeof(T)) || !take(p, end, n * sizeof(T) + sizeof(uint64_t)) )
+	{
+		throw std::runtime_error("Checkpoint::decode : corrupted checkpoint");
+	}
+	m = BinaryFormat::load<uint64_t>(p - sizeof(uint64_t));
+
+	yp = p;
+	if ( (m > (uint64_t)(end - p) / sizeof(T)) || !take(p, end, m * sizeof(T) + sizeof(uint64_t)) )
+	{
+		throw std::runtime_error("Checkpoint::decode : corrupted checkpoint");
+	}
+	k = BinaryFormat::load<uint64_t>(p - sizeof(uint64_t));
+
+	if (k != (uint64_t)(end - p))
+	{
+		throw std::runtime_error("Checkpoint::decode : corrupted checkpoint");
+	}
+
+	this->time = time;
+	this->WSmax = wsmax;
+	this->WScount = wscount;
+	this->x.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		this->x[i] = BinaryFormat::load<T>(xp + i * sizeof(T));
+	}
+	this->y.resize(m);
+	for (size_t i = 0; i < m; ++i)
+	{
+		this->y[i] = BinaryFormat::load<T>(yp + i * sizeof(T));
+	}
+	this->integrator.assign(p, k);
+	return;
+}
+
+
+
+template<typename T>
+void Checkpoint<T>::write(const std::string &path, const std::string &buffer)
+/*    Écriture atomique : fichier temporaire, fsync, rename puis fsync du
+ * répertoire (pour que le renommage lui-même soit durable).
+ */
+{
+	const std::string tmp = path + ".tmp";
+	std::string directory;
+	const char *p = buffer.data();
+	size_t remaining = buffer.size();
+	ssize_t written;
+	int fd;
+
+	fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Checkpoint::write : cannot open " + tmp);
+	}
+	while (remaining > 0)
+	{
+		written = ::write(fd, p, remaining);
+		if ( (written < 0) && (errno == EINTR) )
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			::close(fd);
+			::unlink(tmp.c_str());
+			throw std::runtime_error("Checkpoint::write : cannot write " + tmp);
+		}
+		p += written;
+		remaining -= (size_t)written;
+	}
+	if ( (::fsync(fd) != 0) | (::close(fd) != 0) )
+	{
+		::unlink(tmp.c_str());
+		throw std::runtime_error("Checkpoint::write : cannot write " + tmp);
+	}
+	if (::rename(tmp.c_str(), path.c_str()) != 0)
+	{
+		::unlink(tmp.c_str());
+		throw std::runtime_error("Checkpoint::write : cannot rename " + tmp);
+	}
+
+	directory = (path.find('/') == std::string::npos) ? std::string(".") : path.substr(0, path.rfind('/') + 1);
+	fd = ::open(directory.c_str(), O_RDONLY);
+	if (fd >= 0)
+	{
+		::fsync(fd);
+		::close(fd);
+	}
+	return;
+}
+
+template<typename T>
+void Checkpoint<T>::write(const std::string &path) const
+{
+	std::string buffer;
+
+	this->encode(buffer);
+	write(path, buffer);
+	return;
+}
+
+template<typename T>
+bool Checkpoint<T>::read(const std::string &path)
+/*    Renvoie false si le fichier n'existe pas (première exécution).
+ */
+{
+	struct stat info;
+	void *address;
+	int fd;
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	if ( (fstat(fd, &info) != 0) || (info.st_size == 0) )
+	{
+		::close(fd);
+		throw std::runtime_error("Checkpoint::read : cannot read " + path);
+	}
+	address = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED)
+	{
+		throw std::runtime_error("Checkpoint::read : cannot map " + path);
+	}
+
+	try
+	{
+		this->decode((const char*)address, (size_t)info.st_size);
+	}
+	catch (...)
+	{
+		munmap(address, (size_t)info.st_size);
+		throw;
+	}
+	munmap(address, (size_t)info.st_size);
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,373 @@
+#ifndef __CHECKPOINTER_HPP__
+#define __CHECKPOINTER_HPP__
+
+/* 	Checkpointer.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Écriture périodique de points de reprise (voir Checkpoint.hpp) pendant
+ * une simulation. Checkpointer est une opération post-intégration (PrePostOp)
+ * à passer à Simulation::run :
+ *
+ *		Checkpointer<double> checkpointer(sim, "run.ck");
+ *		checkpointer.interval(100.0);	// ou checkpointer.wallclock(600.0);
+ *		checkpointer.restore();			// Reprise si "run.ck" existe.
+ *		sim.run(sink, ti, tf, noop, checkpointer);
+ *
+ *		Le rythme est donné en temps de simulation ("interval") ou en secondes
+ * de temps réel ("wallclock"). À chaque point de reprise, l'état de la
+ * simulation est copié et encodé dans la boucle d'intégration, puis écrit sur
+ * le disque (de manière atomique) par une tâche de fond : la simulation
+ * n'attend pas le disque. Si l'écriture précédente n'est pas terminée, le point
+ * de reprise est reporté à l'appel suivant.
+ *
+ *		Une exception levée par la tâche de fond est relancée à l'appel suivant
+ * (ou par "wait").
+ *
+ *		Les opérations de "run" ne sont pas appelées pendant le transitoire :
+ * pour avoir aussi des points de reprise pendant celui-ci, le passer à
+ * "settransiantop" :
+ *
+ *		sim.settransiantop(checkpointer);
+ *		sim.run(sink, ti, tf, noop, checkpointer);
+ *
+ * Un point de reprise pris pendant le transitoire est repris correctement
+ * par un "run" dont le transitoire est donné en temps (ti) : il se poursuit
+ * jusqu'à ti. Un transitoire en nombre de pas recommencerait à compter.
+ *
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Checkpoint.hpp"
+#include "Integrators.hpp"
+#include "PrePostOp.hpp"
+#include "Simulation.hpp"
+#include "SystemStates.hpp"
+
+template<typename T>
+class Checkpointer: public PrePostOp<T>
+{
+	protected:
+		Simulation<T> *simulation;
+		std::string path;
+
+		T dt, tnext;
+		bool started;
+		double seconds;
+		std::chrono::steady_clock::time_point deadline;
+
+		Checkpoint<T> checkpoint;
+		std::string buffer;					// Encodé dans la boucle d'intégration.
+		std::string pending;				// En cours d'écriture.
+
+		std::thread worker;
+		mutable std::mutex mutex;
+		std::condition_variable condition;
+		bool busy, stopping;
+		std::exception_ptr error;
+
+		unsigned long written, postponed;
+		bool deferred;						// Point de reprise en attente.
+
+		inline bool due(void);
+		void consume(void);
+		void check(void);
+
+	public:
+		Checkpointer(Simulation<T> &simulation, const std::string &path);
+		virtual ~Checkpointer(void);
+
+		inline void interval(const T dt);
+		inline void wallclock(const double seconds);
+
+		void operator()(Integrator<T>& integrator, SystemStates<T>& states);
+
+		void save(void);
+		void wait(void);
+		bool restore(void);
+
+		inline unsigned long getwritten(void) const;
+		inline unsigned long getpostponed(void) const;
+};
+
+template<typename T>
+Checkpointer<T>::Checkpointer(Simulation<T> &simulation, const std::string &path)
+{
+	this->simulation = &simulation;
+	this->path = path;
+	this->dt = (T)0;
+	this->tnext = (T)0;
+	this->started = false;
+	this->seconds = 0.0;
+	this->busy = false;
+	this->stopping = false;
+	this->written = 0;
+	this->postponed = 0;
+	this->deferred = false;
+	return;
+}
+
+template<typename T>
+Checkpointer<T>::~Checkpointer(void)
+{
+	if (this->worker.joinable())
+	{
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->condition.notify_all();
+		this->worker.join();
+	}
+	return;
+}
+
+template<typename T>
+inline void Checkpointer<T>::interval(const T dt)
+{
+	this->dt = dt;
+	this->seconds = 0.0;
+	this->started = false;
+	return;
+}
+
+template<typename T>
+inline void Checkpointer<T>::wallclock(const double seconds)
+{
+	this->dt = (T)0;
+	this->seconds = seconds;
+	this->started = false;
+	return;
+}
+
+template<typename T>
+inline unsigned long Checkpointer<T>::getwritten(void) const
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	return this->written;
+}
+
+template<typename T>
+inline unsigned long Checkpointer<T>::getpostponed(void) const
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	return this->postponed;
+}
+
+
+
+template<typename T>
+inline bool Checkpointer<T>::due(void)
+/*    Le premier appel fixe l'origine du rythme (pas de point de reprise
+ * immédiatement après un démarrage ou une reprise).
+ */
+{
+	if (this->dt > (T)0)
+	{
+		if (!this->started)
+		{
+			this->tnext = this->simulation->getTime() + this->dt;
+			this->started = true;
+			return false;
+		}
+		return (this->simulation->getTime() >= this->tnext);
+	}
+	if (this->seconds > 0.0)
+	{
+		if (!this->started)
+		{
+			this->deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->seconds));
+			this->started = true;
+			return false;
+		}
+		return (std::chrono::steady_clock::now() >= this->deadline);
+	}
+	return false;
+}
+
+template<typename T>
+void Checkpointer<T>::check(void)
+{
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		error = this->error;
+		this->error = std::exception_ptr();
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+	return;
+}
+
+template<typename T>
+void Checkpointer<T>::operator()(Integrator<T>&, SystemStates<T>&)
+{
+	this->check();
+	if (!this->due())
+	{
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if (this->busy)
+		{
+			if (!this->deferred)
+			{
+				++this->postponed;
+				this->deferred = true;
+			}
+			return;
+		}
+	}
+
+	// Copie de l'état dans la boucle d'intégration, écriture en tâche de fond.
+	this->simulation->snapshot(this->checkpoint);
+	this->checkpoint.encode(this->buffer);
+
+	if (!this->worker.joinable())
+	{
+		this->worker = std::thread(&Checkpointer<T>::consume, this);
+	}
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->pending.swap(this->buffer);
+		this->busy = true;
+		this->deferred = false;
+	}
+	this->condition.notify_all();
+
+	if (this->dt > (T)0)
+	{
+		// Prochain multiple de dt (plusieurs peuvent avoir été dépassés).
+		while (this->tnext <= this->simulation->getTime())
+		{
+			this->tnext += this->dt;
+		}
+	}
+	else
+	{
+		this->deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->seconds));
+	}
+	return;
+}
+
+template<typename T>
+void Checkpointer<T>::consume(void)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	while (true)
+	{
+		while (!this->busy && !this->stopping)
+		{
+			this->condition.wait(lock);
+		}
+		if (!this->busy)
+		{
+			return;
+		}
+
+		lock.unlock();
+		try
+		{
+			Checkpoint<T>::write(this->path, this->pending);
+			lock.lock();
+			++this->written;
+		}
+		catch (...)
+		{
+			lock.lock();
+			this->error = std::current_exception();
+		}
+		this->busy = false;
+		this->condition.notify_all();
+	}
+}
+
+template<typename T>
+void Checkpointer<T>::wait(void)
+/*    Attend la fin de l'écriture en cours.
+ */
+{
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		while (this->busy)
+		{
+			this->condition.wait(lock);
+		}
+	}
+	this->check();
+	return;
+}
+
+template<typename T>
+void Checkpointer<T>::save(void)
+/*    Écrit immédiatement (et de manière synchrone) un point de reprise, par
+ * exemple à la fin d'un "run" ou à la réception d'un signal.
+ */
+{
+	this->wait();
+	this->simulation->snapshot(this->checkpoint);
+	this->checkpoint.encode(this->buffer);
+	Checkpoint<T>::write(this->path, this->buffer);
+	std::unique_lock<std::mutex> lock(this->mutex);
+	++this->written;
+	return;
+}
+
+template<typename T>
+bool Checkpointer<T>::restore(void)
+/*    Reprend la simulation depuis le dernier point de reprise. Renvoie false
+ * s'il n'en existe pas.
+ */
+{
+	if (!this->checkpoint.read(this->path))
+	{
+		return false;
+	}
+	this->simulation->restore(this->checkpoint);
+	this->started = false;
+	return true;
+}
+
+
+#endif
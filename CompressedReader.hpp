@@ -0,0 +1,304 @@
+#ifndef __COMPRESSEDREADER_HPP__
+#define __COMPRESSEDREADER_HPP__
+
+/* 	CompressedReader.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Lecture d'un fichier de trajectoire compressé (voir CompressedSink).
+ * L'index de fin de fichier donne accès directement à n'importe quel bloc :
+ * "find" cherche (par dichotomie) le bloc contenant un temps donné et "read"
+ * décode un bloc entier ou une seule colonne d'un bloc.
+ *		Si l'index est absent (simulation interrompue avant le "close"), il est
+ * reconstruit en parcourant les en-têtes de blocs.
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryCodec.hpp"
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class CompressedReader
+{
+	public: typedef typename std::vector<T>::size_type size_type;
+
+	protected:
+		std::istream *istream;
+		std::streampos origin;
+
+		TrajectoryHeader header;
+		TrajectoryIndex index;
+
+		std::string buffer;
+
+		void load(const uint64_t offset, const uint64_t size);
+		void scan(const uint64_t end);
+		void chunk(const size_t chunk, std::vector<uint32_t> &codecs, std::vector<uint64_t> &offsets, std::vector<uint64_t> &sizes);
+
+	public:
+		CompressedReader(std::istream &istream);
+		virtual ~CompressedReader(void){};
+
+		inline const TrajectoryHeader &getheader(void) const;
+
+		inline size_t chunks(void) const;
+		inline uint64_t rows(const size_t chunk) const;
+		inline double tfirst(const size_t chunk) const;
+		inline double tlast(const size_t chunk) const;
+
+		inline size_t find(const double t) const;
+
+		void read(const size_t chunk, std::vector<T> &columns);
+		void read(const size_t chunk, const size_type column, std::vector<T> &values);
+};
+
+template<typename T>
+CompressedReader<T>::CompressedReader(std::istream &istream)
+/*    Lit l'en-tête et l'index. Lève std::runtime_error si le fichier n'est pas
+ * une trajectoire compressée, std::invalid_argument si le type des valeurs ne
+ * correspond pas à T.
+ */
+{
+	std::streampos end;
+	uint64_t size, headersize, position;
+
+	this->istream = &istream;
+	this->origin = istream.tellg();
+	istream.seekg(0, std::ios::end);
+	end = istream.tellg();
+	size = (uint64_t)(end - this->origin);
+
+	this->load(0, std::min<uint64_t>(size, TrajectoryHeader::PREFIX));
+	headersize = TrajectoryHeader::peek(this->buffer.data(), this->buffer.size());
+	if ( (headersize == 0) || (headersize > size) )
+	{
+		throw std::runtime_error("CompressedReader");
+	}
+	this->load(0, headersize);
+	if ( !this->header.decode(this->buffer.data(), this->buffer.size()) )
+	{
+		throw std::runtime_error("CompressedReader");
+	}
+	if (this->header.layout != TrajectoryHeader::COMPRESSED)
+	{
+		throw std::runtime_error("CompressedReader");
+	}
+	if ( (this->header.typesize != sizeof(T)) || (this->header.typecode != (uint32_t)BinaryType<T>::code) )
+	{
+		throw std::invalid_argument("CompressedReader");
+	}
+
+	if (size >= this->header.headersize + TrajectoryIndex::TRAILER)
+	{
+		this->load(size - TrajectoryIndex::TRAILER, TrajectoryIndex::TRAILER);
+		if (this->buffer.compare(8, 8, "SYSSIMIX") == 0)
+		{
+			position = BinaryFormat::load<uint64_t>(this->buffer.data());
+			if ( (position >= this->header.headersize) && (position < size) )
+			{
+				this->load(position, size - position);
+				if ( this->index.decode(this->buffer.data(), this->buffer.size()) )
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	this->scan(size);
+	return;
+}
+
+template<typename T>
+void CompressedReader<T>::load(const uint64_t offset, const uint64_t size)
+{
+	this->buffer.resize(size);
+	this->istream->clear();
+	this->istream->seekg(this->origin + (std::streamoff)offset);
+	if (size > 0)
+	{
+		this->istream->read(&this->buffer[0], size);
+	}
+	if (!*this->istream)
+	{
+		throw std::runtime_error("CompressedReader");
+	}
+	return;
+}
+
+template<typename T>
+void CompressedReader<T>::scan(const uint64_t end)
+/*    Reconstruit l'index à partir des en-têtes de blocs (les blocs incomplets
+ * en fin de fichier sont ignorés).
+ */
+{
+	TrajectoryChunk info;
+	uint64_t position = this->header.headersize;
+
+	this->index.clear();
+	while (position + TrajectoryChunk::SIZE <= end)
+	{
+		this->load(position, TrajectoryChunk::SIZE);
+		if ( !info.decode(this->buffer.data(), end - position) )
+		{
+			break;
+		}
+		this->index.add(position, info);
+		position += info.bytes;
+	}
+	return;
+}
+
+
+
+template<typename T>
+inline const TrajectoryHeader& CompressedReader<T>::getheader(void) const
+{
+	return this->header;
+}
+
+template<typename T>
+inline size_t CompressedReader<T>::chunks(void) const
+{
+	return this->index.size();
+}
+
+template<typename T>
+inline uint64_t CompressedReader<T>::rows(const size_t chunk) const
+{
+	return this->index.rows.at(chunk);
+}
+
+template<typename T>
+inline double CompressedReader<T>::tfirst(const size_t chunk) const
+{
+	return this->index.tfirst.at(chunk);
+}
+
+template<typename T>
+inline double CompressedReader<T>::tlast(const size_t chunk) const
+{
+	return this->index.tlast.at(chunk);
+}
+
+template<typename T>
+inline size_t CompressedReader<T>::find(const double t) const
+/*    Renvoie le premier bloc dont le dernier temps est supérieur ou égal à "t"
+ * ("chunks()" si aucun).
+ */
+{
+	return std::lower_bound(this->index.tlast.begin(), this->index.tlast.end(), t) - this->index.tlast.begin();
+}
+
+
+
+template<typename T>
+void CompressedReader<T>::chunk(const size_t chunk, std::vector<uint32_t> &codecs, std::vector<uint64_t> &offsets, std::vector<uint64_t> &sizes)
+/*    Charge le bloc "chunk" dans le tampon et lit son répertoire.
+ */
+{
+	TrajectoryChunk info;
+	const uint64_t ncolumns = this->header.dimension + 1;
+	const uint64_t directory = TrajectoryChunk::SIZE + 16 * ncolumns;
+	uint64_t offset = directory;
+
+	this->load(this->index.offsets.at(chunk), TrajectoryChunk::SIZE);
+	if ( !info.decode(this->buffer.data(), ~(uint64_t)0) || (info.bytes < directory) )
+	{
+		throw std::runtime_error("CompressedReader::read");
+	}
+	this->load(this->index.offsets[chunk], info.bytes);
+
+	codecs.resize(ncolumns);
+	offsets.resize(ncolumns);
+	sizes.resize(ncolumns);
+	for (uint64_t c = 0; c < ncolumns; ++c)
+	{
+		codecs[c] = BinaryFormat::load<uint32_t>(this->buffer.data() + TrajectoryChunk::SIZE + 16 * c);
+		sizes[c] = BinaryFormat::load<uint64_t>(this->buffer.data() + TrajectoryChunk::SIZE + 16 * c + 8);
+		offsets[c] = offset;
+		offset += sizes[c];
+	}
+	if (offset > info.bytes)
+	{
+		throw std::runtime_error("CompressedReader::read");
+	}
+	return;
+}
+
+template<typename T>
+void CompressedReader<T>::read(const size_t chunk, std::vector<T> &columns)
+/*    Décode le bloc "chunk" : "columns" reçoit le temps puis chaque état, chaque
+ * colonne étant contiguë ("rows(chunk)" valeurs).
+ */
+{
+	std::vector<uint32_t> codecs;
+	std::vector<uint64_t> offsets, sizes;
+	const uint64_t n = this->rows(chunk);
+
+	this->chunk(chunk, codecs, offsets, sizes);
+	columns.resize((this->header.dimension + 1) * n);
+	for (uint64_t c = 0; c <= this->header.dimension; ++c)
+	{
+		TrajectoryCodec<T>::decode(codecs[c], this->buffer.data() + offsets[c], sizes[c], columns.data() + c * n, n);
+	}
+	return;
+}
+
+template<typename T>
+void CompressedReader<T>::read(const size_t chunk, const size_type column, std::vector<T> &values)
+/*    Décode une seule colonne (0 : temps, i + 1 : état i) du bloc "chunk".
+ */
+{
+	std::vector<uint32_t> codecs;
+	std::vector<uint64_t> offsets, sizes;
+	const uint64_t n = this->rows(chunk);
+
+	if (column > this->header.dimension)
+	{
+		throw std::out_of_range("CompressedReader::read");
+	}
+	this->chunk(chunk, codecs, offsets, sizes);
+	values.resize(n);
+	TrajectoryCodec<T>::decode(codecs[column], this->buffer.data() + offsets[column], sizes[column], values.data(), n);
+	return;
+}
+
+
+#endif
@@ -0,0 +1,258 @@
+#ifndef __COMPRESSEDSINK_HPP__
+#define __COMPRESSEDSINK_HPP__
+
+/* 	CompressedSink.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Sortie binaire compressée sans perte (voir TrajectoryFormat.hpp et
+ * TrajectoryCodec.hpp). Comme pour BinarySink, les échantillons sont rangés par
+ * blocs de "chunkrows" lignes, mais chaque colonne d'un bloc est codée (XOR ou
+ * différence de différences). Un index des blocs (position, premier et dernier
+ * temps) est écrit en fin de fichier par "close" pour permettre l'accès direct
+ * (voir CompressedReader).
+ *		Le flux doit être ouvert en mode binaire. Plusieurs "run" peuvent se
+ * suivre sur la même sortie : l'index écrit par le "close" précédent est alors
+ * écrasé, ce qui suppose un flux positionnable (std::ofstream par exemple).
+ *
+ */
+
+#include <stdint.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OutputSink.hpp"
+#include "TrajectoryCodec.hpp"
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class CompressedSink: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::ostream *ostream;
+		std::streampos origin;		// Position de l'en-tête dans le flux.
+
+		TrajectoryHeader header;
+		TrajectoryIndex index;
+		bool started, indexed;
+
+		uint64_t capacity;			// Nombre de lignes par bloc.
+		uint64_t rows;				// Nombre de lignes du bloc courant.
+		uint64_t position;			// Octets écrits depuis l'en-tête.
+		double tfirst, tlast;
+
+		std::vector<T> columns;		// (dimension + 1) colonnes de "capacity" valeurs.
+		std::string chunk, data;
+
+		void flush(void);
+
+	public:
+		CompressedSink(std::ostream &ostream, const uint32_t chunkrows = 8192);
+		virtual ~CompressedSink(void){};
+
+		void setnames(const std::vector<std::string> &names);
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+CompressedSink<T>::CompressedSink(std::ostream &ostream, const uint32_t chunkrows)
+{
+	this->ostream = &ostream;
+	this->started = false;
+	this->indexed = false;
+	this->rows = 0;
+	this->capacity = 0;
+	this->position = 0;
+	this->header.alignment = 1;
+	this->header.chunkrows = (chunkrows > 0) ? chunkrows : 1;
+	return;
+}
+
+template<typename T>
+void CompressedSink<T>::setnames(const std::vector<std::string> &names)
+{
+	if (this->started)
+	{
+		throw std::logic_error("CompressedSink::setnames");
+	}
+	this->header.names = names;
+	return;
+}
+
+
+
+template<typename T>
+void CompressedSink<T>::open(const size_type dimension, const T samplingstep)
+{
+	std::string encoded;
+
+	if (this->started)
+	{
+		if (dimension != this->header.dimension)
+		{
+			throw std::invalid_argument("CompressedSink::open");
+		}
+		if (this->indexed)
+		{
+			// Reprise après un "close" : l'index sera réécrit à la fin.
+			this->ostream->seekp(this->origin + (std::streamoff)this->position);
+			if (!*this->ostream)
+			{
+				throw std::runtime_error("CompressedSink::open");
+			}
+			this->indexed = false;
+		}
+		return;
+	}
+
+	if (this->header.names.empty())
+	{
+		for (size_type i = 0; i < dimension; ++i)
+		{
+			std::ostringstream oss;
+			oss << "x" << i;
+			this->header.names.push_back(oss.str());
+		}
+	}
+	else if (this->header.names.size() != dimension)
+	{
+		throw std::invalid_argument("CompressedSink::open");
+	}
+
+	this->header.layout = TrajectoryHeader::COMPRESSED;
+	this->header.typecode = BinaryType<T>::code;
+	this->header.typesize = sizeof(T);
+	this->header.dimension = dimension;
+	this->header.samplingstep = (double)samplingstep;
+	this->header.encode(encoded);
+
+	this->capacity = this->header.chunkrows;
+	this->rows = 0;
+	this->columns.resize((dimension + 1) * this->capacity);
+
+	this->origin = this->ostream->tellp();
+	this->ostream->write(encoded.data(), encoded.size());
+	this->position = encoded.size();
+	this->started = true;
+	return;
+}
+
+template<typename T>
+void CompressedSink<T>::write(const T t, const SystemStates<T> &states)
+{
+	const T *x = states.data();
+
+	if (this->rows == 0)
+	{
+		this->tfirst = (double)t;
+	}
+	this->tlast = (double)t;
+
+	this->columns[this->rows] = t;
+	for (uint64_t i = 0; i < this->header.dimension; ++i)
+	{
+		this->columns[(i + 1) * this->capacity + this->rows] = x[i];
+	}
+
+	if (++this->rows >= this->capacity)
+	{
+		this->flush();
+	}
+	return;
+}
+
+template<typename T>
+void CompressedSink<T>::flush(void)
+{
+	TrajectoryChunk info;
+	uint32_t codec;
+	size_t previous;
+
+	if (this->rows == 0)
+	{
+		return;
+	}
+
+	this->chunk.assign(TrajectoryChunk::SIZE, '\0');
+	this->data.clear();
+	for (uint64_t c = 0; c <= this->header.dimension; ++c)
+	{
+		previous = this->data.size();
+		codec = TrajectoryCodec<T>::encode(&this->columns[c * this->capacity], this->rows, this->data);
+		BinaryFormat::append(this->chunk, codec);
+		BinaryFormat::append(this->chunk, (uint32_t)0);
+		BinaryFormat::append(this->chunk, (uint64_t)(this->data.size() - previous));
+	}
+	this->chunk += this->data;
+
+	info.flags = 1;
+	info.rows = this->rows;
+	info.bytes = this->chunk.size();
+	info.tfirst = this->tfirst;
+	info.tlast = this->tlast;
+	info.encode(&this->chunk[0]);
+
+	this->ostream->write(this->chunk.data(), this->chunk.size());
+	this->index.add(this->position, info);
+	this->position += this->chunk.size();
+	this->rows = 0;
+	return;
+}
+
+template<typename T>
+void CompressedSink<T>::close(void)
+{
+	std::string encoded;
+
+	if (!this->started)
+	{
+		return;
+	}
+
+	this->flush();
+	this->index.encode(encoded, this->position);
+	this->ostream->write(encoded.data(), encoded.size());
+	this->ostream->flush();
+	this->indexed = true;
+	return;
+}
+
+
+#endif
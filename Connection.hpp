@@ -35,9 +35,13 @@
  *	Permet de définir des liens (couplage) avec un autre système. En créant des
  * classes dérivées, il est possible de stocker des informations supplémentaires
  * dans cette objet (variable de couplage, gain, etc.).
+ *		"fingerprint" ajoute ces informations à une empreinte (voir
+ * Fingerprint.hpp). Par défaut, elle renvoie false (connexion inconnue).
  * 
  */
 
+#include "Fingerprint.hpp"
+
 template<typename T>
 class Connection
 {
@@ -46,6 +50,8 @@ class Connection
 		virtual ~Connection(void){};
 
 		virtual T operator()(void) = 0;
+
+		virtual bool fingerprint(Fingerprint &) const {return false;};
 };
 
 
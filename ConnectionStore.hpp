@@ -0,0 +1,564 @@
+#ifndef __CONNECTIONSTORE_HPP__
+#define __CONNECTIONSTORE_HPP__
+
+/* 	ConnectionStore.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Stockage par valeur des connexions d'un réseau. Au lieu d'un objet
+ * Connection alloué séparément par arc et appelé par un pointeur (une
+ * indirection et un appel virtuel par arc), les connexions d'une même sorte
+ * ("kind") sont rangées à la suite dans un tableau contigu et appliquées dans
+ * une boucle serrée : un seul appel virtuel par sorte et par évaluation de la
+ * dynamique (voir Network::f, qui appelle "apply" après les "localf").
+ *
+ *		Une sorte de connexion est un type valeur (copiable, sans pointeur vers
+ * le réseau) ayant :
+ *		- un membre "to" : indice (dans le réseau) de l'état qui reçoit la
+ *		  connexion ;
+ *		- "T operator()(const T *x) const" : valeur ajoutée à la dérivée de
+ *		  l'état "to", x étant le vecteur d'état complet du réseau.
+ *		GainLink (couplage diffusif "gain (x[from] - x[to])", l'équivalent de
+ * GainCoupling) est fourni. Une sorte définie par l'utilisateur est
+ * enregistrée à son premier ajout ("add"), ou explicitement par
+ * "registerkind". Les sortes sont appliquées dans l'ordre d'enregistrement,
+ * et les connexions d'une sorte dans l'ordre d'ajout.
+ *
+ *		"add" renvoie une référence ("Handle") stable de la connexion, qui permet
+ * de la lire ou de la modifier ("get") et de la supprimer ("remove") en temps
+ * constant : la dernière connexion de la sorte prend sa place (l'ordre
+ * d'application change donc). Le numéro d'une connexion supprimée est
+ * réutilisé par un ajout suivant ; sa génération ("gen") change alors, si
+ * bien qu'une ancienne référence reste invalide ("valid" faux, "get" et
+ * "remove" lèvent une exception). Le numéro de version ("getversion") augmente à
+ * chaque ajout ou suppression : une structure dérivée des connexions sait
+ * ainsi qu'elle doit être mise à jour. Pour modifier la topologie pendant une
+ * simulation, voir TopologyBatch.hpp.
+ *
+ *		Les systèmes locaux ne voient pas ces connexions (elles ne sont pas
+ * dans LocalSystem::neighbors) : "localf" ne doit pas les ajouter lui-même.
+ *		L'empreinte (voir Fingerprint.hpp) d'une sorte est la suite de celles
+ * de ses connexions, données par un membre "bool fingerprint(Fingerprint&)
+ * const" de la sorte (comme GainLink). Une sorte qui n'en a pas n'a pas
+ * d'empreinte (les octets bruts d'une connexion comprennent son remplissage
+ * et ses éventuels pointeurs) : celle du magasin non plus.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "Fingerprint.hpp"
+
+template<typename T>
+struct GainLink
+{
+	uint64_t from, to;
+	T gain;
+
+	GainLink(void):from(0), to(0), gain((T)0){};
+	GainLink(const uint64_t from, const uint64_t to, const T gain):from(from), to(to), gain(gain){};
+
+	inline T operator()(const T *x) const
+	{
+		return this->gain * (x[this->from] - x[this->to]);
+	};
+
+	inline bool fingerprint(Fingerprint &fingerprint) const
+	{
+		fingerprint.add(this->from);
+		fingerprint.add(this->to);
+		fingerprint.add(this->gain);
+		return true;
+	};
+};
+
+
+
+template<typename T>
+class ConnectionStore
+{
+	public:
+		struct Handle
+		{
+			size_t kind, id;
+			unsigned long gen;
+		};
+
+	protected:
+		static const size_t npos = (size_t)-1;
+
+		class KindBase
+		{
+			protected:
+				std::vector<size_t> position;	// Numéro -> indice (npos : libre).
+				std::vector<size_t> ids;		// Indice -> numéro.
+				std::vector<size_t> freeids;
+				std::vector<unsigned long> generation;	// Numéro -> génération.
+
+				inline size_t acquire(void);
+				inline void release(void);
+
+			public:
+				virtual ~KindBase(void){};
+
+				virtual void apply(const T *x, T *dx) const = 0;
+				virtual size_t size(void) const = 0;
+				virtual void clear(void) = 0;
+				virtual void remove(const size_t id, const unsigned long gen) = 0;
+				virtual bool fingerprint(Fingerprint &fingerprint) const = 0;
+				virtual Handle transfer(const size_t i, ConnectionStore<T> &target) const = 0;
+
+				inline bool valid(const size_t id, const unsigned long gen) const;
+				inline size_t find(const size_t id, const unsigned long gen) const;
+				inline unsigned long getgeneration(const size_t id) const;
+		};
+
+		template<typename K>
+		class Kind: public KindBase
+		{
+			public:
+				std::vector<K> links;
+
+				virtual ~Kind(void){};
+
+				inline size_t add(const K &link);
+				inline void reserve(const size_t n);
+
+				virtual void apply(const T *x, T *dx) const;
+				virtual size_t size(void) const {return this->links.size();};
+				virtual void clear(void);
+				virtual void remove(const size_t id, const unsigned long gen);
+				virtual bool fingerprint(Fingerprint &fingerprint) const;
+				virtual Handle transfer(const size_t i, ConnectionStore<T> &target) const;
+		};
+
+		std::vector<KindBase*> kinds;
+		std::unordered_map<std::type_index, size_t> index;
+		unsigned long version;
+
+		template<typename K> inline Kind<K> &kind(void);
+		inline KindBase &kind(const Handle handle) const;
+
+		/*    Empreinte d'une connexion : son membre "fingerprint" s'il existe,
+		 * false sinon.
+		 */
+		template<typename K> static inline auto linkfingerprint(const K &link, Fingerprint &fingerprint, int) -> decltype(link.fingerprint(fingerprint))
+		{
+			return link.fingerprint(fingerprint);
+		};
+		template<typename K> static inline bool linkfingerprint(const K &, Fingerprint &, long)
+		{
+			return false;
+		};
+
+	public:
+		ConnectionStore(void):version(0){};
+		ConnectionStore(const ConnectionStore<T>&) = delete;
+		ConnectionStore<T> &operator=(const ConnectionStore<T>&) = delete;
+		virtual ~ConnectionStore(void);
+
+		template<typename K> size_t registerkind(void);
+		template<typename K> inline Handle add(const K &link);
+		template<typename K> inline void reserve(const size_t n);
+		template<typename K> inline std::vector<K> &links(void);
+
+		template<typename K> inline K &get(const Handle handle);
+		inline bool valid(const Handle handle) const;
+		void remove(const Handle handle);
+
+		inline size_t size(void) const;
+		inline size_t sizekinds(void) const;
+		inline bool empty(void) const;
+		inline unsigned long getversion(void) const;
+
+		inline Handle transfer(const size_t kind, const size_t i, ConnectionStore<T> &target) const;
+
+		void apply(const T *x, T *dx) const;
+		void clear(void);
+
+		bool fingerprint(Fingerprint &fingerprint) const;
+
+		template<typename K> static inline bool fingerprintlink(const K &link, Fingerprint &fingerprint)
+		{
+			return linkfingerprint(link, fingerprint, 0);
+		};
+};
+
+template<typename T>
+inline size_t ConnectionStore<T>::KindBase::acquire(void)
+/*    Numéro libre, associé à l'indice "size()" (la connexion ajoutée).
+ */
+{
+	size_t id;
+
+	if (this->freeids.empty())
+	{
+		id = this->position.size();
+		this->position.push_back(this->ids.size());
+		if (id == this->generation.size())
+		{
+			this->generation.push_back(0);
+		}
+	}
+	else
+	{
+		id = this->freeids.back();
+		this->freeids.pop_back();
+		this->position[id] = this->ids.size();
+	}
+	this->ids.push_back(id);
+	return id;
+}
+
+template<typename T>
+inline void ConnectionStore<T>::KindBase::release(void)
+/*    Libère tous les numéros. Les générations sont conservées et avancées :
+ * les références données avant restent invalides quand les numéros sont
+ * réattribués.
+ */
+{
+	for (size_t id = 0; id < this->generation.size(); ++id)
+	{
+		++this->generation[id];
+	}
+	this->position.clear();
+	this->ids.clear();
+	this->freeids.clear();
+	return;
+}
+
+template<typename T>
+inline bool ConnectionStore<T>::KindBase::valid(const size_t id, const unsigned long gen) const
+{
+	return (id < this->position.size()) && (this->position[id] != npos) && (this->generation[id] == gen);
+}
+
+template<typename T>
+inline size_t ConnectionStore<T>::KindBase::find(const size_t id, const unsigned long gen) const
+{
+	if (!this->valid(id, gen))
+	{
+		throw std::invalid_argument("ConnectionStore : invalid handle");
+	}
+	return this->position[id];
+}
+
+template<typename T>
+inline unsigned long ConnectionStore<T>::KindBase::getgeneration(const size_t id) const
+{
+	return this->generation[id];
+}
+
+template<typename T>
+template<typename K>
+inline size_t ConnectionStore<T>::Kind<K>::add(const K &link)
+{
+	const size_t id = this->acquire();
+
+	this->links.push_back(link);
+	return id;
+}
+
+template<typename T>
+template<typename K>
+inline void ConnectionStore<T>::Kind<K>::reserve(const size_t n)
+{
+	this->links.reserve(this->links.size() + n);
+	this->ids.reserve(this->ids.size() + n);
+	if (n > this->freeids.size())
+	{
+		this->position.reserve(this->position.size() + n - this->freeids.size());
+	}
+	return;
+}
+
+template<typename T>
+template<typename K>
+void ConnectionStore<T>::Kind<K>::clear(void)
+{
+	this->links.clear();
+	this->release();
+	return;
+}
+
+template<typename T>
+template<typename K>
+void ConnectionStore<T>::Kind<K>::remove(const size_t id, const unsigned long gen)
+/*    La dernière connexion est déplacée à la place de la connexion supprimée.
+ */
+{
+	const size_t i = this->find(id, gen);
+	const size_t last = this->links.size() - 1;
+
+	if (i != last)
+	{
+		this->links[i] = this->links[last];
+		this->ids[i] = this->ids[last];
+		this->position[this->ids[i]] = i;
+	}
+	this->links.pop_back();
+	this->ids.pop_back();
+	this->position[id] = npos;
+	++this->generation[id];
+	this->freeids.push_back(id);
+	return;
+}
+
+template<typename T>
+template<typename K>
+typename ConnectionStore<T>::Handle ConnectionStore<T>::Kind<K>::transfer(const size_t i, ConnectionStore<T> &target) const
+/*    Ajoute la i-ème connexion à "target".
+ */
+{
+	return target.add(this->links[i]);
+}
+
+template<typename T>
+template<typename K>
+void ConnectionStore<T>::Kind<K>::apply(const T *x, T *dx) const
+{
+	const K *link = this->links.data();
+	const size_t n = this->links.size();
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		dx[link[i].to] += link[i](x);
+	}
+	return;
+}
+
+template<typename T>
+template<typename K>
+bool ConnectionStore<T>::Kind<K>::fingerprint(Fingerprint &fingerprint) const
+{
+	fingerprint.add(typeid(K).name());
+	fingerprint.add((uint64_t)this->links.size());
+	for (size_t i = 0; i < this->links.size(); ++i)
+	{
+		if (!ConnectionStore<T>::fingerprintlink(this->links[i], fingerprint))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+
+
+template<typename T>
+ConnectionStore<T>::~ConnectionStore(void)
+{
+	for (size_t k = 0; k < this->kinds.size(); ++k)
+	{
+		delete this->kinds[k];
+	}
+	return;
+}
+
+template<typename T>
+template<typename K>
+size_t ConnectionStore<T>::registerkind(void)
+/*    Renvoie le rang de la sorte K (enregistrée si nécessaire).
+ */
+{
+	const std::type_index type(typeid(K));
+	typename std::unordered_map<std::type_index, size_t>::const_iterator found = this->index.find(type);
+
+	if (found != this->index.end())
+	{
+		return found->second;
+	}
+	this->kinds.push_back(new Kind<K>());
+	this->index[type] = this->kinds.size() - 1;
+	return this->kinds.size() - 1;
+}
+
+template<typename T>
+inline typename ConnectionStore<T>::KindBase &ConnectionStore<T>::kind(const Handle handle) const
+{
+	if (handle.kind >= this->kinds.size())
+	{
+		throw std::invalid_argument("ConnectionStore : invalid handle");
+	}
+	return *this->kinds[handle.kind];
+}
+
+template<typename T>
+template<typename K>
+inline typename ConnectionStore<T>::template Kind<K> &ConnectionStore<T>::kind(void)
+{
+	return *static_cast< Kind<K>* >(this->kinds[this->registerkind<K>()]);
+}
+
+template<typename T>
+template<typename K>
+inline typename ConnectionStore<T>::Handle ConnectionStore<T>::add(const K &link)
+{
+	Handle handle;
+
+	handle.kind = this->registerkind<K>();
+	handle.id = static_cast< Kind<K>* >(this->kinds[handle.kind])->add(link);
+	handle.gen = this->kinds[handle.kind]->getgeneration(handle.id);
+	++this->version;
+	return handle;
+}
+
+template<typename T>
+template<typename K>
+inline void ConnectionStore<T>::reserve(const size_t n)
+/*    Place pour n connexions supplémentaires de la sorte K.
+ */
+{
+	this->kind<K>().reserve(n);
+	return;
+}
+
+template<typename T>
+template<typename K>
+inline std::vector<K> &ConnectionStore<T>::links(void)
+/*    Accès direct aux connexions de la sorte K (pour modifier un gain, par
+ * exemple). Ne pas ajouter ni supprimer de connexion par ce vecteur.
+ */
+{
+	return this->kind<K>().links;
+}
+
+template<typename T>
+template<typename K>
+inline K &ConnectionStore<T>::get(const Handle handle)
+{
+	KindBase &kind = this->kind(handle);
+	typename std::unordered_map<std::type_index, size_t>::const_iterator found = this->index.find(std::type_index(typeid(K)));
+
+	if ( (found == this->index.end()) || (found->second != handle.kind) )
+	{
+		throw std::invalid_argument("ConnectionStore::get : wrong kind");
+	}
+	return static_cast< Kind<K>& >(kind).links[kind.find(handle.id, handle.gen)];
+}
+
+template<typename T>
+inline bool ConnectionStore<T>::valid(const Handle handle) const
+{
+	return (handle.kind < this->kinds.size()) && this->kinds[handle.kind]->valid(handle.id, handle.gen);
+}
+
+template<typename T>
+void ConnectionStore<T>::remove(const Handle handle)
+{
+	this->kind(handle).remove(handle.id, handle.gen);
+	++this->version;
+	return;
+}
+
+template<typename T>
+inline size_t ConnectionStore<T>::size(void) const
+{
+	size_t n = 0;
+
+	for (size_t k = 0; k < this->kinds.size(); ++k)
+	{
+		n += this->kinds[k]->size();
+	}
+	return n;
+}
+
+template<typename T>
+inline size_t ConnectionStore<T>::sizekinds(void) const
+{
+	return this->kinds.size();
+}
+
+template<typename T>
+inline bool ConnectionStore<T>::empty(void) const
+{
+	return (this->size() == 0);
+}
+
+template<typename T>
+inline unsigned long ConnectionStore<T>::getversion(void) const
+{
+	return this->version;
+}
+
+template<typename T>
+inline typename ConnectionStore<T>::Handle ConnectionStore<T>::transfer(const size_t kind, const size_t i, ConnectionStore<T> &target) const
+/*    Ajoute à "target" la i-ème connexion de la sorte de rang "kind".
+ */
+{
+	return this->kinds[kind]->transfer(i, target);
+}
+
+template<typename T>
+void ConnectionStore<T>::apply(const T *x, T *dx) const
+{
+	for (size_t k = 0; k < this->kinds.size(); ++k)
+	{
+		this->kinds[k]->apply(x, dx);
+	}
+	return;
+}
+
+template<typename T>
+void ConnectionStore<T>::clear(void)
+/*    Supprime les connexions ; les sortes restent enregistrées.
+ */
+{
+	for (size_t k = 0; k < this->kinds.size(); ++k)
+	{
+		this->kinds[k]->clear();
+	}
+	++this->version;
+	return;
+}
+
+template<typename T>
+bool ConnectionStore<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	fingerprint.add((uint64_t)this->kinds.size());
+	for (size_t k = 0; k < this->kinds.size(); ++k)
+	{
+		if (!this->kinds[k]->fingerprint(fingerprint))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,315 @@
+#ifndef __COUPLINGOPERATOR_HPP__
+#define __COUPLINGOPERATOR_HPP__
+
+/* 	CouplingOperator.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Couplage linéaire vectoriel d'un réseau de n nœuds identiques, défini
+ * par une topologie (voir Topology.hpp, matrice d'adjacence pondérée A), un
+ * gain K et une matrice de couplage interne H (d x d, par lignes) agissant
+ * sur les d états "statesoffset" à "statesoffset + d - 1" de chaque nœud :
+ *		- LAPLACIAN :	dx_i += K H sum_j A_ij (x_j - x_i)
+ *		- ADJACENCY :	dx_i += K H sum_j A_ij x_j
+ * Il remplace les d GainCoupling (un par composante, plus ceux des termes
+ * croisés de H) créés pour chaque arc : H n'est appliquée qu'une fois par
+ * nœud, à la somme pondérée des voisins (le terme de couplage est linéaire).
+ *
+ *		Les états du nœud i commencent à "base + i stride" dans le réseau
+ * (nœuds contigus et de même taille, comme ceux de NetworkBuilder::addnodes).
+ * Le calcul est un seul noyau sur tous les nœuds ; pour d <= 4, il est
+ * instancié avec d constant (boucles déroulées et vectorisées par le
+ * compilateur), et H diagonale se réduit à un produit terme à terme.
+ *
+ */
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "Fingerprint.hpp"
+#include "GlobalCoupling.hpp"
+#include "Topology.hpp"
+
+template<typename T>
+class CouplingOperator: public GlobalCoupling<T>
+{
+	public:
+		typedef typename std::vector<T>::size_type size_type;
+		enum Form {LAPLACIAN, ADJACENCY};
+
+	protected:
+		Topology<T> topology;
+		std::vector<T> degrees;				// sum_j A_ij (LAPLACIAN)
+		std::vector<T> kh;					// K H
+		size_type dimension;
+		size_type base, stride, statesoffset;
+		Form form;
+		bool diagonal;
+
+		template<size_t D> void kernel(const T *x, T *dx, const size_type d) const;
+
+	public:
+		CouplingOperator(const Topology<T> &topology, const size_type stride, const T gain, const std::vector<T> &H, const size_type statesoffset = 0, const Form form = LAPLACIAN);
+		virtual ~CouplingOperator(void){};
+
+		void setbase(const size_type base);
+		void setgain(const T gain, const std::vector<T> &H);
+
+		inline size_type sizenodes(void) const;
+		inline size_type sizedimension(void) const;
+
+		virtual void apply(const T *x, T *dx) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+};
+
+template<typename T>
+CouplingOperator<T>::CouplingOperator(const Topology<T> &topology, const size_type stride, const T gain, const std::vector<T> &H, const size_type statesoffset, const Form form):topology(topology)
+{
+	this->base = 0;
+	this->stride = stride;
+	this->statesoffset = statesoffset;
+	this->form = form;
+	this->setgain(gain, H);
+
+	this->degrees.assign(this->topology.size(), (T)0);
+	if (this->form == LAPLACIAN)
+	{
+		for (uint64_t i = 0; i < this->topology.size(); ++i)
+		{
+			for (uint64_t e = this->topology.first(i); e < this->topology.last(i); ++e)
+			{
+				this->degrees[i] += this->topology.weight(e);
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void CouplingOperator<T>::setbase(const size_type base)
+/*    Position du premier état du nœud 0 dans le réseau.
+ */
+{
+	this->base = base;
+	return;
+}
+
+template<typename T>
+void CouplingOperator<T>::setgain(const T gain, const std::vector<T> &H)
+/*    H doit tenir dans un nœud (statesoffset + dimension <= stride) ; sinon
+ * std::invalid_argument est levée et l'opérateur reste inchangé.
+ */
+{
+	size_type d = 0;
+
+	while (d * d < H.size())
+	{
+		++d;
+	}
+	if ( (d == 0) || (d * d != H.size()) )
+	{
+		throw std::invalid_argument("CouplingOperator : H must be a non-empty square matrix");
+	}
+	if (this->statesoffset + d > this->stride)
+	{
+		throw std::invalid_argument("CouplingOperator : coupled states exceed node size");
+	}
+	this->dimension = d;
+	this->kh.resize(H.size());
+	this->diagonal = true;
+	for (size_type r = 0; r < d; ++r)
+	{
+		for (size_type c = 0; c < d; ++c)
+		{
+			this->kh[r * d + c] = gain * H[r * d + c];
+			if ( (r != c) && (H[r * d + c] != (T)0) )
+			{
+				this->diagonal = false;
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+inline typename CouplingOperator<T>::size_type CouplingOperator<T>::sizenodes(void) const
+{
+	return this->topology.size();
+}
+
+template<typename T>
+inline typename CouplingOperator<T>::size_type CouplingOperator<T>::sizedimension(void) const
+{
+	return this->dimension;
+}
+
+template<typename T>
+void CouplingOperator<T>::apply(const T *x, T *dx) const
+{
+	switch (this->dimension)
+	{
+		case 1:
+			this->template kernel<1>(x, dx, 1);
+			break;
+		case 2:
+			this->template kernel<2>(x, dx, 2);
+			break;
+		case 3:
+			this->template kernel<3>(x, dx, 3);
+			break;
+		case 4:
+			this->template kernel<4>(x, dx, 4);
+			break;
+		default:
+			this->template kernel<0>(x, dx, this->dimension);
+			break;
+	}
+	return;
+}
+
+template<typename T>
+template<size_t D>
+void CouplingOperator<T>::kernel(const T *x, T *dx, const size_type dimension) const
+/*    D : dimension connue à la compilation (0 : "dimension").
+ */
+{
+	const size_type d = (D > 0) ? D : dimension;
+	const uint64_t n = this->topology.size();
+	const bool weighted = this->topology.weighted();
+	const bool laplacian = (this->form == LAPLACIAN);
+	const T *kh = this->kh.data();
+	const T *xs = x + this->base + this->statesoffset;
+	T *dxs = dx + this->base + this->statesoffset;
+	std::vector<T> buffer((D > 0) ? 0 : d);
+	T fixed[(D > 0) ? D : 1];
+	T *sum = (D > 0) ? fixed : buffer.data();
+
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		const T *xi = xs + i * this->stride;
+		T *dxi = dxs + i * this->stride;
+		const uint64_t last = this->topology.last(i);
+
+		for (size_type c = 0; c < d; ++c)
+		{
+			sum[c] = (T)0;
+		}
+		if (weighted)
+		{
+			for (uint64_t e = this->topology.first(i); e < last; ++e)
+			{
+				const T *xj = xs + this->topology.source(e) * this->stride;
+				const T w = this->topology.weight(e);
+
+				for (size_type c = 0; c < d; ++c)
+				{
+					sum[c] += w * xj[c];
+				}
+			}
+		}
+		else
+		{
+			for (uint64_t e = this->topology.first(i); e < last; ++e)
+			{
+				const T *xj = xs + this->topology.source(e) * this->stride;
+
+				for (size_type c = 0; c < d; ++c)
+				{
+					sum[c] += xj[c];
+				}
+			}
+		}
+		if (laplacian)
+		{
+			const T degree = this->degrees[i];
+
+			for (size_type c = 0; c < d; ++c)
+			{
+				sum[c] -= degree * xi[c];
+			}
+		}
+
+		if (this->diagonal)
+		{
+			for (size_type r = 0; r < d; ++r)
+			{
+				dxi[r] += kh[r * d + r] * sum[r];
+			}
+		}
+		else
+		{
+			for (size_type r = 0; r < d; ++r)
+			{
+				T acc = (T)0;
+
+				for (size_type c = 0; c < d; ++c)
+				{
+					acc += kh[r * d + c] * sum[c];
+				}
+				dxi[r] += acc;
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+bool CouplingOperator<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(CouplingOperator<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->topology.size());
+	fingerprint.add((uint64_t)this->topology.edges());
+	for (uint64_t i = 0; i < this->topology.size(); ++i)
+	{
+		fingerprint.add((uint64_t)this->topology.first(i));
+	}
+	for (uint64_t e = 0; e < this->topology.edges(); ++e)
+	{
+		fingerprint.add((uint64_t)this->topology.source(e));
+		fingerprint.add(this->topology.weight(e));
+	}
+	fingerprint.add(this->kh);
+	fingerprint.add((uint64_t)this->base);
+	fingerprint.add((uint64_t)this->stride);
+	fingerprint.add((uint64_t)this->statesoffset);
+	fingerprint.add((uint64_t)this->form);
+	return true;
+}
+
+#endif
@@ -48,6 +48,8 @@ class Discrete: public FixedStepIntegrator<T>
 		Discrete(FixedStepIntegrator<T> &other):FixedStepIntegrator<T>(other){};
 
 		void operator()(T &t, DynamicalSystem<T> &system);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -62,8 +64,18 @@ void Discrete<T>::operator()(T &t, DynamicalSystem<T> &system)
 		system[i] = system.dx(i);
 	}
 
-	t = t + this->step;
+	this->advance(t);
+
+}
 
+template<typename T>
+bool Discrete<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(Discrete<T>))
+	{
+		return false;
+	}
+	return this->fingerprintstate(fingerprint);
 }
 
 #endif
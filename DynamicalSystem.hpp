@@ -55,6 +55,11 @@
  *
  * * NOTE 2 : Voir "Rossler.hpp" pour un exemple d'implémentation.
  *
+ * * NOTE 3 : "fingerprint" ajoute à une empreinte (voir Fingerprint.hpp) les
+ * paramètres du système (pas ses états). Elle permet de réutiliser un
+ * transitoire déjà calculé (voir TransientCache.hpp). Par défaut, elle renvoie
+ * false : le système ne peut pas être identifié et le cache n'est pas utilisé.
+ *
  */
 
 /* FIXME
@@ -77,6 +82,7 @@
 
 #include <vector>
 
+#include "Fingerprint.hpp"
 #include "SystemStates.hpp"
 
 template<typename T>
@@ -138,6 +144,8 @@ class DynamicalSystem: public SystemStates<T>
 		virtual inline size_type sizedx(void) const;
 		virtual inline size_type sizey(void) const;
 
+		virtual bool fingerprint(Fingerprint &) const {return false;};
+
 };
 
 
@@ -0,0 +1,188 @@
+#ifndef __EDGECOLOURING_HPP__
+#define __EDGECOLOURING_HPP__
+
+/* 	EdgeColouring.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Coloration des arêtes d'un graphe : deux arêtes ayant une extrémité
+ * commune reçoivent des couleurs différentes. Les arêtes d'une même couleur
+ * touchent donc des sommets tous distincts : une boucle sur ces arêtes peut
+ * écrire aux deux extrémités de chacune en parallèle, sans atomique ni
+ * verrou (voir SymmetricCoupling.hpp).
+ *
+ *		Méthode gloutonne : chaque arête prend la plus petite couleur libre à
+ * ses deux extrémités, ce qui en utilise au plus 2 D - 1 (D : degré maximal,
+ * l'optimum étant D ou D + 1). Les couleurs utilisées en chaque sommet sont
+ * gardées dans un masque de bits.
+ *		Les extrémités sont des entiers quelconques (< "n") : indices de nœuds,
+ * ou directement indices des états écrits.
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+class EdgeColouring
+{
+	protected:
+		std::vector<uint32_t> colours;
+		uint32_t ncolours;
+
+	public:
+		EdgeColouring(void);
+		EdgeColouring(const uint64_t n, const std::vector<uint64_t> &a, const std::vector<uint64_t> &b);
+		virtual ~EdgeColouring(void){};
+
+		void colour(const uint64_t n, const std::vector<uint64_t> &a, const std::vector<uint64_t> &b);
+
+		inline uint32_t operator[](const uint64_t edge) const;
+		inline uint64_t size(void) const;
+		inline uint32_t getncolours(void) const;
+		inline const std::vector<uint32_t> &getcolours(void) const;
+
+		std::vector<uint64_t> order(std::vector<uint64_t> &offsets) const;
+};
+
+inline EdgeColouring::EdgeColouring(void)
+{
+	this->ncolours = 0;
+	return;
+}
+
+inline EdgeColouring::EdgeColouring(const uint64_t n, const std::vector<uint64_t> &a, const std::vector<uint64_t> &b)
+{
+	this->colour(n, a, b);
+	return;
+}
+
+inline void EdgeColouring::colour(const uint64_t n, const std::vector<uint64_t> &a, const std::vector<uint64_t> &b)
+/*    Arête e : {a[e], b[e]}, avec a[e] != b[e] < n.
+ */
+{
+	std::vector<uint32_t> degrees(n, 0);
+	std::vector<uint64_t> used;
+	uint32_t degree = 0;
+	size_t words;
+
+	if (a.size() != b.size())
+	{
+		throw std::invalid_argument("EdgeColouring::colour : endpoint lists differ in size");
+	}
+	for (size_t e = 0; e < a.size(); ++e)
+	{
+		if ( (a[e] >= n) || (b[e] >= n) || (a[e] == b[e]) )
+		{
+			throw std::invalid_argument("EdgeColouring::colour : invalid edge");
+		}
+		degree = std::max(degree, ++degrees[a[e]]);
+		degree = std::max(degree, ++degrees[b[e]]);
+	}
+	words = (std::max<size_t>(2 * (size_t)degree, 1) + 63) / 64;
+	used.assign(n * words, 0);
+
+	this->colours.resize(a.size());
+	this->ncolours = 0;
+	for (size_t e = 0; e < a.size(); ++e)
+	{
+		const uint64_t *ua = used.data() + a[e] * words;
+		const uint64_t *ub = used.data() + b[e] * words;
+		uint32_t colour = 0;
+
+		for (size_t w = 0; w < words; ++w)
+		{
+			const uint64_t free = ~(ua[w] | ub[w]);
+
+			if (free != 0)
+			{
+				colour = (uint32_t)(64 * w + __builtin_ctzll(free));
+				break;
+			}
+		}
+		used[a[e] * words + colour / 64] |= (uint64_t)1 << (colour % 64);
+		used[b[e] * words + colour / 64] |= (uint64_t)1 << (colour % 64);
+		this->colours[e] = colour;
+		this->ncolours = std::max(this->ncolours, colour + 1);
+	}
+	return;
+}
+
+inline uint32_t EdgeColouring::operator[](const uint64_t edge) const
+{
+	return this->colours[edge];
+}
+
+inline uint64_t EdgeColouring::size(void) const
+{
+	return this->colours.size();
+}
+
+inline uint32_t EdgeColouring::getncolours(void) const
+{
+	return this->ncolours;
+}
+
+inline const std::vector<uint32_t> &EdgeColouring::getcolours(void) const
+{
+	return this->colours;
+}
+
+inline std::vector<uint64_t> EdgeColouring::order(std::vector<uint64_t> &offsets) const
+/*    Arêtes rangées par couleur (tri par comptage, stable) : celles de la
+ * couleur c sont order[offsets[c]] ... order[offsets[c+1] - 1].
+ */
+{
+	std::vector<uint64_t> order(this->colours.size());
+
+	offsets.assign(this->ncolours + 1, 0);
+	for (size_t e = 0; e < this->colours.size(); ++e)
+	{
+		++offsets[this->colours[e] + 1];
+	}
+	for (uint32_t c = 0; c < this->ncolours; ++c)
+	{
+		offsets[c+1] += offsets[c];
+	}
+	{
+		std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+
+		for (size_t e = 0; e < this->colours.size(); ++e)
+		{
+			order[next[this->colours[e]]++] = e;
+		}
+	}
+	return order;
+}
+
+#endif
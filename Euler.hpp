@@ -52,6 +52,8 @@ class Euler: public FixedStepIntegrator<T>
 		Euler(FixedStepIntegrator<T> &other):FixedStepIntegrator<T>(other){};
 
 		void operator()(T &t, DynamicalSystem<T> &system);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -61,13 +63,25 @@ void Euler<T>::operator()(T &t, DynamicalSystem<T> &system)
 
 	system.f(t,system);
 
+	this->prepare(system);
+
 	for(i = 0; i < system.size(); ++i)
 	{
-		system[i] = system[i] + (this->step) * system.dx(i);
+		this->increment(system, i, (this->step) * system.dx(i));
 	}
 
-	t = t + this->step;
+	this->advance(t);
+
+}
 
+template<typename T>
+bool Euler<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(Euler<T>))
+	{
+		return false;
+	}
+	return this->fingerprintstate(fingerprint);
 }
 
 #endif
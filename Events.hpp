@@ -0,0 +1,615 @@
+#ifndef __EVENTS_HPP__
+#define __EVENTS_HPP__
+
+/* 	Events.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Détection d'événements pendant une simulation. Un événement (Event) est
+ * défini par une fonction g(t, x) : il a lieu quand g change de signe (dans
+ * le sens choisi). EventDetector évalue g à chaque pas, et lorsqu'un
+ * changement de signe est détecté, localise l'instant exact par recherche de
+ * racine (regula falsi modifiée, dite "Illinois") sur l'interpolation du pas :
+ *		- HERMITE : polynôme cubique d'Hermite construit sur les états et les
+ *		  dérivées aux deux bornes du pas (précision d'ordre 3, une évaluation
+ *		  de f supplémentaire par pas) ;
+ *		- LINEAR : interpolation linéaire des états (aucun coût supplémentaire).
+ *		L'événement reçoit l'état interpolé à l'instant du changement de signe
+ * ("occurred") et décide de la suite :
+ *		- CONTINUE : la simulation continue ;
+ *		- STOP : la simulation s'arrête à l'instant de l'événement (l'état du
+ *		  système est celui de l'événement) ;
+ *		- RESET : l'état, éventuellement modifié par "occurred", devient l'état
+ *		  du système et la simulation repart de l'instant de l'événement.
+ *
+ *		SectionEvent écrit l'état à chaque traversée d'une section de Poincaré
+ * x[index] = level dans une sortie (OutputSink) : avec NullSink comme sortie
+ * principale, seules les traversées sont écrites.
+ *
+ *		EventDetector<double> detector(sim);
+ *		SectionEvent<double> section(1, 0.0, Event<double>::RISING, binarysink);
+ *		detector.add(section);
+ *		NullSink<double> none;
+ *		detector.run(none, ti, tf);
+ *
+ *		"run" appelle Simulation::run avec les opérations "pre" et "post" du
+ * détecteur (utilisables directement avec d'autres prédicats) puis ferme les
+ * sorties des événements. Les événements ne sont testés qu'après le
+ * transitoire.
+ *
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "DynamicalSystem.hpp"
+#include "Integrators.hpp"
+#include "OutputSink.hpp"
+#include "PrePostOp.hpp"
+#include "Simulation.hpp"
+#include "SimulationPredicate.hpp"
+#include "SystemStates.hpp"
+
+template<typename T>
+class Event
+{
+	public:
+		enum Direction { FALLING = -1, BOTH = 0, RISING = 1 };
+		enum Action { CONTINUE, STOP, RESET };
+
+	protected:
+		Direction direction;
+
+	public:
+		Event(const Direction direction = BOTH):direction(direction){};
+		virtual ~Event(void){};
+
+		inline Direction getdirection(void) const {return this->direction;};
+
+		virtual T g(const T t, const SystemStates<T> &x) = 0;
+
+		/* "rising" vaut true si g est passée de négative à positive. */
+		virtual Action occurred(const T t, SystemStates<T> &x, const bool rising) = 0;
+
+		/* Fin de "EventDetector::run". */
+		virtual void close(void){};
+};
+
+
+
+/*	SectionEvent
+ *
+ *		Section x[index] = level. Chaque traversée est écrite dans "sink" (ouverte
+ * à la première traversée, fermée par "close").
+ */
+template<typename T>
+class SectionEvent: public Event<T>
+{
+	public: typedef typename SystemStates<T>::size_type size_type;
+
+	protected:
+		size_type index;
+		T level;
+		OutputSink<T> *sink;
+		typename Event<T>::Action action;
+		bool opened;
+		unsigned long count;
+
+	public:
+		SectionEvent(const size_type index, const T level, const typename Event<T>::Direction direction, OutputSink<T> &sink, const typename Event<T>::Action action = Event<T>::CONTINUE);
+		virtual ~SectionEvent(void){};
+
+		inline unsigned long getcount(void) const;
+
+		virtual T g(const T t, const SystemStates<T> &x);
+		virtual typename Event<T>::Action occurred(const T t, SystemStates<T> &x, const bool rising);
+		virtual void close(void);
+};
+
+template<typename T>
+SectionEvent<T>::SectionEvent(const size_type index, const T level, const typename Event<T>::Direction direction, OutputSink<T> &sink, const typename Event<T>::Action action):Event<T>(direction)
+{
+	this->index = index;
+	this->level = level;
+	this->sink = &sink;
+	this->action = action;
+	this->opened = false;
+	this->count = 0;
+	return;
+}
+
+template<typename T>
+inline unsigned long SectionEvent<T>::getcount(void) const
+{
+	return this->count;
+}
+
+template<typename T>
+T SectionEvent<T>::g(const T, const SystemStates<T> &x)
+{
+	return x[this->index] - this->level;
+}
+
+template<typename T>
+typename Event<T>::Action SectionEvent<T>::occurred(const T t, SystemStates<T> &x, const bool)
+{
+	if (!this->opened)
+	{
+		this->sink->open(x.size(), (T)0);
+		this->opened = true;
+	}
+	this->sink->write(t, x);
+	++this->count;
+	return this->action;
+}
+
+template<typename T>
+void SectionEvent<T>::close(void)
+{
+	if (this->opened)
+	{
+		this->sink->close();
+		this->opened = false;
+	}
+	return;
+}
+
+
+
+/*	EventDetector
+ */
+template<typename T>
+class EventDetector
+{
+	public:
+		enum Interpolation { LINEAR, HERMITE };
+
+	protected:
+		/* Opérations pré- et post-intégration du détecteur. */
+		class PreOp: public PrePostOp<T>
+		{
+			protected:
+				EventDetector<T> *detector;
+			public:
+				PreOp(EventDetector<T> *detector):detector(detector){};
+				void operator()(Integrator<T>& integrator, SystemStates<T>&)
+				{
+					this->detector->before(integrator);
+				};
+		};
+
+		class PostOp: public PrePostOp<T>
+		{
+			protected:
+				EventDetector<T> *detector;
+			public:
+				PostOp(EventDetector<T> *detector):detector(detector){};
+				void operator()(Integrator<T>& integrator, SystemStates<T>&)
+				{
+					this->detector->after(integrator);
+				};
+		};
+
+		/* t < tf, et aucun événement STOP. */
+		class Until: public SimulationPredicate<T>
+		{
+			protected:
+				EventDetector<T> *detector;
+				T tf;
+			public:
+				Until(EventDetector<T> *detector, const T tf):detector(detector), tf(tf){};
+				bool test(void)
+				{
+					return !this->detector->stopped() && (this->detector->simulation->getTime() < this->tf);
+				};
+		};
+
+		/* Transitoire : t < ti. */
+		class Before: public SimulationPredicate<T>
+		{
+			protected:
+				Simulation<T> *simulation;
+				T ti;
+			public:
+				Before(Simulation<T> *simulation, const T ti):simulation(simulation), ti(ti){};
+				bool test(void)
+				{
+					return (this->simulation->getTime() < this->ti);
+				};
+		};
+
+		/* Événement détecté pendant le pas. */
+		struct Crossing
+		{
+			T t;
+			size_t event;
+			bool rising;
+
+			inline bool operator<(const Crossing &other) const {return this->t < other.t;};
+		};
+
+		Simulation<T> *simulation;
+		std::vector< Event<T>* > events;
+
+		Interpolation interpolation;
+		T tolerance;
+		unsigned int maxiterations;
+
+		PreOp preop;
+		PostOp postop;
+		bool stop;
+
+		// Bornes du pas : temps, états, dérivées et valeurs de g.
+		T t0, t1;
+		std::vector<T> x0, x1, f0, f1;
+		std::vector<T> g0, g1;
+		bool cached;						// t1, x1, f1, g1 valables pour le pas suivant.
+
+		SystemStates<T> xc;					// État interpolé.
+		std::vector<Crossing> crossings;
+
+		void before(Integrator<T> &integrator);
+		void after(Integrator<T> &integrator);
+
+		inline void derivative(DynamicalSystem<T> &system, const T t, std::vector<T> &f);
+		inline void interpolate(const T t);
+		T locate(const size_t event);
+
+		friend class PreOp;
+		friend class PostOp;
+		friend class Until;
+
+	public:
+		EventDetector(Simulation<T> &simulation);
+		virtual ~EventDetector(void){};
+
+		inline void add(Event<T> &event);
+
+		inline void setinterpolation(const Interpolation interpolation);
+		inline void settolerance(const T tolerance);
+
+		inline PrePostOp<T> &pre(void);
+		inline PrePostOp<T> &post(void);
+
+		inline bool stopped(void) const;
+		inline void rearm(void);
+
+		void run(OutputSink<T> &sink, const T ti, const T tf);
+};
+
+template<typename T>
+EventDetector<T>::EventDetector(Simulation<T> &simulation):preop(this), postop(this)
+{
+	this->simulation = &simulation;
+	this->interpolation = HERMITE;
+	this->tolerance = (T)0;
+	this->maxiterations = 100;
+	this->stop = false;
+	this->cached = false;
+	return;
+}
+
+template<typename T>
+inline void EventDetector<T>::add(Event<T> &event)
+{
+	this->events.push_back(&event);
+	this->cached = false;
+	return;
+}
+
+template<typename T>
+inline void EventDetector<T>::setinterpolation(const Interpolation interpolation)
+{
+	this->interpolation = interpolation;
+	this->cached = false;
+	return;
+}
+
+template<typename T>
+inline void EventDetector<T>::settolerance(const T tolerance)
+/*    Précision (en temps) de l'instant des événements. 0 (par défaut) :
+ * jusqu'à la précision du type T.
+ */
+{
+	this->tolerance = tolerance;
+	return;
+}
+
+template<typename T>
+inline PrePostOp<T>& EventDetector<T>::pre(void)
+{
+	return this->preop;
+}
+
+template<typename T>
+inline PrePostOp<T>& EventDetector<T>::post(void)
+{
+	return this->postop;
+}
+
+template<typename T>
+inline bool EventDetector<T>::stopped(void) const
+{
+	return this->stop;
+}
+
+template<typename T>
+inline void EventDetector<T>::rearm(void)
+/*    Permet de poursuivre après un événement STOP.
+ */
+{
+	this->stop = false;
+	this->cached = false;
+	return;
+}
+
+
+
+template<typename T>
+inline void EventDetector<T>::derivative(DynamicalSystem<T> &system, const T t, std::vector<T> &f)
+{
+	system.f(t, system);
+	f.resize(system.size());
+	for (long i = 0; i < system.size(); ++i)
+	{
+		f[i] = system.dx(i);
+	}
+	return;
+}
+
+template<typename T>
+void EventDetector<T>::before(Integrator<T> &)
+/*    Début du pas. Si l'état n'a pas été modifié depuis la fin du pas
+ * précédent, ses valeurs (dérivées, g) sont réutilisées.
+ */
+{
+	DynamicalSystem<T> &system = this->simulation->getdynamicalsystem();
+	const T t = this->simulation->getTime();
+	const size_t n = system.size();
+
+	if ( this->cached && (t == this->t1) && (this->x1.size() == n) &&
+		 ((n == 0) || (memcmp(&this->x1[0], system.data(), n * sizeof(T)) == 0)) )
+	{
+		this->t0 = this->t1;
+		this->x0.swap(this->x1);
+		this->f0.swap(this->f1);
+		this->g0.swap(this->g1);
+		return;
+	}
+
+	this->t0 = t;
+	this->x0.assign(system.data(), system.data() + n);
+	if (this->interpolation == HERMITE)
+	{
+		this->derivative(system, t, this->f0);
+	}
+	this->g0.resize(this->events.size());
+	for (size_t e = 0; e < this->events.size(); ++e)
+	{
+		this->g0[e] = this->events[e]->g(t, system);
+	}
+	return;
+}
+
+template<typename T>
+inline void EventDetector<T>::interpolate(const T t)
+{
+	const size_t n = this->x0.size();
+	const T h = this->t1 - this->t0;
+	const T s = (h != (T)0) ? (t - this->t0) / h : (T)1;
+	T *x = this->xc.data();
+	T a, b, c, d;
+
+	if (this->interpolation == HERMITE)
+	{
+		a = ((T)2 * s - (T)3) * s * s + (T)1;		// h00
+		b = ((s - (T)2) * s + (T)1) * s * h;		// h10 h
+		c = ((T)3 - (T)2 * s) * s * s;				// h01
+		d = (s - (T)1) * s * s * h;					// h11 h
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] = a * this->x0[i] + b * this->f0[i] + c * this->x1[i] + d * this->f1[i];
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			x[i] = this->x0[i] + s * (this->x1[i] - this->x0[i]);
+		}
+	}
+	return;
+}
+
+template<typename T>
+T EventDetector<T>::locate(const size_t event)
+/*    Racine de g sur [t0, t1] par la méthode "Illinois" : regula falsi dont
+ * la borne qui ne bouge pas voit sa valeur divisée par deux (convergence
+ * superlinéaire, sans la stagnation de la regula falsi).
+ */
+{
+	T a = this->t0, b = this->t1;
+	T ga = this->g0[event], gb = this->g1[event];
+	T t, gt;
+	int side = 0;
+
+	for (unsigned int k = 0; k < this->maxiterations; ++k)
+	{
+		t = (ga != gb) ? b - gb * (b - a) / (gb - ga) : (a + b) / (T)2;
+		if ( !(t > a) || !(t < b) )
+		{
+			t = (a + b) / (T)2;
+		}
+		if ( (b - a <= this->tolerance) || !(t > a) || !(t < b) )
+		{
+			break;
+		}
+
+		this->interpolate(t);
+		gt = this->events[event]->g(t, this->xc);
+		if (gt == (T)0)
+		{
+			return t;
+		}
+		if ( (gt > (T)0) == (gb > (T)0) )
+		{
+			b = t;
+			gb = gt;
+			if (side == -1)
+			{
+				ga /= (T)2;
+			}
+			side = -1;
+		}
+		else
+		{
+			a = t;
+			ga = gt;
+			if (side == 1)
+			{
+				gb /= (T)2;
+			}
+			side = 1;
+		}
+	}
+	return b;		// Côté où le signe a changé.
+}
+
+template<typename T>
+void EventDetector<T>::after(Integrator<T> &integrator)
+{
+	DynamicalSystem<T> &system = this->simulation->getdynamicalsystem();
+	const size_t n = system.size();
+	typename Event<T>::Action action;
+	Crossing crossing;
+	bool rising, falling;
+
+	this->t1 = this->simulation->getTime();
+	this->x1.assign(system.data(), system.data() + n);
+	if (this->interpolation == HERMITE)
+	{
+		this->derivative(system, this->t1, this->f1);
+	}
+	this->g1.resize(this->events.size());
+	this->crossings.clear();
+	for (size_t e = 0; e < this->events.size(); ++e)
+	{
+		this->g1[e] = this->events[e]->g(this->t1, system);
+
+		rising = (this->g0[e] < (T)0) && (this->g1[e] >= (T)0);
+		falling = (this->g0[e] > (T)0) && (this->g1[e] <= (T)0);
+		if ( (rising && (this->events[e]->getdirection() != Event<T>::FALLING)) ||
+			 (falling && (this->events[e]->getdirection() != Event<T>::RISING)) )
+		{
+			crossing.event = e;
+			crossing.rising = rising;
+			crossing.t = (this->g1[e] == (T)0) ? this->t1 : T();
+			this->crossings.push_back(crossing);
+		}
+	}
+	this->cached = true;
+	if (this->crossings.empty())
+	{
+		return;
+	}
+
+	this->xc.resize(n);
+	for (size_t c = 0; c < this->crossings.size(); ++c)
+	{
+		if (this->g1[this->crossings[c].event] != (T)0)
+		{
+			this->crossings[c].t = this->locate(this->crossings[c].event);
+		}
+	}
+	std::stable_sort(this->crossings.begin(), this->crossings.end());
+
+	// Événements dans l'ordre chronologique, jusqu'au premier STOP ou RESET.
+	for (size_t c = 0; c < this->crossings.size(); ++c)
+	{
+		this->interpolate(this->crossings[c].t);
+		action = this->events[this->crossings[c].event]->occurred(this->crossings[c].t, this->xc, this->crossings[c].rising);
+		if (action == Event<T>::CONTINUE)
+		{
+			continue;
+		}
+
+		// Le système repart (ou s'arrête) à l'instant de l'événement.
+		for (size_t i = 0; i < n; ++i)
+		{
+			system[i] = this->xc[i];
+		}
+		this->simulation->setTime(this->crossings[c].t);
+		if (dynamic_cast< FixedStepIntegrator<T>* >(&integrator) != NULL)
+		{
+			dynamic_cast< FixedStepIntegrator<T>* >(&integrator)->resetcompensation();
+		}
+		this->cached = false;
+		if (action == Event<T>::STOP)
+		{
+			this->stop = true;
+		}
+		break;
+	}
+	return;
+}
+
+template<typename T>
+void EventDetector<T>::run(OutputSink<T> &sink, const T ti, const T tf)
+{
+	Before transiant(this->simulation, ti);
+	Until nontransiant(this, tf);
+
+	this->stop = false;
+	this->cached = false;
+	try
+	{
+		this->simulation->run(sink, transiant, nontransiant, this->preop, this->postop);
+	}
+	catch (...)
+	{
+		for (size_t e = 0; e < this->events.size(); ++e)
+		{
+			this->events[e]->close();
+		}
+		throw;
+	}
+	for (size_t e = 0; e < this->events.size(); ++e)
+	{
+		this->events[e]->close();
+	}
+	return;
+}
+
+
+#endif
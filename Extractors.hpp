@@ -0,0 +1,335 @@
+#ifndef __EXTRACTORS_HPP__
+#define __EXTRACTORS_HPP__
+
+/* 	Extractors.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Un extracteur est une sortie (OutputSink) qui réduit la trajectoire
+ * d'un "run" à quelques valeurs (lues avec "getvalues" après le "run") : c'est
+ * l'élément de base des balayages de paramètres et des diagrammes de
+ * bifurcation (voir Sweep.hpp). "open" remet l'extracteur à zéro et "clone"
+ * en crée une copie indépendante (une par tâche de fond).
+ *		- ExtremaExtractor : maxima et/ou minima locaux d'un état (affinés par
+ *		  interpolation parabolique sur les trois échantillons du sommet) ;
+ *		- PoincareExtractor : valeur d'un état à chaque traversée d'une section
+ *		  x[index] = level (dans le sens croissant), interpolée linéairement ;
+ *		- MeanExtractor : moyenne de chaque état.
+ *		"maxcount" (0 : pas de limite) borne le nombre de valeurs conservées.
+ *
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include "OutputSink.hpp"
+#include "SystemStates.hpp"
+
+template<typename T>
+class Extractor: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::vector<T> values;
+		size_t maxcount;
+
+		inline bool full(void) const;
+
+	public:
+		Extractor(const size_t maxcount = 0):maxcount(maxcount){};
+		virtual ~Extractor(void){};
+
+		virtual Extractor<T> *clone(void) const = 0;
+
+		inline const std::vector<T> &getvalues(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+};
+
+template<typename T>
+inline bool Extractor<T>::full(void) const
+{
+	return (this->maxcount > 0) && (this->values.size() >= this->maxcount);
+}
+
+template<typename T>
+inline const std::vector<T>& Extractor<T>::getvalues(void) const
+{
+	return this->values;
+}
+
+template<typename T>
+void Extractor<T>::open(const size_type, const T)
+{
+	this->values.clear();
+	return;
+}
+
+
+
+/*	ExtremaExtractor
+ */
+template<typename T>
+class ExtremaExtractor: public Extractor<T>
+{
+	public: typedef typename Extractor<T>::size_type size_type;
+
+	public:
+		enum Kind { MAXIMA = 1, MINIMA = 2, BOTH = 3 };
+
+	protected:
+		size_type index;
+		Kind kind;
+
+		T t[3], x[3];					// Trois derniers échantillons.
+		unsigned long n;
+
+	public:
+		ExtremaExtractor(const size_type index, const Kind kind = MAXIMA, const size_t maxcount = 0);
+		virtual ~ExtremaExtractor(void){};
+
+		virtual Extractor<T> *clone(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+};
+
+template<typename T>
+ExtremaExtractor<T>::ExtremaExtractor(const size_type index, const Kind kind, const size_t maxcount):Extractor<T>(maxcount)
+{
+	this->index = index;
+	this->kind = kind;
+	this->n = 0;
+	return;
+}
+
+template<typename T>
+Extractor<T>* ExtremaExtractor<T>::clone(void) const
+{
+	return new ExtremaExtractor<T>(this->index, this->kind, this->maxcount);
+}
+
+template<typename T>
+void ExtremaExtractor<T>::open(const size_type dimension, const T samplingstep)
+{
+	if (this->index >= dimension)
+	{
+		throw std::out_of_range("ExtremaExtractor::open");
+	}
+	Extractor<T>::open(dimension, samplingstep);
+	this->n = 0;
+	return;
+}
+
+template<typename T>
+void ExtremaExtractor<T>::write(const T t, const SystemStates<T> &states)
+/*    Sommet de la parabole passant par les trois derniers échantillons
+ * (forme de Newton : p(s) = p(t1) + p'(t1) s + a s^2).
+ */
+{
+	T d1, d2, a, slope;
+	bool maximum, minimum;
+
+	this->t[0] = this->t[1];
+	this->x[0] = this->x[1];
+	this->t[1] = this->t[2];
+	this->x[1] = this->x[2];
+	this->t[2] = t;
+	this->x[2] = states[this->index];
+
+	if ( (++this->n < 3) || this->full() )
+	{
+		return;
+	}
+
+	maximum = (this->kind & MAXIMA) && (this->x[1] > this->x[0]) && (this->x[1] >= this->x[2]);
+	minimum = (this->kind & MINIMA) && (this->x[1] < this->x[0]) && (this->x[1] <= this->x[2]);
+	if (!maximum && !minimum)
+	{
+		return;
+	}
+
+	d1 = (this->x[1] - this->x[0]) / (this->t[1] - this->t[0]);
+	d2 = (this->x[2] - this->x[1]) / (this->t[2] - this->t[1]);
+	a = (d2 - d1) / (this->t[2] - this->t[0]);
+	if (a == (T)0)
+	{
+		this->values.push_back(this->x[1]);
+		return;
+	}
+	slope = d1 + a * (this->t[1] - this->t[0]);
+	this->values.push_back(this->x[1] - slope * slope / ((T)4 * a));
+	return;
+}
+
+
+
+/*	PoincareExtractor
+ *
+ *		Valeur de l'état "record" lorsque l'état "index" franchit "level" en
+ * croissant.
+ */
+template<typename T>
+class PoincareExtractor: public Extractor<T>
+{
+	public: typedef typename Extractor<T>::size_type size_type;
+
+	protected:
+		size_type index, record;
+		T level;
+
+		T previous, previousrecord;
+		bool started;
+
+	public:
+		PoincareExtractor(const size_type index, const T level, const size_type record, const size_t maxcount = 0);
+		virtual ~PoincareExtractor(void){};
+
+		virtual Extractor<T> *clone(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+};
+
+template<typename T>
+PoincareExtractor<T>::PoincareExtractor(const size_type index, const T level, const size_type record, const size_t maxcount):Extractor<T>(maxcount)
+{
+	this->index = index;
+	this->level = level;
+	this->record = record;
+	this->started = false;
+	return;
+}
+
+template<typename T>
+Extractor<T>* PoincareExtractor<T>::clone(void) const
+{
+	return new PoincareExtractor<T>(this->index, this->level, this->record, this->maxcount);
+}
+
+template<typename T>
+void PoincareExtractor<T>::open(const size_type dimension, const T samplingstep)
+{
+	if ( (this->index >= dimension) || (this->record >= dimension) )
+	{
+		throw std::out_of_range("PoincareExtractor::open");
+	}
+	Extractor<T>::open(dimension, samplingstep);
+	this->started = false;
+	return;
+}
+
+template<typename T>
+void PoincareExtractor<T>::write(const T, const SystemStates<T> &states)
+{
+	const T current = states[this->index];
+	const T currentrecord = states[this->record];
+	T alpha;
+
+	if ( this->started && !this->full() && (this->previous < this->level) && (current >= this->level) )
+	{
+		alpha = (this->level - this->previous) / (current - this->previous);
+		this->values.push_back(this->previousrecord + alpha * (currentrecord - this->previousrecord));
+	}
+	this->previous = current;
+	this->previousrecord = currentrecord;
+	this->started = true;
+	return;
+}
+
+
+
+/*	MeanExtractor
+ *
+ *		Moyenne de chacun des états (une valeur par état).
+ */
+template<typename T>
+class MeanExtractor: public Extractor<T>
+{
+	public: typedef typename Extractor<T>::size_type size_type;
+
+	protected:
+		unsigned long n;
+		std::vector<T> sums;
+
+	public:
+		MeanExtractor(void):Extractor<T>(0){};
+		virtual ~MeanExtractor(void){};
+
+		virtual Extractor<T> *clone(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+Extractor<T>* MeanExtractor<T>::clone(void) const
+{
+	return new MeanExtractor<T>();
+}
+
+template<typename T>
+void MeanExtractor<T>::open(const size_type dimension, const T samplingstep)
+{
+	Extractor<T>::open(dimension, samplingstep);
+	this->n = 0;
+	this->sums.assign(dimension, (T)0);
+	return;
+}
+
+template<typename T>
+void MeanExtractor<T>::write(const T, const SystemStates<T> &states)
+{
+	const T *x = states.data();
+
+	for (size_t i = 0; i < this->sums.size(); ++i)
+	{
+		this->sums[i] += x[i];
+	}
+	++this->n;
+	return;
+}
+
+template<typename T>
+void MeanExtractor<T>::close(void)
+{
+	this->values.resize(this->sums.size());
+	for (size_t i = 0; i < this->sums.size(); ++i)
+	{
+		this->values[i] = (this->n > 0) ? this->sums[i] / (T)this->n : (T)0;
+	}
+	return;
+}
+
+
+#endif
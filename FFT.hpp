@@ -0,0 +1,367 @@
+#ifndef __FFT_HPP__
+#define __FFT_HPP__
+
+/* 	FFT.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Transformée de Fourier discrète rapide (complexe, à une dimension) de
+ * taille n quelconque, sans dépendance extérieure. Algorithme de Cooley-Tukey
+ * à base mixte : n est décomposé en facteurs 4, 2, puis premiers impairs ;
+ * les bases 2, 3, 4 et 5 ont des papillons spécialisés, les autres un
+ * papillon générique en O(p) par sortie (efficace pour les petits facteurs ; voir
+ * "goodsize" pour choisir une taille de la forme 2^a 3^b 5^c).
+ *
+ *		"forward(data)" : X_k = sum_j x_j exp(-2 i pi j k / n), en place.
+ *		"inverse(data)" : la transformée inverse non normalisée (à diviser par
+ * n). Un même objet ne doit pas être utilisé par plusieurs threads à la fois
+ * (espace de travail interne).
+ *
+ */
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+template<typename T>
+class FFT
+{
+	public: typedef std::complex<T> complex_type;
+
+	protected:
+		size_t n;
+		std::vector<size_t> factors;		// (p, m) : base p, n / p restant
+		std::vector<complex_type> twiddles;
+		mutable std::vector<complex_type> scratch;
+		mutable std::vector<complex_type> buffer;
+
+		void work(complex_type *out, const complex_type *in, const size_t fstride, const size_t *factors) const;
+		static inline complex_type multiply(const complex_type &a, const complex_type &b);
+
+		void butterfly2(complex_type *out, const size_t fstride, const size_t m) const;
+		void butterfly3(complex_type *out, const size_t fstride, const size_t m) const;
+		void butterfly4(complex_type *out, const size_t fstride, const size_t m) const;
+		void butterfly5(complex_type *out, const size_t fstride, const size_t m) const;
+		void butterfly(complex_type *out, const size_t fstride, const size_t m, const size_t p) const;
+
+	public:
+		FFT(const size_t n);
+		virtual ~FFT(void){};
+
+		inline size_t size(void) const;
+
+		void forward(complex_type *data) const;
+		void inverse(complex_type *data) const;
+
+		static size_t goodsize(const size_t n);
+};
+
+template<typename T>
+FFT<T>::FFT(const size_t n)
+{
+	size_t rest = n, p = 4;
+
+	if (n == 0)
+	{
+		throw std::invalid_argument("FFT : size must be positive");
+	}
+	this->n = n;
+	this->twiddles.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		const double phase = -2.0 * M_PI * (double)i / (double)n;
+
+		this->twiddles[i] = complex_type((T)std::cos(phase), (T)std::sin(phase));
+	}
+
+	while (rest > 1)
+	{
+		while (rest % p != 0)
+		{
+			switch (p)
+			{
+				case 4: p = 2; break;
+				case 2: p = 3; break;
+				default: p += 2; break;
+			}
+			if (p * p > rest)
+			{
+				p = rest;
+			}
+		}
+		rest /= p;
+		this->factors.push_back(p);
+		this->factors.push_back(rest);
+	}
+	if (this->factors.empty())
+	{
+		this->factors.push_back(1);
+		this->factors.push_back(1);
+	}
+	this->buffer.resize(n);
+	return;
+}
+
+template<typename T>
+inline size_t FFT<T>::size(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+void FFT<T>::forward(complex_type *data) const
+{
+	std::copy(data, data + this->n, this->buffer.begin());
+	this->work(data, this->buffer.data(), 1, this->factors.data());
+	return;
+}
+
+template<typename T>
+void FFT<T>::inverse(complex_type *data) const
+/*    conj(DFT(conj(x))) = n IDFT(x).
+ */
+{
+	for (size_t i = 0; i < this->n; ++i)
+	{
+		this->buffer[i] = std::conj(data[i]);
+	}
+	this->work(data, this->buffer.data(), 1, this->factors.data());
+	for (size_t i = 0; i < this->n; ++i)
+	{
+		data[i] = std::conj(data[i]);
+	}
+	return;
+}
+
+template<typename T>
+void FFT<T>::work(complex_type *out, const complex_type *in, const size_t fstride, const size_t *factors) const
+/*    Décimation temporelle récursive : les p sous-suites (pas fstride p) sont
+ * transformées, puis combinées par les papillons de base p.
+ */
+{
+	const size_t p = factors[0];
+	const size_t m = factors[1];
+
+	if (m == 1)
+	{
+		for (size_t q = 0; q < p; ++q)
+		{
+			out[q] = in[q * fstride];
+		}
+	}
+	else
+	{
+		for (size_t q = 0; q < p; ++q)
+		{
+			this->work(out + q * m, in + q * fstride, fstride * p, factors + 2);
+		}
+	}
+
+	switch (p)
+	{
+		case 1:
+			break;
+		case 2:
+			this->butterfly2(out, fstride, m);
+			break;
+		case 3:
+			this->butterfly3(out, fstride, m);
+			break;
+		case 4:
+			this->butterfly4(out, fstride, m);
+			break;
+		case 5:
+			this->butterfly5(out, fstride, m);
+			break;
+		default:
+			this->butterfly(out, fstride, m, p);
+			break;
+	}
+	return;
+}
+
+template<typename T>
+inline typename FFT<T>::complex_type FFT<T>::multiply(const complex_type &a, const complex_type &b)
+/*    Produit sans le traitement des infinis et NaN de std::complex (appel de
+ * bibliothèque à chaque produit sans -ffast-math).
+ */
+{
+	return complex_type(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+template<typename T>
+void FFT<T>::butterfly2(complex_type *out, const size_t fstride, const size_t m) const
+{
+	for (size_t u = 0; u < m; ++u)
+	{
+		const complex_type t = multiply(out[u + m], this->twiddles[u * fstride]);
+
+		out[u + m] = out[u] - t;
+		out[u] += t;
+	}
+	return;
+}
+
+template<typename T>
+void FFT<T>::butterfly3(complex_type *out, const size_t fstride, const size_t m) const
+{
+	const T sine = this->twiddles[fstride * m].imag();		// -sin(2 pi / 3)
+
+	for (size_t u = 0; u < m; ++u)
+	{
+		const complex_type s1 = multiply(out[u + m], this->twiddles[u * fstride]);
+		const complex_type s2 = multiply(out[u + 2 * m], this->twiddles[2 * u * fstride]);
+		const complex_type sum = s1 + s2;
+		const complex_type difference = (s1 - s2) * sine;
+		const complex_type half = out[u] - sum * (T)0.5;
+
+		out[u] += sum;
+		out[u + m] = complex_type(half.real() - difference.imag(), half.imag() + difference.real());
+		out[u + 2 * m] = complex_type(half.real() + difference.imag(), half.imag() - difference.real());
+	}
+	return;
+}
+
+template<typename T>
+void FFT<T>::butterfly4(complex_type *out, const size_t fstride, const size_t m) const
+{
+	for (size_t u = 0; u < m; ++u)
+	{
+		const complex_type s0 = multiply(out[u + m], this->twiddles[u * fstride]);
+		const complex_type s1 = multiply(out[u + 2 * m], this->twiddles[2 * u * fstride]);
+		const complex_type s2 = multiply(out[u + 3 * m], this->twiddles[3 * u * fstride]);
+		const complex_type s3 = s0 + s2;
+		const complex_type s4 = s0 - s2;
+		const complex_type s5 = out[u] - s1;
+		const complex_type s6 = out[u] + s1;
+
+		out[u] = s6 + s3;
+		out[u + 2 * m] = s6 - s3;
+		out[u + m] = complex_type(s5.real() + s4.imag(), s5.imag() - s4.real());
+		out[u + 3 * m] = complex_type(s5.real() - s4.imag(), s5.imag() + s4.real());
+	}
+	return;
+}
+
+template<typename T>
+void FFT<T>::butterfly5(complex_type *out, const size_t fstride, const size_t m) const
+{
+	const complex_type ya = this->twiddles[fstride * m];		// exp(-2 i pi / 5)
+	const complex_type yb = this->twiddles[2 * fstride * m];
+
+	for (size_t u = 0; u < m; ++u)
+	{
+		const complex_type s0 = out[u];
+		const complex_type s1 = multiply(out[u + m], this->twiddles[u * fstride]);
+		const complex_type s2 = multiply(out[u + 2 * m], this->twiddles[2 * u * fstride]);
+		const complex_type s3 = multiply(out[u + 3 * m], this->twiddles[3 * u * fstride]);
+		const complex_type s4 = multiply(out[u + 4 * m], this->twiddles[4 * u * fstride]);
+		const complex_type s7 = s1 + s4, s10 = s1 - s4;
+		const complex_type s8 = s2 + s3, s9 = s2 - s3;
+		const complex_type s5(s0.real() + s7.real() * ya.real() + s8.real() * yb.real(), s0.imag() + s7.imag() * ya.real() + s8.imag() * yb.real());
+		const complex_type s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(), -s10.real() * ya.imag() - s9.real() * yb.imag());
+		const complex_type s11(s0.real() + s7.real() * yb.real() + s8.real() * ya.real(), s0.imag() + s7.imag() * yb.real() + s8.imag() * ya.real());
+		const complex_type s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(), s10.real() * yb.imag() - s9.real() * ya.imag());
+
+		out[u] = s0 + s7 + s8;
+		out[u + m] = s5 - s6;
+		out[u + 4 * m] = s5 + s6;
+		out[u + 2 * m] = s11 + s12;
+		out[u + 3 * m] = s11 - s12;
+	}
+	return;
+}
+
+template<typename T>
+void FFT<T>::butterfly(complex_type *out, const size_t fstride, const size_t m, const size_t p) const
+{
+	this->scratch.resize(p);
+	for (size_t u = 0; u < m; ++u)
+	{
+		for (size_t q = 0; q < p; ++q)
+		{
+			this->scratch[q] = out[u + q * m];
+		}
+		for (size_t q = 0; q < p; ++q)
+		{
+			const size_t k = u + q * m;
+			const size_t step = (fstride * k) % this->n;
+			complex_type sum = this->scratch[0];
+			size_t index = 0;
+
+			for (size_t r = 1; r < p; ++r)
+			{
+				index += step;
+				if (index >= this->n)
+				{
+					index -= this->n;
+				}
+				sum += multiply(this->scratch[r], this->twiddles[index]);
+			}
+			out[k] = sum;
+		}
+	}
+	return;
+}
+
+template<typename T>
+size_t FFT<T>::goodsize(const size_t n)
+/*    Plus petite taille >= n de la forme 2^a 3^b 5^c.
+ */
+{
+	for (size_t size = std::max<size_t>(n, 1); ; ++size)
+	{
+		size_t rest = size;
+
+		while (rest % 2 == 0)
+		{
+			rest /= 2;
+		}
+		while (rest % 3 == 0)
+		{
+			rest /= 3;
+		}
+		while (rest % 5 == 0)
+		{
+			rest /= 5;
+		}
+		if (rest == 1)
+		{
+			return size;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef __FINGERPRINT_HPP__
+#define __FINGERPRINT_HPP__
+
+/* 	Fingerprint.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Empreinte (hachage FNV-1a 64 bits) du contenu d'une configuration de
+ * simulation : paramètres d'un système, topologie d'un réseau, état initial,
+ * réglages d'un intégrateur, etc. Deux configurations de même empreinte sont
+ * considérées comme identiques (voir TransientCache.hpp).
+ *		Les valeurs sont ajoutées octet par octet, dans l'ordre : l'empreinte
+ * dépend donc de l'ordre des appels à "add". Une classe ajoute d'abord son nom
+ * ("add(typeid(*this).name())") pour ne pas être confondue avec une autre
+ * classe ayant les mêmes valeurs.
+ *		Une méthode "fingerprint" ne vaut que pour la classe qui la définit :
+ * elle renvoie false si "typeid(*this)" est une classe dérivée, dont les
+ * paramètres supplémentaires seraient ignorés. Une classe dérivée doit donc
+ * redéfinir "fingerprint" pour avoir une empreinte.
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+class Fingerprint
+{
+	protected:
+		uint64_t hash;
+
+	public:
+		Fingerprint(void);
+		virtual ~Fingerprint(void){};
+
+		inline void reset(void);
+
+		inline void add(const void *data, const size_t size);
+		inline void add(const char *text);
+		inline void add(const std::string &text);
+		template<typename U> inline void add(const U value);
+		template<typename U> inline void add(const std::vector<U> &values);
+
+		inline uint64_t value(void) const;
+		inline std::string hex(void) const;
+		static inline std::string hex(const uint64_t value);
+};
+
+inline Fingerprint::Fingerprint(void)
+{
+	this->reset();
+	return;
+}
+
+inline void Fingerprint::reset(void)
+{
+	this->hash = 14695981039346656037ULL;
+	return;
+}
+
+inline void Fingerprint::add(const void *data, const size_t size)
+{
+	const unsigned char *p = (const unsigned char*)data;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		this->hash ^= p[i];
+		this->hash *= 1099511628211ULL;
+	}
+	return;
+}
+
+inline void Fingerprint::add(const char *text)
+/*    La longueur est ajoutée avant le texte : ("ab", "c") et ("a", "bc") ont
+ * des empreintes différentes.
+ */
+{
+	this->add(std::string(text));
+	return;
+}
+
+inline void Fingerprint::add(const std::string &text)
+{
+	const uint64_t size = text.size();
+
+	this->add(&size, sizeof(size));
+	this->add(text.data(), text.size());
+	return;
+}
+
+template<typename U>
+inline void Fingerprint::add(const U value)
+{
+	this->add(&value, sizeof(U));
+	return;
+}
+
+template<typename U>
+inline void Fingerprint::add(const std::vector<U> &values)
+{
+	const uint64_t size = values.size();
+
+	this->add(&size, sizeof(size));
+	this->add(values.data(), values.size() * sizeof(U));
+	return;
+}
+
+inline uint64_t Fingerprint::value(void) const
+{
+	return this->hash;
+}
+
+inline std::string Fingerprint::hex(void) const
+{
+	return hex(this->hash);
+}
+
+inline std::string Fingerprint::hex(const uint64_t value)
+{
+	char text[17];
+
+	snprintf(text, sizeof(text), "%016llx", (unsigned long long)value);
+	return std::string(text);
+}
+
+#endif
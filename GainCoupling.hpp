@@ -33,6 +33,7 @@
  * 
  */
 
+#include "ConnectionStore.hpp"
 #include "StatesCoupling.hpp"
 
 template<typename T>
@@ -64,6 +65,10 @@ class GainCoupling: public StatesCoupling<T>
 
 		virtual T operator()(void);
 
+		inline GainLink<T> link(void) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+
 };
 
 template<typename T>
@@ -79,6 +84,28 @@ inline T GainCoupling<T>::operator()(void)
 	return (this->gain)*(this->network->x(this->from) - this->network->x(this->to));
 }
 
+template<typename T>
+inline GainLink<T> GainCoupling<T>::link(void) const
+/*    Équivalent par valeur, pour Network::connect.
+ */
+{
+	return GainLink<T>(this->from, this->to, this->gain);
+}
+
+template<typename T>
+bool GainCoupling<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(GainCoupling<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->from);
+	fingerprint.add((uint64_t)this->to);
+	fingerprint.add(this->gain);
+	return true;
+}
+
 
 #endif
 
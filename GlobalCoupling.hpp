@@ -0,0 +1,66 @@
+#ifndef __GLOBALCOUPLING_HPP__
+#define __GLOBALCOUPLING_HPP__
+
+/* 	GlobalCoupling.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Couplage portant sur l'ensemble d'un réseau (opérateur de couplage,
+ * champ moyen, etc.) : au lieu d'une connexion par arc, un seul objet ajoute
+ * à la dérivée de tous les nœuds concernés le terme de couplage, calculé en
+ * une passe sur le vecteur d'état ("apply", appelé par Network::f après les
+ * "localf" et les connexions stockées par valeur).
+ *		Il est ajouté au réseau par Network::add, qui n'en prend pas possession
+ * (voir NetworkBuilder pour une création dans une arena du réseau).
+ *		"fingerprint" : voir Connection.hpp.
+ *
+ */
+
+#include "Fingerprint.hpp"
+
+template<typename T>
+class GlobalCoupling
+{
+	public:
+		GlobalCoupling(void){};
+		virtual ~GlobalCoupling(void){};
+
+		/*    Ajoute le terme de couplage à "dx", x et dx étant les vecteurs
+		 * d'état et de dérivée complets du réseau.
+		 */
+		virtual void apply(const T *x, T *dx) const = 0;
+
+		virtual bool fingerprint(Fingerprint &) const {return false;};
+};
+
+
+
+#endif
@@ -45,6 +45,25 @@
  *
  *	Adrien KERFOURN
  *
+ *		Les intégrateurs à pas fixe disposent d'un mode de sommation compensée
+ * (Kahan/Neumaier) pour la mise à jour des états et du temps. L'erreur
+ * d'arrondi de chaque addition "x + step * dx" est conservée dans un terme de
+ * compensation et réinjectée à l'addition suivante. Cela permet de faire de
+ * très longues simulations (10^9 pas et plus) dans un type étroit (float,
+ * double) avec une précision proche de celle d'un type plus large. Ce mode est
+ * désactivé par défaut (voir "setcompensation").
+ *		/!\ Les options de type "-ffast-math" suppriment la compensation (le
+ * compilateur simplifie les termes d'erreur).
+ *
+ *		"save" et "load" sauvegardent et restaurent l'état interne d'un
+ * intégrateur (pas, termes de compensation, historique d'une méthode
+ * multi-pas, etc.) pour la reprise d'une simulation (voir Checkpoint.hpp). Un
+ * intégrateur sans état interne n'a pas à les redéfinir.
+ *		"fingerprint" ajoute la méthode et ses réglages à une empreinte (voir
+ * Fingerprint.hpp et TransientCache.hpp). Les intégrateurs à pas fixe fournis
+ * utilisent leur nom de classe et "save" ("fingerprintstate") ; une classe
+ * dérivée doit redéfinir "fingerprint" pour avoir une empreinte.
+ *
  * TODO FIXME Il est possible que le retour de référence soit inutile. À voir si
  * une classe générant des diagrammes de bifurcations peut le faire élégamment
  * sans ce retour.
@@ -60,6 +79,13 @@
 #include "SystemStates.hpp"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "Fingerprint.hpp"
+#include "TrajectoryFormat.hpp"
 
 template<typename T>
 class Integrator
@@ -68,6 +94,11 @@ class Integrator
 		virtual ~Integrator(void){};
 
 		virtual void operator()(T &t, DynamicalSystem<T> &system) = 0;
+
+		virtual void save(std::string &) const {};
+		virtual void load(const char *, const size_t) {};
+
+		virtual bool fingerprint(Fingerprint &) const {return false;};
 };
 
 
@@ -78,6 +109,18 @@ class FixedStepIntegrator: public Integrator<T>
 	protected:
 		T step;
 
+		bool compensation;
+		std::vector<T> cx;	// Termes de compensation des états.
+		T ct;				// Terme de compensation du temps.
+
+		static inline void accumulate(T &sum, T &carry, const T value);
+
+		inline void prepare(const DynamicalSystem<T> &system);
+		inline void increment(DynamicalSystem<T> &system, const long i, const T delta);
+		inline void advance(T &t);
+
+		bool fingerprintstate(Fingerprint &fingerprint) const;
+
 	public:
 		FixedStepIntegrator(void);
 		FixedStepIntegrator(T step);
@@ -87,11 +130,19 @@ class FixedStepIntegrator: public Integrator<T>
 		inline T &getstep(void);
 		inline void setstep(T newstep);
 		inline void setstep(FixedStepIntegrator<T> &other);
+
+		inline void setcompensation(bool enabled);
+		inline bool getcompensation(void) const;
+		inline void resetcompensation(void);
+
+		virtual void save(std::string &state) const;
+		virtual void load(const char *state, const size_t size);
 };
 
 template<typename T>
 FixedStepIntegrator<T>::FixedStepIntegrator(void)
 {
+	this->setcompensation(false);
 	this->setstep( (T)0.0 );
 	return;
 }
@@ -99,6 +150,7 @@ FixedStepIntegrator<T>::FixedStepIntegrator(void)
 template<typename T>
 FixedStepIntegrator<T>::FixedStepIntegrator(T step)
 {
+	this->setcompensation(false);
 	this->setstep( (T)step );
 	return;
 }
@@ -106,6 +158,7 @@ FixedStepIntegrator<T>::FixedStepIntegrator(T step)
 template<typename T>
 FixedStepIntegrator<T>::FixedStepIntegrator(FixedStepIntegrator<T> &other)
 {
+	this->setcompensation( other.getcompensation() );
 	this->setstep(other);
 	return;
 }
@@ -138,6 +191,154 @@ inline void FixedStepIntegrator<T>::setstep(FixedStepIntegrator<T> &other)
 
 
 
+template<typename T>
+inline void FixedStepIntegrator<T>::setcompensation(bool enabled)
+{
+	this->compensation = enabled;
+	this->resetcompensation();
+	return;
+}
+
+template<typename T>
+inline bool FixedStepIntegrator<T>::getcompensation(void) const
+{
+	return this->compensation;
+}
+
+template<typename T>
+inline void FixedStepIntegrator<T>::resetcompensation(void)
+/*    Remet à zéro les termes de compensation. À appeler lorsque les états du
+ * système sont modifiés en dehors de l'intégrateur (nouvelle condition
+ * initiale, autre système, etc.).
+ */
+{
+	this->cx.assign(this->cx.size(), (T)0.0);
+	this->ct = (T)0.0;
+	return;
+}
+
+
+
+template<typename T>
+void FixedStepIntegrator<T>::save(std::string &state) const
+/*    Pas, mode de compensation et termes de compensation (en petit-boutiste).
+ */
+{
+	BinaryFormat::append(state, this->step);
+	BinaryFormat::append(state, (uint32_t)(this->compensation ? 1 : 0));
+	BinaryFormat::append(state, this->ct);
+	BinaryFormat::append(state, (uint64_t)this->cx.size());
+	for (size_t i = 0; i < this->cx.size(); ++i)
+	{
+		BinaryFormat::append(state, this->cx[i]);
+	}
+	return;
+}
+
+template<typename T>
+void FixedStepIntegrator<T>::load(const char *state, const size_t size)
+{
+	const size_t head = 2 * sizeof(T) + sizeof(uint32_t) + sizeof(uint64_t);
+	uint64_t n;
+
+	if (size < head)
+	{
+		throw std::runtime_error("FixedStepIntegrator::load");
+	}
+	n = BinaryFormat::load<uint64_t>(state + head - sizeof(uint64_t));
+	if ((size - head) / sizeof(T) != n || (size - head) % sizeof(T) != 0)
+	{
+		throw std::runtime_error("FixedStepIntegrator::load");
+	}
+
+	this->step = BinaryFormat::load<T>(state);
+	this->compensation = (BinaryFormat::load<uint32_t>(state + sizeof(T)) != 0);
+	this->ct = BinaryFormat::load<T>(state + sizeof(T) + sizeof(uint32_t));
+	this->cx.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		this->cx[i] = BinaryFormat::load<T>(state + head + i * sizeof(T));
+	}
+	return;
+}
+
+template<typename T>
+bool FixedStepIntegrator<T>::fingerprintstate(Fingerprint &fingerprint) const
+/*    Nom de classe et état interne ("save") : empreinte d'une méthode à pas
+ * fixe sans autre paramètre.
+ */
+{
+	std::string state;
+
+	this->save(state);
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add(state);
+	return true;
+}
+
+
+
+template<typename T>
+inline void FixedStepIntegrator<T>::accumulate(T &sum, T &carry, const T value)
+/*    Sommation compensée de Neumaier : "sum" reçoit "sum + value" et
+ * "carry" la partie perdue par l'arrondi, réinjectée à l'appel suivant.
+ */
+{
+	T y = value + carry;
+	T s = sum + y;
+
+	if ( (sum >= (T)0.0 ? sum : -sum) >= (y >= (T)0.0 ? y : -y) )
+	{
+		carry = (sum - s) + y;
+	}
+	else
+	{
+		carry = (y - s) + sum;
+	}
+	sum = s;
+	return;
+}
+
+template<typename T>
+inline void FixedStepIntegrator<T>::prepare(const DynamicalSystem<T> &system)
+{
+	if ( this->compensation && ((long)this->cx.size() != system.size()) )
+	{
+		this->cx.assign(system.size(), (T)0.0);
+	}
+	return;
+}
+
+template<typename T>
+inline void FixedStepIntegrator<T>::increment(DynamicalSystem<T> &system, const long i, const T delta)
+{
+	if (this->compensation)
+	{
+		accumulate(system[i], this->cx[i], delta);
+	}
+	else
+	{
+		system[i] = system[i] + delta;
+	}
+	return;
+}
+
+template<typename T>
+inline void FixedStepIntegrator<T>::advance(T &t)
+{
+	if (this->compensation)
+	{
+		accumulate(t, this->ct, this->step);
+	}
+	else
+	{
+		t = t + this->step;
+	}
+	return;
+}
+
+
+
 
 #endif
 
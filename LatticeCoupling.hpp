@@ -0,0 +1,375 @@
+#ifndef __LATTICECOUPLING_HPP__
+#define __LATTICECOUPLING_HPP__
+
+/* 	LatticeCoupling.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Couplage non local d'un réseau en réseau régulier (lattice) à une ou
+ * deux dimensions (nx x ny nœuds, le nœud (ix, iy) étant le nœud
+ * iy nx + ix), par un noyau invariant par translation k(dx, dy) de portée
+ * |dx| <= rx, |dy| <= ry :
+ *		- LAPLACIAN :	dx_i += K sum_j k(i - j) (x_j - x_i)
+ *		- ADJACENCY :	dx_i += K sum_j k(i - j) x_j
+ * La somme est une convolution, calculée par FFT (voir FFT.hpp) en
+ * O(n log n) par évaluation, quelle que soit la portée du noyau (au lieu de
+ * O(n (2 rx + 1) (2 ry + 1)) avec une connexion par arc).
+ *
+ *		Bords :
+ *		- PERIODIC : réseau torique ; la grille de la FFT est le réseau
+ *		  lui-même (un noyau plus large que le réseau s'y replie) ;
+ *		- ZERO : pas de voisin hors du réseau ; la grille est complétée par
+ *		  des zéros jusqu'à une taille >= nx + rx (resp. ny + ry) de la forme
+ *		  2^a 3^b 5^c. Le terme K sum_j k(i - j) x_i du Laplacien, qui dépend
+ *		  alors de la position, est précalculé.
+ *
+ *		Le noyau est donné échantillonné, centré, par lignes :
+ * kernel[(dy + ry)(2 rx + 1) + dx + rx] (voir "sample"). Le couplage porte
+ * sur les "dimension" états "statesoffset"... de chaque nœud, composante par
+ * composante ; les composantes sont transformées deux par deux (parties
+ * réelle et imaginaire d'un même signal complexe, le noyau étant réel).
+ * Les nœuds sont contigus et de même taille ("stride"), le premier état du
+ * nœud 0 étant en "base".
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <complex>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "FFT.hpp"
+#include "Fingerprint.hpp"
+#include "GlobalCoupling.hpp"
+
+template<typename T>
+class LatticeCoupling: public GlobalCoupling<T>
+{
+	public:
+		typedef typename std::vector<T>::size_type size_type;
+		typedef std::complex<T> complex_type;
+		enum Form {LAPLACIAN, ADJACENCY};
+		enum Boundary {PERIODIC, ZERO};
+
+	protected:
+		size_type nx, ny, rx, ry;
+		size_type mx, my;					// Grille de la FFT.
+		size_type base, stride, statesoffset, dimension;
+		T gain;
+		Form form;
+		Boundary boundary;
+		std::vector<T> kernel;
+		FFT<T> fftx, ffty;
+		std::vector<complex_type> spectrum;	// K TF(k) / (mx my)
+		std::vector<T> degrees;				// K sum_j k(i - j) (LAPLACIAN)
+		mutable std::vector<complex_type> grid;
+		mutable std::vector<complex_type> column;
+
+		void transform(complex_type *data, const bool inverse) const;
+		void convolve(void) const;
+
+	public:
+		LatticeCoupling(const size_type nx, const size_type ny, const size_type stride, const T gain, const std::vector<T> &kernel, const size_type rx, const size_type ry, const size_type statesoffset = 0, const size_type dimension = 1, const Form form = LAPLACIAN, const Boundary boundary = PERIODIC);
+		virtual ~LatticeCoupling(void){};
+
+		void setbase(const size_type base);
+
+		inline size_type sizenodes(void) const;
+
+		virtual void apply(const T *x, T *dx) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+
+		template<typename F> static std::vector<T> sample(const size_type rx, const size_type ry, F kernel);
+};
+
+template<typename T>
+LatticeCoupling<T>::LatticeCoupling(const size_type nx, const size_type ny, const size_type stride, const T gain, const std::vector<T> &kernel, const size_type rx, const size_type ry, const size_type statesoffset, const size_type dimension, const Form form, const Boundary boundary):
+	fftx( (boundary == PERIODIC) ? nx : FFT<T>::goodsize(nx + rx) ),
+	ffty( (boundary == PERIODIC) ? ny : FFT<T>::goodsize(ny + ry) )
+{
+	const size_type wx = 2 * rx + 1;
+
+	if ( (nx == 0) || (ny == 0) )
+	{
+		throw std::invalid_argument("LatticeCoupling : empty lattice");
+	}
+	if (kernel.size() != wx * (2 * ry + 1))
+	{
+		throw std::invalid_argument("LatticeCoupling : kernel must have (2 rx + 1)(2 ry + 1) samples");
+	}
+	if ( (dimension == 0) || (statesoffset + dimension > stride) )
+	{
+		throw std::invalid_argument("LatticeCoupling : coupled states exceed node size");
+	}
+	this->nx = nx;
+	this->ny = ny;
+	this->rx = rx;
+	this->ry = ry;
+	this->mx = this->fftx.size();
+	this->my = this->ffty.size();
+	this->base = 0;
+	this->stride = stride;
+	this->statesoffset = statesoffset;
+	this->dimension = dimension;
+	this->gain = gain;
+	this->form = form;
+	this->boundary = boundary;
+	this->kernel = kernel;
+
+	// Noyau placé circulairement sur la grille (k(d) en d mod m), puis
+	// transformé. La normalisation de la FFT inverse et le gain y sont
+	// intégrés.
+	this->grid.assign(this->mx * this->my, complex_type((T)0, (T)0));
+	for (size_type dy = 0; dy < 2 * ry + 1; ++dy)
+	{
+		for (size_type dx = 0; dx < wx; ++dx)
+		{
+			const size_type gx = (dx + this->mx * (rx / this->mx + 1) - rx) % this->mx;
+			const size_type gy = (dy + this->my * (ry / this->my + 1) - ry) % this->my;
+
+			this->grid[gy * this->mx + gx] += complex_type(kernel[dy * wx + dx], (T)0);
+		}
+	}
+	this->transform(this->grid.data(), false);
+	this->spectrum.resize(this->grid.size());
+	for (size_t i = 0; i < this->grid.size(); ++i)
+	{
+		this->spectrum[i] = this->grid[i] * (gain / (T)(this->mx * this->my));
+	}
+
+	// K sum_j k(i - j) : convolution du noyau avec des 1 sur le réseau.
+	if (this->form == LAPLACIAN)
+	{
+		this->grid.assign(this->mx * this->my, complex_type((T)0, (T)0));
+		for (size_type iy = 0; iy < ny; ++iy)
+		{
+			for (size_type ix = 0; ix < nx; ++ix)
+			{
+				this->grid[iy * this->mx + ix] = complex_type((T)1, (T)0);
+			}
+		}
+		this->convolve();
+		this->degrees.resize(nx * ny);
+		for (size_type iy = 0; iy < ny; ++iy)
+		{
+			for (size_type ix = 0; ix < nx; ++ix)
+			{
+				this->degrees[iy * nx + ix] = this->grid[iy * this->mx + ix].real();
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void LatticeCoupling<T>::setbase(const size_type base)
+{
+	this->base = base;
+	return;
+}
+
+template<typename T>
+inline typename LatticeCoupling<T>::size_type LatticeCoupling<T>::sizenodes(void) const
+{
+	return this->nx * this->ny;
+}
+
+template<typename T>
+void LatticeCoupling<T>::transform(complex_type *data, const bool inverse) const
+/*    FFT à deux dimensions : lignes, puis colonnes.
+ */
+{
+	for (size_type iy = 0; iy < this->my; ++iy)
+	{
+		if (inverse)
+		{
+			this->fftx.inverse(data + iy * this->mx);
+		}
+		else
+		{
+			this->fftx.forward(data + iy * this->mx);
+		}
+	}
+	if (this->my == 1)
+	{
+		return;
+	}
+	// Colonnes copiées par groupes de "width" voisines : lignes de cache
+	// entières lues et écrites.
+	const size_type width = 8;
+
+	this->column.resize(width * this->my);
+	for (size_type first = 0; first < this->mx; first += width)
+	{
+		const size_type count = std::min(width, this->mx - first);
+
+		for (size_type iy = 0; iy < this->my; ++iy)
+		{
+			for (size_type k = 0; k < count; ++k)
+			{
+				this->column[k * this->my + iy] = data[iy * this->mx + first + k];
+			}
+		}
+		for (size_type k = 0; k < count; ++k)
+		{
+			if (inverse)
+			{
+				this->ffty.inverse(this->column.data() + k * this->my);
+			}
+			else
+			{
+				this->ffty.forward(this->column.data() + k * this->my);
+			}
+		}
+		for (size_type iy = 0; iy < this->my; ++iy)
+		{
+			for (size_type k = 0; k < count; ++k)
+			{
+				data[iy * this->mx + first + k] = this->column[k * this->my + iy];
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void LatticeCoupling<T>::convolve(void) const
+/*    grid <- K (k * grid).
+ */
+{
+	this->transform(this->grid.data(), false);
+	for (size_t i = 0; i < this->grid.size(); ++i)
+	{
+		const complex_type a = this->grid[i], b = this->spectrum[i];
+
+		this->grid[i] = complex_type(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+	}
+	this->transform(this->grid.data(), true);
+	return;
+}
+
+template<typename T>
+void LatticeCoupling<T>::apply(const T *x, T *dx) const
+{
+	const T *xs = x + this->base + this->statesoffset;
+	T *dxs = dx + this->base + this->statesoffset;
+
+	for (size_type c = 0; c < this->dimension; c += 2)
+	{
+		const bool pair = (c + 1 < this->dimension);
+
+		this->grid.assign(this->mx * this->my, complex_type((T)0, (T)0));
+		for (size_type iy = 0; iy < this->ny; ++iy)
+		{
+			for (size_type ix = 0; ix < this->nx; ++ix)
+			{
+				const T *xi = xs + (iy * this->nx + ix) * this->stride + c;
+
+				this->grid[iy * this->mx + ix] = complex_type(xi[0], pair ? xi[1] : (T)0);
+			}
+		}
+		this->convolve();
+		for (size_type iy = 0; iy < this->ny; ++iy)
+		{
+			for (size_type ix = 0; ix < this->nx; ++ix)
+			{
+				const size_type i = iy * this->nx + ix;
+				const complex_type value = this->grid[iy * this->mx + ix];
+				const T *xi = xs + i * this->stride + c;
+				T *dxi = dxs + i * this->stride + c;
+
+				dxi[0] += value.real();
+				if (pair)
+				{
+					dxi[1] += value.imag();
+				}
+				if (this->form == LAPLACIAN)
+				{
+					dxi[0] -= this->degrees[i] * xi[0];
+					if (pair)
+					{
+						dxi[1] -= this->degrees[i] * xi[1];
+					}
+				}
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+bool LatticeCoupling<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(LatticeCoupling<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->nx);
+	fingerprint.add((uint64_t)this->ny);
+	fingerprint.add((uint64_t)this->rx);
+	fingerprint.add((uint64_t)this->ry);
+	fingerprint.add((uint64_t)this->base);
+	fingerprint.add((uint64_t)this->stride);
+	fingerprint.add((uint64_t)this->statesoffset);
+	fingerprint.add((uint64_t)this->dimension);
+	fingerprint.add(this->gain);
+	fingerprint.add((uint64_t)this->form);
+	fingerprint.add((uint64_t)this->boundary);
+	fingerprint.add(this->kernel);
+	return true;
+}
+
+template<typename T>
+template<typename F>
+std::vector<T> LatticeCoupling<T>::sample(const size_type rx, const size_type ry, F kernel)
+/*    Échantillonne "kernel(dx, dy)" (entiers signés) pour |dx| <= rx,
+ * |dy| <= ry.
+ */
+{
+	std::vector<T> samples;
+
+	samples.reserve((2 * rx + 1) * (2 * ry + 1));
+	for (long dy = -(long)ry; dy <= (long)ry; ++dy)
+	{
+		for (long dx = -(long)rx; dx <= (long)rx; ++dx)
+		{
+			samples.push_back((T)kernel(dx, dy));
+		}
+	}
+	return samples;
+}
+
+#endif
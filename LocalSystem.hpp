@@ -35,6 +35,9 @@
  *
  *		Permet de définir un système local dans un réseau. Sont intérêt est de
  * définir un certain nombre de voisin connecté au système (pour couplage).
+ *		"fingerprint" ajoute les paramètres du système local à une empreinte
+ * (voir Fingerprint.hpp et Network::fingerprint). Par défaut, elle renvoie
+ * false (système inconnu).
  *
  */
 
@@ -74,6 +77,7 @@ class LocalSystem
 		inline void rebase(const size_type basex, const size_type basey);
 
 		void add(Connection<T>& connection);
+		inline void reserve(const size_type nconnections);
 
 
 		inline T &x(const size_type index);
@@ -88,6 +92,7 @@ class LocalSystem
 		virtual void localf(T t) = 0;
 
 		inline size_type sizen(void) const;
+		inline const Connection<T>& neighbor(const size_type i) const;
 
 		virtual size_type sizex(void) = 0;
 		virtual size_type sizey(void) = 0;
@@ -97,6 +102,8 @@ class LocalSystem
 
 		inline size_type getbasex(void) const;
 		inline size_type getbasey(void) const;
+
+		virtual bool fingerprint(Fingerprint &) const {return false;};
 };
 
 template<typename T>
@@ -217,12 +224,25 @@ inline void LocalSystem<T>::add(Connection<T>& connection)
 	return;
 }
 
+template<typename T>
+inline void LocalSystem<T>::reserve(const size_type nconnections)
+{
+	this->neighbors.reserve(nconnections);
+	return;
+}
+
 template<typename T>
 inline typename LocalSystem<T>::size_type LocalSystem<T>::sizen(void) const
 {
 	return this->neighbors.size();
 }
 
+template<typename T>
+inline const Connection<T>& LocalSystem<T>::neighbor(const size_type i) const
+{
+	return *this->neighbors[i];
+}
+
 template<typename T>
 inline void LocalSystem<T>::setcx(SystemStates<T> &x)
 {
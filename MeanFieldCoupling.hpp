@@ -0,0 +1,323 @@
+#ifndef __MEANFIELDCOUPLING_HPP__
+#define __MEANFIELDCOUPLING_HPP__
+
+/* 	MeanFieldCoupling.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Couplage global (tous les nœuds entre eux) calculé par champ moyen, en
+ * O(n) au lieu des n (n - 1) connexions d'un couplage "tous à tous" :
+ *		- DIFFUSIVE :	dx_i += K sum_j w_j (x_j - x_i) = K (S - W x_i),
+ *		  avec S = sum_j w_j x_j et W = sum_j w_j ;
+ *		- SINE (Kuramoto) :	dx_i += K sum_j w_j sin(x_j - x_i)
+ *		  = K (S_sin cos(x_i) - S_cos sin(x_i)).
+ * Les sommes sont calculées une fois par évaluation de la dynamique puis
+ * appliquées à chaque nœud. Le couplage porte sur les "dimension" états
+ * "statesoffset" à "statesoffset + dimension - 1" de chaque nœud, composante
+ * par composante. Les nœuds sont contigus et de même taille ("stride"), le
+ * premier état du nœud 0 étant en "base".
+ *
+ *		Variantes :
+ *		- "setweights(w)" : poids w_j de chaque nœud (1 par défaut) ;
+ *		- "setgroups(groups, gains)" : champs moyens par groupe. Le nœud i du
+ *		  groupe g reçoit K sum_h gains[g G + h] (S_h - W_h x_i), où S_h et W_h
+ *		  sont restreints au groupe h (G groupes) ;
+ *		- "setnormalized(true)" : chaque champ est divisé par le poids total
+ *		  W_h de son groupe (moyenne au lieu de somme, K / N pour un groupe).
+ * Le terme j = i, nul pour les deux formes, n'a pas à être exclu.
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "Fingerprint.hpp"
+#include "GlobalCoupling.hpp"
+
+template<typename T>
+class MeanFieldCoupling: public GlobalCoupling<T>
+{
+	public:
+		typedef typename std::vector<T>::size_type size_type;
+		enum Form {DIFFUSIVE, SINE};
+
+	protected:
+		size_type n;
+		size_type base, stride, statesoffset, dimension;
+		T gain;
+		Form form;
+		bool normalized;
+		std::vector<T> weights;				// vide : tous 1
+		std::vector<uint32_t> groups;		// vide : un seul groupe
+		std::vector<T> gains;				// G x G
+		uint32_t ngroups;
+
+		mutable std::vector<T> sums;		// G x dimension (S ou S_sin)
+		mutable std::vector<T> cosines;		// G x dimension (S_cos)
+		mutable std::vector<T> totals;		// G (W)
+
+		inline T weight(const size_type j) const;
+		inline uint32_t group(const size_type j) const;
+
+	public:
+		MeanFieldCoupling(const size_type n, const size_type stride, const T gain, const size_type statesoffset = 0, const size_type dimension = 1, const Form form = DIFFUSIVE);
+		virtual ~MeanFieldCoupling(void){};
+
+		void setbase(const size_type base);
+		void setgain(const T gain);
+		void setweights(const std::vector<T> &weights);
+		void setgroups(const std::vector<uint32_t> &groups, const std::vector<T> &gains);
+		void setnormalized(const bool normalized);
+
+		inline size_type sizenodes(void) const;
+
+		virtual void apply(const T *x, T *dx) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+};
+
+template<typename T>
+MeanFieldCoupling<T>::MeanFieldCoupling(const size_type n, const size_type stride, const T gain, const size_type statesoffset, const size_type dimension, const Form form)
+{
+	if ( (dimension == 0) || (statesoffset + dimension > stride) )
+	{
+		throw std::invalid_argument("MeanFieldCoupling : coupled states exceed node size");
+	}
+	this->n = n;
+	this->base = 0;
+	this->stride = stride;
+	this->statesoffset = statesoffset;
+	this->dimension = dimension;
+	this->gain = gain;
+	this->form = form;
+	this->normalized = false;
+	this->gains.assign(1, (T)1);
+	this->ngroups = 1;
+	return;
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::setbase(const size_type base)
+{
+	this->base = base;
+	return;
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::setgain(const T gain)
+{
+	this->gain = gain;
+	return;
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::setweights(const std::vector<T> &weights)
+{
+	if ( !weights.empty() && (weights.size() != this->n) )
+	{
+		throw std::invalid_argument("MeanFieldCoupling::setweights : one weight per node is required");
+	}
+	this->weights = weights;
+	return;
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::setgroups(const std::vector<uint32_t> &groups, const std::vector<T> &gains)
+{
+	uint32_t ngroups = 0;
+
+	if (groups.size() != this->n)
+	{
+		throw std::invalid_argument("MeanFieldCoupling::setgroups : one group per node is required");
+	}
+	for (size_type j = 0; j < groups.size(); ++j)
+	{
+		ngroups = std::max(ngroups, groups[j] + 1);
+	}
+	if (gains.size() != (size_t)ngroups * ngroups)
+	{
+		throw std::invalid_argument("MeanFieldCoupling::setgroups : gains must be a G x G matrix");
+	}
+	this->groups = groups;
+	this->gains = gains;
+	this->ngroups = ngroups;
+	return;
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::setnormalized(const bool normalized)
+{
+	this->normalized = normalized;
+	return;
+}
+
+template<typename T>
+inline typename MeanFieldCoupling<T>::size_type MeanFieldCoupling<T>::sizenodes(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+inline T MeanFieldCoupling<T>::weight(const size_type j) const
+{
+	return this->weights.empty() ? (T)1 : this->weights[j];
+}
+
+template<typename T>
+inline uint32_t MeanFieldCoupling<T>::group(const size_type j) const
+{
+	return this->groups.empty() ? 0 : this->groups[j];
+}
+
+template<typename T>
+void MeanFieldCoupling<T>::apply(const T *x, T *dx) const
+{
+	const size_type d = this->dimension;
+	const uint32_t G = this->ngroups;
+	const T *xs = x + this->base + this->statesoffset;
+	T *dxs = dx + this->base + this->statesoffset;
+
+	this->sums.assign((size_t)G * d, (T)0);
+	this->cosines.assign((this->form == SINE) ? (size_t)G * d : 0, (T)0);
+	this->totals.assign(G, (T)0);
+
+	// Champs : une passe sur les nœuds.
+	for (size_type j = 0; j < this->n; ++j)
+	{
+		const T *xj = xs + j * this->stride;
+		const T w = this->weight(j);
+		const uint32_t g = this->group(j);
+		T *sum = this->sums.data() + (size_t)g * d;
+
+		this->totals[g] += w;
+		if (this->form == SINE)
+		{
+			T *cosine = this->cosines.data() + (size_t)g * d;
+
+			for (size_type c = 0; c < d; ++c)
+			{
+				sum[c] += w * std::sin(xj[c]);
+				cosine[c] += w * std::cos(xj[c]);
+			}
+		}
+		else
+		{
+			for (size_type c = 0; c < d; ++c)
+			{
+				sum[c] += w * xj[c];
+			}
+		}
+	}
+
+	// Le gain (et la normalisation) de chaque groupe source est intégré aux
+	// champs : gains[g G + h] ne reste à appliquer qu'en présence de groupes.
+	for (uint32_t h = 0; h < G; ++h)
+	{
+		const T scale = (this->normalized && (this->totals[h] != (T)0)) ? this->gain / this->totals[h] : this->gain;
+
+		for (size_type c = 0; c < d; ++c)
+		{
+			this->sums[(size_t)h * d + c] *= scale;
+			if (this->form == SINE)
+			{
+				this->cosines[(size_t)h * d + c] *= scale;
+			}
+		}
+		this->totals[h] *= scale;
+	}
+
+	// Application : une seconde passe.
+	for (size_type i = 0; i < this->n; ++i)
+	{
+		const T *xi = xs + i * this->stride;
+		T *dxi = dxs + i * this->stride;
+		const uint32_t g = this->group(i);
+
+		for (uint32_t h = 0; h < G; ++h)
+		{
+			const T coefficient = this->gains[(size_t)g * G + h];
+			const T *sum = this->sums.data() + (size_t)h * d;
+
+			if (coefficient == (T)0)
+			{
+				continue;
+			}
+			if (this->form == SINE)
+			{
+				const T *cosine = this->cosines.data() + (size_t)h * d;
+
+				for (size_type c = 0; c < d; ++c)
+				{
+					dxi[c] += coefficient * (sum[c] * std::cos(xi[c]) - cosine[c] * std::sin(xi[c]));
+				}
+			}
+			else
+			{
+				const T total = this->totals[h];
+
+				for (size_type c = 0; c < d; ++c)
+				{
+					dxi[c] += coefficient * (sum[c] - total * xi[c]);
+				}
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+bool MeanFieldCoupling<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(MeanFieldCoupling<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->n);
+	fingerprint.add((uint64_t)this->base);
+	fingerprint.add((uint64_t)this->stride);
+	fingerprint.add((uint64_t)this->statesoffset);
+	fingerprint.add((uint64_t)this->dimension);
+	fingerprint.add(this->gain);
+	fingerprint.add((uint64_t)this->form);
+	fingerprint.add((uint64_t)(this->normalized ? 1 : 0));
+	fingerprint.add(this->weights);
+	fingerprint.add(this->groups);
+	fingerprint.add(this->gains);
+	return true;
+}
+
+#endif
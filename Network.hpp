@@ -35,11 +35,34 @@
  *
  *	Permet de définir un réseau générique.
  *
+ *		L'empreinte d'un réseau (voir Fingerprint.hpp) regroupe celles de ses
+ * systèmes locaux, leurs positions et celles de leurs connexions : elle
+ * n'existe que si tous savent calculer la leur.
+ *
+ *		Un réseau peut posséder des arenas (voir Arena.hpp et
+ * NetworkBuilder.hpp) contenant ses systèmes locaux et ses connexions : elles
+ * sont détruites avec lui ("own"). "reserve" évite les réallocations lors de
+ * l'ajout d'un grand nombre de systèmes.
+ *
+ *		Les connexions peuvent aussi être stockées par valeur dans le réseau
+ * ("connect", voir ConnectionStore.hpp) : elles sont alors appliquées à la
+ * dérivée par une boucle serrée après le calcul de tous les systèmes locaux.
+ * Viennent ensuite les couplages globaux ("add", voir GlobalCoupling.hpp),
+ * qui couplent tous les nœuds à la fois.
+ *
  */
 
+#include <stdint.h>
+
+#include <typeinfo>
 #include <vector>
 
+#include "Arena.hpp"
+#include "ConnectionStore.hpp"
 #include "DynamicalSystem.hpp"
+#include "Fingerprint.hpp"
+#include "GlobalCoupling.hpp"
+#include "LocalSystem.hpp"
 
 
 template<typename T>
@@ -47,16 +70,41 @@ class Network: public DynamicalSystem<T>
 {
 	protected:
 		std::vector< LocalSystem<T>* > systems;
+		std::vector<ArenaBase*> arenas;
+		ConnectionStore<T> connections;
+		std::vector< GlobalCoupling<T>* > couplings;
 
 	public:
 		Network(void):DynamicalSystem<T>(0,0){};
-		virtual ~Network(void){};
+		Network(const Network<T>&) = delete;
+		virtual ~Network(void);
 
 		void add(LocalSystem<T>& system);
+		void add(GlobalCoupling<T>& coupling);
+		void reserve(const size_t nsystems, const size_t nstates, const size_t noutputs);
+		void own(ArenaBase *arena);
+
+		template<typename K> inline typename ConnectionStore<T>::Handle connect(const K &link);
+		inline ConnectionStore<T> &getconnections(void);
 
 		virtual void f(T t, SystemStates<T>& x);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
+template<typename T>
+Network<T>::~Network(void)
+/*    Les arenas sont détruites dans l'ordre inverse de leur ajout (les
+ * connexions, ajoutées après les systèmes, en premier).
+ */
+{
+	for (size_t i = this->arenas.size(); i > 0; --i)
+	{
+		delete this->arenas[i-1];
+	}
+	return;
+}
+
 template<typename T>
 inline void Network<T>::add(LocalSystem<T>& system)
 {
@@ -73,6 +121,46 @@ inline void Network<T>::add(LocalSystem<T>& system)
 	return;
 }
 
+template<typename T>
+inline void Network<T>::add(GlobalCoupling<T>& coupling)
+{
+	this->couplings.push_back(&coupling);
+	return;
+}
+
+template<typename T>
+void Network<T>::reserve(const size_t nsystems, const size_t nstates, const size_t noutputs)
+/*    Place pour "nsystems" systèmes supplémentaires ayant au total "nstates"
+ * états et "noutputs" sorties.
+ */
+{
+	this->systems.reserve(this->systems.size() + nsystems);
+	this->mx.reserve(this->mx.size() + nstates);
+	this->mdx.reserve(this->mdx.size() + nstates);
+	this->my.reserve(this->my.size() + noutputs);
+	return;
+}
+
+template<typename T>
+inline void Network<T>::own(ArenaBase *arena)
+{
+	this->arenas.push_back(arena);
+	return;
+}
+
+template<typename T>
+template<typename K>
+inline typename ConnectionStore<T>::Handle Network<T>::connect(const K &link)
+{
+	return this->connections.add(link);
+}
+
+template<typename T>
+inline ConnectionStore<T> &Network<T>::getconnections(void)
+{
+	return this->connections;
+}
+
 
 
 template<typename T>
@@ -85,9 +173,57 @@ void Network<T>::f(T t, SystemStates<T>& x)
 		this->systems[i]->localf(t);
 		this->systems[i]->unsetcx();
 	}
+	this->connections.apply(x.data(), this->mdx.data());
+	for (size_t i = 0; i < this->couplings.size(); ++i)
+	{
+		this->couplings[i]->apply(x.data(), this->mdx.data());
+	}
 	return;
 }
 
+template<typename T>
+bool Network<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(Network<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->systems.size());
+	for (size_t i = 0; i < this->systems.size(); ++i)
+	{
+		const LocalSystem<T> &system = *this->systems[i];
+
+		if (!system.fingerprint(fingerprint))
+		{
+			return false;
+		}
+		fingerprint.add((uint64_t)system.getbasex());
+		fingerprint.add((uint64_t)system.getbasey());
+		fingerprint.add((uint64_t)system.sizen());
+		for (size_t j = 0; j < system.sizen(); ++j)
+		{
+			if (!system.neighbor(j).fingerprint(fingerprint))
+			{
+				return false;
+			}
+		}
+	}
+	if (!this->connections.fingerprint(fingerprint))
+	{
+		return false;
+	}
+	fingerprint.add((uint64_t)this->couplings.size());
+	for (size_t i = 0; i < this->couplings.size(); ++i)
+	{
+		if (!this->couplings[i]->fingerprint(fingerprint))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 
 #endif
 
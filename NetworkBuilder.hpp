@@ -0,0 +1,348 @@
+#ifndef __NETWORKBUILDER_HPP__
+#define __NETWORKBUILDER_HPP__
+
+/* 	NetworkBuilder.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Construction de grands réseaux. Les systèmes locaux sont des copies
+ * d'un prototype (éventuellement modifiées par une fonction "configure(node,
+ * index)"), construites dans une arena possédée par le réseau (voir Arena.hpp
+ * et Network::own) : l'utilisateur n'a plus à créer ni à garder chaque
+ * objet. Les connexions sont créées de la même façon d'après une topologie
+ * (voir Topology.hpp) : pour chaque arc i -> j de poids w, le nœud j reçoit
+ * une connexion de i.
+ *		"couple(topology, gain, statesoffset)" ajoute au réseau, par valeur (voir
+ * ConnectionStore.hpp), des GainLink de gain "gain w" entre les états
+ * "statesoffset" des deux nœuds. "connect<K>(topology, make)" fait de même
+ * pour une sorte de connexion K quelconque : "make(from, to, w)" renvoie la
+ * connexion (par valeur). Ces connexions ne passent pas par "localf".
+ *		"couple(topology, gain, H, statesoffset, form)" couple les nœuds par un
+ * seul CouplingOperator (couplage vectoriel "gain H sum_j A_ij (x_j - x_i)",
+ * voir CouplingOperator.hpp) créé dans une arena du réseau : les nœuds
+ * doivent être contigus et de même taille.
+ *		"meanfield(gain, statesoffset, dimension, form)" couple de même tous
+ * les nœuds entre eux par champ moyen (voir MeanFieldCoupling.hpp), et
+ * "lattice(nx, ny, gain, kernel, rx, ry, ...)" par un noyau de convolution,
+ * les nœuds formant un réseau régulier nx x ny (voir LatticeCoupling.hpp).
+ *		"symmetric(topology, gain, statesoffset)" couple les nœuds comme
+ * "couple(topology, gain, statesoffset)", pour une topologie symétrique,
+ * mais n'évalue qu'une fois chaque arête (arcs i -> j avec i < j, voir
+ * SymmetricCoupling.hpp).
+ *		"couple<C>(topology, make)" crée au contraire des objets Connection,
+ * ajoutés aux voisins du nœud de destination (et utilisés par son "localf") :
+ * "make(arena, from, to, w)" doit construire la connexion dans l'arena
+ * ("arena.create(...)") et la renvoyer.
+ *
+ *		Les nœuds sont numérotés dans l'ordre de création (0 <= i < size()),
+ * comme dans la topologie. Le prototype ne doit pas avoir de connexion.
+ *
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include "Arena.hpp"
+#include "CouplingOperator.hpp"
+#include "GainCoupling.hpp"
+#include "LatticeCoupling.hpp"
+#include "LocalSystem.hpp"
+#include "MeanFieldCoupling.hpp"
+#include "Network.hpp"
+#include "SymmetricCoupling.hpp"
+#include "Topology.hpp"
+
+template<typename T>
+class NetworkBuilder
+{
+	public: typedef typename LocalSystem<T>::size_type size_type;
+
+	protected:
+		Network<T> *network;
+		std::vector< LocalSystem<T>* > nodes;
+
+		static inline void noconfigure(LocalSystem<T> &, const size_type){};
+
+		size_type stride(void) const;
+
+	public:
+		NetworkBuilder(Network<T> &network);
+		virtual ~NetworkBuilder(void){};
+
+		template<typename S> void addnodes(const size_type n, const S &prototype);
+		template<typename S, typename F> void addnodes(const size_type n, const S &prototype, F configure);
+
+		void couple(const Topology<T> &topology, const T gain, const size_type statesoffset = 0);
+		CouplingOperator<T> &couple(const Topology<T> &topology, const T gain, const std::vector<T> &H, const size_type statesoffset = 0, const typename CouplingOperator<T>::Form form = CouplingOperator<T>::LAPLACIAN);
+		template<typename C, typename F> void couple(const Topology<T> &topology, F make);
+		MeanFieldCoupling<T> &meanfield(const T gain, const size_type statesoffset = 0, const size_type dimension = 1, const typename MeanFieldCoupling<T>::Form form = MeanFieldCoupling<T>::DIFFUSIVE);
+		SymmetricCoupling<T> &symmetric(const Topology<T> &topology, const T gain, const size_type statesoffset = 0);
+		LatticeCoupling<T> &lattice(const size_type nx, const size_type ny, const T gain, const std::vector<T> &kernel, const size_type rx, const size_type ry, const size_type statesoffset = 0, const size_type dimension = 1, const typename LatticeCoupling<T>::Form form = LatticeCoupling<T>::LAPLACIAN, const typename LatticeCoupling<T>::Boundary boundary = LatticeCoupling<T>::PERIODIC);
+		template<typename K, typename F> void connect(const Topology<T> &topology, F make);
+
+		inline size_type size(void) const;
+		inline LocalSystem<T> &node(const size_type i);
+};
+
+template<typename T>
+NetworkBuilder<T>::NetworkBuilder(Network<T> &network)
+{
+	this->network = &network;
+	return;
+}
+
+template<typename T>
+template<typename S>
+void NetworkBuilder<T>::addnodes(const size_type n, const S &prototype)
+{
+	this->addnodes(n, prototype, noconfigure);
+	return;
+}
+
+template<typename T>
+template<typename S, typename F>
+void NetworkBuilder<T>::addnodes(const size_type n, const S &prototype, F configure)
+{
+	Arena<S> *arena;
+
+	if (n == 0)
+	{
+		return;
+	}
+	arena = new Arena<S>();
+	this->network->own(arena);
+	arena->reserve(n);
+	this->nodes.reserve(this->nodes.size() + n);
+
+	for (size_type i = 0; i < n; ++i)
+	{
+		S &node = arena->create(prototype);
+
+		if (i == 0)
+		{
+			this->network->reserve(n, n * node.sizex(), n * node.sizey());
+		}
+		configure(node, this->nodes.size());
+		this->network->add(node);
+		this->nodes.push_back(&node);
+	}
+	return;
+}
+
+template<typename T>
+void NetworkBuilder<T>::couple(const Topology<T> &topology, const T gain, const size_type statesoffset)
+{
+	this->connect< GainLink<T> >(topology,
+		[gain, statesoffset](LocalSystem<T> &from, LocalSystem<T> &to, const T weight)
+		{
+			return GainLink<T>(from.getbasex() + statesoffset, to.getbasex() + statesoffset, gain * weight);
+		});
+	return;
+}
+
+template<typename T>
+CouplingOperator<T> &NetworkBuilder<T>::couple(const Topology<T> &topology, const T gain, const std::vector<T> &H, const size_type statesoffset, const typename CouplingOperator<T>::Form form)
+{
+	Arena< CouplingOperator<T> > *arena;
+
+	if (topology.size() != this->nodes.size())
+	{
+		throw std::invalid_argument("NetworkBuilder::couple : topology size mismatch");
+	}
+	const size_type stride = this->stride();
+
+	arena = new Arena< CouplingOperator<T> >(1);
+	this->network->own(arena);
+
+	CouplingOperator<T> &coupling = arena->create(topology, stride, gain, H, statesoffset, form);
+
+	coupling.setbase(this->nodes[0]->getbasex());
+	this->network->add(coupling);
+	return coupling;
+}
+
+template<typename T>
+MeanFieldCoupling<T> &NetworkBuilder<T>::meanfield(const T gain, const size_type statesoffset, const size_type dimension, const typename MeanFieldCoupling<T>::Form form)
+{
+	Arena< MeanFieldCoupling<T> > *arena;
+	const size_type stride = this->stride();
+
+	arena = new Arena< MeanFieldCoupling<T> >(1);
+	this->network->own(arena);
+
+	MeanFieldCoupling<T> &coupling = arena->create(this->nodes.size(), stride, gain, statesoffset, dimension, form);
+
+	coupling.setbase(this->nodes[0]->getbasex());
+	this->network->add(coupling);
+	return coupling;
+}
+
+template<typename T>
+SymmetricCoupling<T> &NetworkBuilder<T>::symmetric(const Topology<T> &topology, const T gain, const size_type statesoffset)
+{
+	Arena< SymmetricCoupling<T> > *arena;
+
+	if (topology.size() != this->nodes.size())
+	{
+		throw std::invalid_argument("NetworkBuilder::symmetric : topology size mismatch");
+	}
+	arena = new Arena< SymmetricCoupling<T> >(1);
+	this->network->own(arena);
+
+	SymmetricCoupling<T> &coupling = arena->create();
+
+	coupling.reserve(topology.edges() / 2);
+	for (size_type j = 0; j < this->nodes.size(); ++j)
+	{
+		for (uint64_t e = topology.first(j); e < topology.last(j); ++e)
+		{
+			const size_type i = topology.source(e);
+
+			if (i < j)
+			{
+				coupling.add(GainLink<T>(this->nodes[i]->getbasex() + statesoffset, this->nodes[j]->getbasex() + statesoffset, gain * topology.weight(e)));
+			}
+		}
+	}
+	coupling.build();
+	this->network->add(coupling);
+	return coupling;
+}
+
+template<typename T>
+LatticeCoupling<T> &NetworkBuilder<T>::lattice(const size_type nx, const size_type ny, const T gain, const std::vector<T> &kernel, const size_type rx, const size_type ry, const size_type statesoffset, const size_type dimension, const typename LatticeCoupling<T>::Form form, const typename LatticeCoupling<T>::Boundary boundary)
+{
+	Arena< LatticeCoupling<T> > *arena;
+	const size_type stride = this->stride();
+
+	if (nx * ny != this->nodes.size())
+	{
+		throw std::invalid_argument("NetworkBuilder::lattice : lattice size mismatch");
+	}
+	arena = new Arena< LatticeCoupling<T> >(1);
+	this->network->own(arena);
+
+	LatticeCoupling<T> &coupling = arena->create(nx, ny, stride, gain, kernel, rx, ry, statesoffset, dimension, form, boundary);
+
+	coupling.setbase(this->nodes[0]->getbasex());
+	this->network->add(coupling);
+	return coupling;
+}
+
+template<typename T>
+template<typename C, typename F>
+void NetworkBuilder<T>::couple(const Topology<T> &topology, F make)
+{
+	Arena<C> *arena;
+
+	if (topology.size() != this->nodes.size())
+	{
+		throw std::invalid_argument("NetworkBuilder::couple : topology size mismatch");
+	}
+	arena = new Arena<C>();
+	this->network->own(arena);
+	arena->reserve(topology.edges());
+
+	for (size_type j = 0; j < this->nodes.size(); ++j)
+	{
+		LocalSystem<T> &to = *this->nodes[j];
+
+		to.reserve(to.sizen() + topology.indegree(j));
+		for (uint64_t e = topology.first(j); e < topology.last(j); ++e)
+		{
+			to.add(make(*arena, *this->nodes[topology.source(e)], to, topology.weight(e)));
+		}
+	}
+	return;
+}
+
+template<typename T>
+template<typename K, typename F>
+void NetworkBuilder<T>::connect(const Topology<T> &topology, F make)
+/*    Les connexions sont ajoutées par nœud de destination : celles d'un même
+ * nœud sont voisines en mémoire.
+ */
+{
+	ConnectionStore<T> &connections = this->network->getconnections();
+
+	if (topology.size() != this->nodes.size())
+	{
+		throw std::invalid_argument("NetworkBuilder::connect : topology size mismatch");
+	}
+	connections.template reserve<K>(topology.edges());
+
+	for (size_type j = 0; j < this->nodes.size(); ++j)
+	{
+		LocalSystem<T> &to = *this->nodes[j];
+
+		for (uint64_t e = topology.first(j); e < topology.last(j); ++e)
+		{
+			connections.add(make(*this->nodes[topology.source(e)], to, topology.weight(e)));
+		}
+	}
+	return;
+}
+
+template<typename T>
+typename NetworkBuilder<T>::size_type NetworkBuilder<T>::stride(void) const
+/*    Taille commune des nœuds, qui doivent être contigus (couplages globaux).
+ */
+{
+	size_type stride;
+
+	if (this->nodes.empty())
+	{
+		throw std::invalid_argument("NetworkBuilder : no nodes to couple");
+	}
+	stride = this->nodes[0]->sizex();
+	for (size_type i = 0; i < this->nodes.size(); ++i)
+	{
+		if ( (this->nodes[i]->sizex() != stride) || (this->nodes[i]->getbasex() != this->nodes[0]->getbasex() + i * stride) )
+		{
+			throw std::invalid_argument("NetworkBuilder : nodes must be contiguous and of equal size");
+		}
+	}
+	return stride;
+}
+
+template<typename T>
+inline typename NetworkBuilder<T>::size_type NetworkBuilder<T>::size(void) const
+{
+	return this->nodes.size();
+}
+
+template<typename T>
+inline LocalSystem<T> &NetworkBuilder<T>::node(const size_type i)
+{
+	return *this->nodes[i];
+}
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef __NUMA_HPP__
+#define __NUMA_HPP__
+
+/* 	Numa.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Outils NUMA (Linux) sans dépendance à libnuma : description de la
+ * machine d'après /sys/devices/system/node, placement d'un processus sur des
+ * processeurs ("pin") et localisation des pages d'une zone mémoire
+ * ("pages", par l'appel système move_pages sans déplacement).
+ *
+ *		Sous la politique par défaut du noyau, une page est placée sur le nœud
+ * du processeur qui l'écrit le premier ("first touch") : un processus épinglé
+ * sur les processeurs d'un nœud avant d'allouer et d'initialiser ses données
+ * les trouve en mémoire locale.
+ *
+ */
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class Numa
+{
+	public:
+		/*    Pages d'une zone : sur le nœud attendu, sur un autre, ou pas
+		 * encore allouées.
+		 */
+		struct Pages
+		{
+			uint64_t local;
+			uint64_t remote;
+			uint64_t absent;
+
+			Pages(void):local(0), remote(0), absent(0){};
+		};
+
+		static int nodes(void);
+		static std::vector<int> cpus(const int node);
+		static int node(void);
+
+		static std::vector<int> parselist(const std::string &list);
+
+		static bool pin(const std::vector<int> &cpus);
+		static bool pages(const void *address, const size_t length, const int node, Pages &pages);
+};
+
+inline int Numa::nodes(void)
+/*    Nombre de nœuds NUMA (1 si l'information n'est pas disponible).
+ */
+{
+	DIR *directory = opendir("/sys/devices/system/node");
+	struct dirent *entry;
+	int count = 0;
+
+	if (directory == NULL)
+	{
+		return 1;
+	}
+	while ( (entry = readdir(directory)) != NULL )
+	{
+		const std::string name(entry->d_name);
+
+		if ( (name.size() > 4) && (name.compare(0, 4, "node") == 0) && (name.find_first_not_of("0123456789", 4) == std::string::npos) )
+		{
+			count = std::max(count, atoi(name.c_str() + 4) + 1);
+		}
+	}
+	closedir(directory);
+	return std::max(count, 1);
+}
+
+inline std::vector<int> Numa::cpus(const int node)
+/*    Processeurs du nœud "node" ; sans information, tous les processeurs
+ * en ligne.
+ */
+{
+	std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+	std::string list;
+	std::vector<int> cpus;
+
+	if (file && std::getline(file, list))
+	{
+		cpus = Numa::parselist(list);
+	}
+	if (cpus.empty())
+	{
+		const long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+		for (long i = 0; i < std::max(n, 1L); ++i)
+		{
+			cpus.push_back((int)i);
+		}
+	}
+	return cpus;
+}
+
+inline int Numa::node(void)
+/*    Nœud du processeur courant (0 si inconnu).
+ */
+{
+	unsigned cpu = 0, node = 0;
+
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0)
+	{
+		return 0;
+	}
+	return (int)node;
+}
+
+inline std::vector<int> Numa::parselist(const std::string &list)
+/*    Liste au format du noyau : "0-3,8-11".
+ */
+{
+	std::vector<int> cpus;
+	std::istringstream stream(list);
+	std::string range;
+
+	while (std::getline(stream, range, ','))
+	{
+		const size_t dash = range.find('-');
+
+		if (range.find_first_of("0123456789") == std::string::npos)
+		{
+			continue;
+		}
+		if (dash == std::string::npos)
+		{
+			cpus.push_back(atoi(range.c_str()));
+		}
+		else
+		{
+			for (int i = atoi(range.c_str()); i <= atoi(range.c_str() + dash + 1); ++i)
+			{
+				cpus.push_back(i);
+			}
+		}
+	}
+	return cpus;
+}
+
+inline bool Numa::pin(const std::vector<int> &cpus)
+/*    Restreint le processus courant (et les threads qu'il créera) aux
+ * processeurs "cpus".
+ */
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	for (size_t i = 0; i < cpus.size(); ++i)
+	{
+		if ( (cpus[i] >= 0) && (cpus[i] < CPU_SETSIZE) )
+		{
+			CPU_SET(cpus[i], &set);
+		}
+	}
+	return (CPU_COUNT(&set) > 0) && (sched_setaffinity(0, sizeof(set), &set) == 0);
+}
+
+inline bool Numa::pages(const void *address, const size_t length, const int node, Pages &pages)
+/*    Ajoute à "pages" la localisation des pages de [address, address +
+ * length) par rapport au nœud "node". Renvoie false si le noyau ne fournit
+ * pas l'information.
+ */
+{
+	const uintptr_t size = (uintptr_t)sysconf(_SC_PAGESIZE);
+	const size_t batch = 1024;
+	uintptr_t first = (uintptr_t)address & ~(size - 1);
+	const uintptr_t end = (uintptr_t)address + length;
+	std::vector<void*> addresses;
+	std::vector<int> status;
+
+	if (length == 0)
+	{
+		return true;
+	}
+	addresses.reserve(batch);
+	status.resize(batch);
+	while (first < end)
+	{
+		addresses.clear();
+		for (; (first < end) && (addresses.size() < batch); first += size)
+		{
+			addresses.push_back((void*)first);
+		}
+		if (syscall(SYS_move_pages, 0, (unsigned long)addresses.size(), addresses.data(), NULL, status.data(), 0) != 0)
+		{
+			return false;
+		}
+		for (size_t i = 0; i < addresses.size(); ++i)
+		{
+			if (status[i] < 0)
+			{
+				++pages.absent;
+			}
+			else if (status[i] == node)
+			{
+				++pages.local;
+			}
+			else
+			{
+				++pages.remote;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
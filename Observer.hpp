@@ -0,0 +1,203 @@
+#ifndef __OBSERVER_HPP__
+#define __OBSERVER_HPP__
+
+/* 	Observer.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Un observateur est une sortie (OutputSink) qui, au lieu d'écrire la
+ * trajectoire, l'analyse au fil de la simulation (voir Statistics.hpp). Les
+ * résultats sont lus à la fin, aucune trajectoire n'est écrite.
+ *		- "select" restreint l'observation à certains états (tous par défaut) ;
+ *		- "every(k)" n'observe qu'un échantillon sur k.
+ *		Combiné avec Simulation::writingstep (0 : chaque pas), l'observateur
+ * est appelé à chaque pas ou tous les k pas. Plusieurs observateurs peuvent
+ * suivre la même simulation grâce à SinkList.
+ *
+ *		Les classes dérivées définissent "observe", qui reçoit les valeurs des
+ * états sélectionnés (dans l'ordre de la sélection), et "clear" (remise à zéro).
+ *
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include "OutputSink.hpp"
+
+template<typename T>
+class Observer: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::vector<size_type> selection;
+		bool all;						// Pas de sélection : tous les états.
+		size_type nstates;				// Nombre d'états observés.
+
+		unsigned long stride, count;
+
+		std::vector<T> values;
+
+		virtual void observe(const T t, const T *values) = 0;
+		virtual void clear(const size_type nstates) = 0;
+
+	public:
+		Observer(void);
+		Observer(const std::vector<size_type> &selection);
+		virtual ~Observer(void){};
+
+		void select(const std::vector<size_type> &selection);
+		inline void every(const unsigned long k);
+
+		inline size_type size(void) const;
+		inline const std::vector<size_type> &getselection(void) const;
+
+		void reset(void);
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+};
+
+template<typename T>
+Observer<T>::Observer(void)
+{
+	this->all = true;
+	this->nstates = 0;
+	this->stride = 1;
+	this->count = 0;
+	return;
+}
+
+template<typename T>
+Observer<T>::Observer(const std::vector<size_type> &selection)
+{
+	this->all = false;
+	this->nstates = 0;
+	this->stride = 1;
+	this->count = 0;
+	this->selection = selection;
+	return;
+}
+
+template<typename T>
+void Observer<T>::select(const std::vector<size_type> &selection)
+/*    Change la sélection (les statistiques sont remises à zéro).
+ */
+{
+	this->all = false;
+	this->selection = selection;
+	this->nstates = 0;
+	return;
+}
+
+template<typename T>
+inline void Observer<T>::every(const unsigned long k)
+{
+	this->stride = (k > 0) ? k : 1;
+	this->count = 0;
+	return;
+}
+
+template<typename T>
+inline typename Observer<T>::size_type Observer<T>::size(void) const
+{
+	return this->nstates;
+}
+
+template<typename T>
+inline const std::vector<typename Observer<T>::size_type>& Observer<T>::getselection(void) const
+{
+	return this->selection;
+}
+
+template<typename T>
+void Observer<T>::reset(void)
+{
+	this->count = 0;
+	this->clear(this->nstates);
+	return;
+}
+
+
+
+template<typename T>
+void Observer<T>::open(const size_type dimension, const T)
+/*    Au premier "open" (ou après un changement de sélection), la sélection est
+ * vérifiée et les statistiques initialisées. Les "run" suivants continuent
+ * d'accumuler.
+ */
+{
+	if (this->all)
+	{
+		this->selection.resize(dimension);
+		for (size_type i = 0; i < dimension; ++i)
+		{
+			this->selection[i] = i;
+		}
+	}
+	for (size_type i = 0; i < this->selection.size(); ++i)
+	{
+		if (this->selection[i] >= dimension)
+		{
+			throw std::out_of_range("Observer::open");
+		}
+	}
+
+	if ( (this->nstates == 0) || (this->nstates != this->selection.size()) )
+	{
+		this->nstates = this->selection.size();
+		this->values.resize(this->nstates);
+		this->count = 0;
+		this->clear(this->nstates);
+	}
+	return;
+}
+
+template<typename T>
+void Observer<T>::write(const T t, const SystemStates<T> &states)
+{
+	const T *x = states.data();
+
+	if (this->count++ % this->stride != 0)
+	{
+		return;
+	}
+
+	for (size_type i = 0; i < this->nstates; ++i)
+	{
+		this->values[i] = x[this->selection[i]];
+	}
+	this->observe(t, this->nstates > 0 ? &this->values[0] : NULL);
+	return;
+}
+
+
+#endif
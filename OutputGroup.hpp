@@ -0,0 +1,355 @@
+#ifndef __OUTPUTGROUP_HPP__
+#define __OUTPUTGROUP_HPP__
+
+/* 	OutputGroup.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Un groupe de sortie (OutputGroup) n'écrit qu'une partie de l'état, à son
+ * propre rythme, dans sa propre sortie. Chaque colonne du groupe est :
+ *		- un état du système ("add(index)") ;
+ *		- les états d'un LocalSystem ("add(system)"), résolus à l'ouverture,
+ *		  après que le système a été ajouté au réseau ;
+ *		- une moyenne d'états ("mean(indices)") ou d'une même composante sur
+ *		  plusieurs LocalSystem ("mean(systems, index)").
+ *		Le rythme est donné en nombre d'échantillons ("every(k)") ou en temps de
+ * simulation ("interval(dt)"). Un groupe est lui-même une sortie : plusieurs
+ * groupes se combinent avec SinkList, et la simulation est lancée avec
+ * writingstep(0) pour que chaque groupe voie tous les pas.
+ *
+ *		Le coût d'un pas où aucun groupe n'écrit est une comparaison par groupe ;
+ * le coût d'une écriture est proportionnel au nombre de termes du groupe, et
+ * non à la taille du réseau.
+ *
+ */
+
+#include <math.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "SystemStates.hpp"
+#include "LocalSystem.hpp"
+#include "OutputSink.hpp"
+
+template<typename T>
+class OutputGroup: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		/* Terme d'une colonne : état "index" du système "system" (NULL pour un
+		 * indice absolu), pondéré par "weight".
+		 */
+		struct Term
+		{
+			LocalSystem<T> *system;
+			size_type index;
+			T weight;
+		};
+
+		OutputSink<T> *sink;
+
+		std::vector<Term> terms;
+		std::vector<size_type> columns;		// Début de chaque colonne dans "terms".
+
+		// Résolu à l'ouverture.
+		std::vector<size_type> indices;
+		std::vector<T> weights;
+		bool gather;						// Uniquement des états seuls (pas de moyenne).
+
+		unsigned long stride, count;
+		T dt, tfirst, tnext;
+		unsigned long nsamples;
+
+		SystemStates<T> buffer;
+
+		void push(LocalSystem<T> *system, const size_type index, const T weight);
+		inline bool due(const T t);
+
+	public:
+		OutputGroup(OutputSink<T> &sink);
+		virtual ~OutputGroup(void){};
+
+		void add(const size_type index);
+		void add(const std::vector<size_type> &indices);
+		void add(LocalSystem<T> &system);
+		void add(LocalSystem<T> &system, const size_type index);
+
+		void mean(const std::vector<size_type> &indices);
+		void mean(const std::vector< LocalSystem<T>* > &systems, const size_type index);
+
+		inline void every(const unsigned long k);
+		inline void interval(const T dt);
+
+		inline size_type size(void) const;
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+OutputGroup<T>::OutputGroup(OutputSink<T> &sink)
+{
+	this->sink = &sink;
+	this->gather = true;
+	this->stride = 1;
+	this->count = 0;
+	this->dt = (T)0;
+	this->tfirst = (T)0;
+	this->tnext = (T)0;
+	this->nsamples = 0;
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::push(LocalSystem<T> *system, const size_type index, const T weight)
+{
+	Term term;
+
+	term.system = system;
+	term.index = index;
+	term.weight = weight;
+	this->terms.push_back(term);
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::add(const size_type index)
+{
+	this->columns.push_back(this->terms.size());
+	this->push(NULL, index, (T)1);
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::add(const std::vector<size_type> &indices)
+{
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		this->add(indices[i]);
+	}
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::add(LocalSystem<T> &system, const size_type index)
+{
+	if (index >= system.sizex())
+	{
+		throw std::out_of_range("OutputGroup::add");
+	}
+	this->columns.push_back(this->terms.size());
+	this->push(&system, index, (T)1);
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::add(LocalSystem<T> &system)
+{
+	for (size_type i = 0; i < system.sizex(); ++i)
+	{
+		this->add(system, i);
+	}
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::mean(const std::vector<size_type> &indices)
+{
+	if (indices.empty())
+	{
+		throw std::invalid_argument("OutputGroup::mean");
+	}
+	this->columns.push_back(this->terms.size());
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		this->push(NULL, indices[i], (T)1 / (T)indices.size());
+	}
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::mean(const std::vector< LocalSystem<T>* > &systems, const size_type index)
+/*    Moyenne de l'état "index" de chacun des systèmes locaux.
+ */
+{
+	if (systems.empty())
+	{
+		throw std::invalid_argument("OutputGroup::mean");
+	}
+	this->columns.push_back(this->terms.size());
+	for (size_t i = 0; i < systems.size(); ++i)
+	{
+		if (index >= systems[i]->sizex())
+		{
+			throw std::out_of_range("OutputGroup::mean");
+		}
+		this->push(systems[i], index, (T)1 / (T)systems.size());
+	}
+	return;
+}
+
+template<typename T>
+inline void OutputGroup<T>::every(const unsigned long k)
+/*    Un échantillon sur k (le rythme en temps est désactivé).
+ */
+{
+	this->stride = (k > 0) ? k : 1;
+	this->dt = (T)0;
+	return;
+}
+
+template<typename T>
+inline void OutputGroup<T>::interval(const T dt)
+/*    Un échantillon tous les "dt" en temps de simulation (le premier
+ * échantillon reçu est écrit). dt <= 0 revient à every(1).
+ */
+{
+	this->stride = 1;
+	this->dt = (dt > (T)0) ? dt : (T)0;
+	return;
+}
+
+template<typename T>
+inline typename OutputGroup<T>::size_type OutputGroup<T>::size(void) const
+{
+	return this->columns.size();
+}
+
+
+
+template<typename T>
+void OutputGroup<T>::open(const size_type dimension, const T samplingstep)
+/*    Résout les indices (les LocalSystem ont alors leur base dans le réseau)
+ * et ouvre la sortie du groupe avec son propre pas d'échantillonnage.
+ */
+{
+	size_type index;
+
+	this->indices.resize(this->terms.size());
+	this->weights.resize(this->terms.size());
+	this->gather = (this->terms.size() == this->columns.size());
+	for (size_t i = 0; i < this->terms.size(); ++i)
+	{
+		index = this->terms[i].index;
+		if (this->terms[i].system != NULL)
+		{
+			index += this->terms[i].system->getbasex();
+		}
+		if (index >= dimension)
+		{
+			throw std::out_of_range("OutputGroup::open");
+		}
+		this->indices[i] = index;
+		this->weights[i] = this->terms[i].weight;
+	}
+
+	this->buffer.resize(this->columns.size());
+	this->count = 0;
+	this->nsamples = 0;
+
+	this->sink->open(this->columns.size(), (this->dt > (T)0) ? this->dt : samplingstep * (T)this->stride);
+	return;
+}
+
+template<typename T>
+inline bool OutputGroup<T>::due(const T t)
+/*    Les instants d'écriture sont tfirst + k dt (et non des additions
+ * successives de dt, qui accumuleraient les erreurs d'arrondi). Une tolérance
+ * relative absorbe l'arrondi du temps de la simulation.
+ */
+{
+	if (this->dt <= (T)0)
+	{
+		return (this->count++ % this->stride == 0);
+	}
+	if (this->nsamples == 0)
+	{
+		this->tfirst = t;
+	}
+	else if (t < this->tnext - this->dt * (T)1e-9)
+	{
+		return false;
+	}
+	this->nsamples = (unsigned long)floor((double)((t - this->tfirst) / this->dt) + 1e-9) + 1;
+	this->tnext = this->tfirst + (T)this->nsamples * this->dt;
+	return true;
+}
+
+template<typename T>
+void OutputGroup<T>::write(const T t, const SystemStates<T> &states)
+{
+	const T *x = states.data();
+	T *y;
+	size_type end;
+	T sum;
+
+	if (!this->due(t))
+	{
+		return;
+	}
+
+	y = this->buffer.data();
+	if (this->gather)
+	{
+		for (size_t i = 0; i < this->indices.size(); ++i)
+		{
+			y[i] = x[this->indices[i]];
+		}
+	}
+	else
+	{
+		for (size_t c = 0; c < this->columns.size(); ++c)
+		{
+			end = (c + 1 < this->columns.size()) ? this->columns[c+1] : this->indices.size();
+			sum = (T)0;
+			for (size_type i = this->columns[c]; i < end; ++i)
+			{
+				sum += this->weights[i] * x[this->indices[i]];
+			}
+			y[c] = sum;
+		}
+	}
+	this->sink->write(t, this->buffer);
+	return;
+}
+
+template<typename T>
+void OutputGroup<T>::close(void)
+{
+	this->sink->close();
+	return;
+}
+
+
+#endif
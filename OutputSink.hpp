@@ -0,0 +1,267 @@
+#ifndef __OUTPUTSINK_HPP__
+#define __OUTPUTSINK_HPP__
+
+/* 	OutputSink.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Définit l'interface des sorties de simulation ("sink"). Une sortie reçoit
+ * les états échantillonnés par Simulation::run (un appel à "write" par
+ * échantillon) et les écrit où elle le souhaite (fichier texte, fichier
+ * binaire, statistiques, etc.).
+ *		- "open" est appelé au début de chaque "run" avec la dimension du vecteur
+ *		  d'état et le pas d'échantillonnage (0 s'il n'est pas connu) ;
+ *		- "write" est appelé pour chaque échantillon ;
+ *		- "close" est appelé à la fin de chaque "run" (vidage des tampons).
+ *
+ *		SinkList transmet chaque échantillon à plusieurs sorties (par exemple un
+ * fichier et des statistiques). NullSink ignore les échantillons (quand seuls
+ * des événements ou des observateurs produisent des résultats).
+ *
+ *		TextSink écrit un fichier texte (une ligne par échantillon) dont le
+ * format par défaut est celui historiquement produit par Simulation::run. Les
+ * états sont écrits par la méthode (virtuelle, constante) "toString" du
+ * système : "toString(string)" avec le format par défaut, comme l'ancien
+ * Simulation::run, et "toString(string, precision, width, separator)"
+ * sinon. Un système qui redéfinit "toString" garde donc sa sortie.
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "SystemStates.hpp"
+#include "TextFormat.hpp"
+
+template<typename T>
+class OutputSink
+{
+	public: typedef typename SystemStates<T>::size_type size_type;
+
+	public:
+		OutputSink(void){};
+		virtual ~OutputSink(void){};
+
+		virtual void open(const size_type, const T){};
+		virtual void write(const T t, const SystemStates<T> &states) = 0;
+		virtual void close(void){};
+};
+
+
+
+/*	NullSink
+ */
+template<typename T>
+class NullSink: public OutputSink<T>
+{
+	public:
+		NullSink(void){};
+		virtual ~NullSink(void){};
+
+		virtual void write(const T, const SystemStates<T> &){};
+};
+
+
+
+/*	SinkList
+ *
+ *		Sortie multiple : chaque appel est transmis, dans l'ordre d'ajout, à
+ * toutes les sorties de la liste.
+ */
+template<typename T>
+class SinkList: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::vector< OutputSink<T>* > sinks;
+
+	public:
+		SinkList(void){};
+		virtual ~SinkList(void){};
+
+		inline void add(OutputSink<T> &sink);
+
+		virtual void open(const size_type dimension, const T samplingstep);
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+inline void SinkList<T>::add(OutputSink<T> &sink)
+{
+	this->sinks.push_back(&sink);
+	return;
+}
+
+template<typename T>
+void SinkList<T>::open(const size_type dimension, const T samplingstep)
+{
+	for (size_t i = 0; i < this->sinks.size(); ++i)
+	{
+		this->sinks[i]->open(dimension, samplingstep);
+	}
+	return;
+}
+
+template<typename T>
+void SinkList<T>::write(const T t, const SystemStates<T> &states)
+{
+	for (size_t i = 0; i < this->sinks.size(); ++i)
+	{
+		this->sinks[i]->write(t, states);
+	}
+	return;
+}
+
+template<typename T>
+void SinkList<T>::close(void)
+{
+	for (size_t i = 0; i < this->sinks.size(); ++i)
+	{
+		this->sinks[i]->close();
+	}
+	return;
+}
+
+
+
+/*	TextSink
+ *
+ *		Sortie texte : une ligne par échantillon, le temps suivi des états,
+ * séparés par "separator". Par défaut, le format est celui historiquement
+ * utilisé par Simulation::run (temps avec 3 chiffres après la virgule, états
+ * avec 2 chiffres, sur 6 caractères, séparés par une espace).
+ *		Une précision négative donne l'écriture la plus courte permettant de
+ * relire exactement les valeurs (voir TextFormat.hpp). Chaque ligne est
+ * construite dans un tampon réutilisé puis écrite en un seul appel.
+ */
+template<typename T>
+class TextSink: public OutputSink<T>
+{
+	public: typedef typename OutputSink<T>::size_type size_type;
+
+	protected:
+		std::ostream *ostream;
+
+		int timeprecision, timewidth;
+		int precision, width;
+		char separator;
+
+		std::string line;
+
+	public:
+		TextSink(std::ostream &ostream);
+		TextSink(std::ostream &ostream, int precision, int width, char separator);
+		virtual ~TextSink(void){};
+
+		inline void settimeformat(int precision, int width);
+		inline void setformat(int precision, int width);
+		inline void setseparator(char separator);
+
+		virtual void write(const T t, const SystemStates<T> &states);
+		virtual void close(void);
+};
+
+template<typename T>
+TextSink<T>::TextSink(std::ostream &ostream)
+{
+	this->ostream = &ostream;
+	this->settimeformat(3, 6);
+	this->setformat(2, 6);
+	this->setseparator(' ');
+	return;
+}
+
+template<typename T>
+TextSink<T>::TextSink(std::ostream &ostream, int precision, int width, char separator)
+{
+	this->ostream = &ostream;
+	this->settimeformat(3, 6);
+	this->setformat(precision, width);
+	this->setseparator(separator);
+	return;
+}
+
+template<typename T>
+inline void TextSink<T>::settimeformat(int precision, int width)
+{
+	this->timeprecision = precision;
+	this->timewidth = width;
+	return;
+}
+
+template<typename T>
+inline void TextSink<T>::setformat(int precision, int width)
+{
+	this->precision = precision;
+	this->width = width;
+	return;
+}
+
+template<typename T>
+inline void TextSink<T>::setseparator(char separator)
+{
+	this->separator = separator;
+	return;
+}
+
+template<typename T>
+void TextSink<T>::write(const T t, const SystemStates<T> &states)
+{
+	this->line.clear();
+	TextFormat::append(this->line, t, this->timeprecision, this->timewidth);
+
+	if ( (this->precision == 2) && (this->width == 6) && (this->separator == ' ') )
+	{
+		states.toString(this->line);
+	}
+	else
+	{
+		states.toString(this->line, this->precision, this->width, this->separator);
+	}
+	this->line += '\n';
+
+	this->ostream->write(this->line.data(), this->line.size());
+	return;
+}
+
+template<typename T>
+inline void TextSink<T>::close(void)
+{
+	this->ostream->flush();
+	return;
+}
+
+
+#endif
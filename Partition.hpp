@@ -0,0 +1,322 @@
+#ifndef __PARTITION_HPP__
+#define __PARTITION_HPP__
+
+/* 	Partition.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Découpage des nœuds d'une topologie (voir Topology.hpp) en "nparts"
+ * parties de tailles voisines, en coupant peu d'arcs (arcs dont les deux
+ * extrémités sont dans des parties différentes). Utilisé pour répartir un
+ * réseau entre plusieurs processus (voir PartitionedNetwork.hpp).
+ *
+ *		Méthode gloutonne en deux temps :
+ *		- croissance : les parties sont remplies l'une après l'autre par un
+ *		  parcours en largeur partant du plus petit nœud libre, jusqu'à la
+ *		  taille visée (n / nparts). Le découpage en blocs d'indices
+ *		  consécutifs est aussi essayé (il est souvent meilleur pour les
+ *		  topologies générées, numérotées le long de l'anneau ou de la
+ *		  grille) : le moins coupant des deux est retenu ;
+ *		- raffinement : "passes" parcours des nœuds, chacun passant dans la
+ *		  partie de la majorité de ses voisins si cela réduit la coupe et que
+ *		  les tailles restent dans la tolérance "imbalance" (3 % par défaut).
+ *		Les voisins d'un nœud sont les sources de ses arcs entrants : la
+ *		topologie est supposée symétrique (graphe non orienté).
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "Topology.hpp"
+
+template<typename T>
+class Partition
+{
+	protected:
+		std::vector<uint32_t> parts;
+		uint32_t nparts;
+
+		void grow(const Topology<T> &topology);
+		void blocks(const uint64_t n);
+		uint64_t refine(const Topology<T> &topology, const double imbalance);
+
+	public:
+		Partition(void);
+		Partition(const Topology<T> &topology, const uint32_t nparts, const unsigned passes = 8, const double imbalance = 0.03);
+		virtual ~Partition(void){};
+
+		void greedy(const Topology<T> &topology, const uint32_t nparts, const unsigned passes = 8, const double imbalance = 0.03);
+		void assign(const uint32_t nparts, const std::vector<uint32_t> &parts);
+
+		inline uint32_t operator[](const uint64_t node) const;
+		inline uint64_t size(void) const;
+		inline uint32_t getnparts(void) const;
+		inline const std::vector<uint32_t> &getparts(void) const;
+
+		std::vector<uint64_t> sizes(void) const;
+		uint64_t cut(const Topology<T> &topology) const;
+};
+
+template<typename T>
+Partition<T>::Partition(void)
+{
+	this->nparts = 0;
+	return;
+}
+
+template<typename T>
+Partition<T>::Partition(const Topology<T> &topology, const uint32_t nparts, const unsigned passes, const double imbalance)
+{
+	this->greedy(topology, nparts, passes, imbalance);
+	return;
+}
+
+template<typename T>
+void Partition<T>::greedy(const Topology<T> &topology, const uint32_t nparts, const unsigned passes, const double imbalance)
+{
+	if (nparts == 0)
+	{
+		throw std::invalid_argument("Partition::greedy : nparts must be positive");
+	}
+	this->nparts = nparts;
+	this->grow(topology);
+	{
+		const std::vector<uint32_t> grown(this->parts);
+		const uint64_t cut = this->cut(topology);
+
+		this->blocks(topology.size());
+		if (cut < this->cut(topology))
+		{
+			this->parts = grown;
+		}
+	}
+	for (unsigned pass = 0; pass < passes; ++pass)
+	{
+		if (this->refine(topology, imbalance) == 0)
+		{
+			break;
+		}
+	}
+	return;
+}
+
+template<typename T>
+void Partition<T>::assign(const uint32_t nparts, const std::vector<uint32_t> &parts)
+{
+	for (size_t i = 0; i < parts.size(); ++i)
+	{
+		if (parts[i] >= nparts)
+		{
+			throw std::out_of_range("Partition::assign : part index");
+		}
+	}
+	this->nparts = nparts;
+	this->parts = parts;
+	return;
+}
+
+template<typename T>
+void Partition<T>::grow(const Topology<T> &topology)
+{
+	const uint64_t n = topology.size();
+	const uint32_t none = this->nparts;
+	std::vector<uint64_t> queue;
+	uint64_t seed = 0, assigned = 0;
+
+	this->parts.assign(n, none);
+	queue.reserve(n);
+	for (uint32_t p = 0; p < this->nparts; ++p)
+	{
+		// Les premières parties reçoivent un nœud de plus si n n'est pas un
+		// multiple de nparts.
+		const uint64_t target = n / this->nparts + ((p < n % this->nparts) ? 1 : 0);
+		uint64_t count = 0;
+		size_t head = 0;
+
+		queue.clear();
+		while ( (count < target) && (assigned < n) )
+		{
+			if (head == queue.size())
+			{
+				while (this->parts[seed] != none)
+				{
+					++seed;
+				}
+				this->parts[seed] = p;
+				queue.push_back(seed);
+				++count;
+				++assigned;
+				continue;
+			}
+			const uint64_t v = queue[head++];
+
+			for (uint64_t e = topology.first(v); (e < topology.last(v)) && (count < target); ++e)
+			{
+				const uint64_t u = topology.source(e);
+
+				if (this->parts[u] == none)
+				{
+					this->parts[u] = p;
+					queue.push_back(u);
+					++count;
+					++assigned;
+				}
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void Partition<T>::blocks(const uint64_t n)
+{
+	this->parts.resize(n);
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		this->parts[i] = (uint32_t)((i * this->nparts) / n);
+	}
+	return;
+}
+
+template<typename T>
+uint64_t Partition<T>::refine(const Topology<T> &topology, const double imbalance)
+/*    Renvoie le nombre de nœuds déplacés.
+ */
+{
+	const uint64_t n = topology.size();
+	const double average = (double)n / (double)this->nparts;
+	const uint64_t largest = (uint64_t)(average * (1.0 + imbalance)) + 1;
+	const uint64_t smallest = (uint64_t)std::max(0.0, average * (1.0 - imbalance));
+	std::vector<uint64_t> sizes = this->sizes();
+	std::vector<uint64_t> count(this->nparts, 0);
+	std::vector<uint32_t> touched;
+	uint64_t moved = 0;
+
+	for (uint64_t v = 0; v < n; ++v)
+	{
+		const uint32_t current = this->parts[v];
+		uint32_t best = current;
+
+		touched.clear();
+		for (uint64_t e = topology.first(v); e < topology.last(v); ++e)
+		{
+			const uint32_t q = this->parts[topology.source(e)];
+
+			if (count[q]++ == 0)
+			{
+				touched.push_back(q);
+			}
+		}
+		for (size_t k = 0; k < touched.size(); ++k)
+		{
+			const uint32_t q = touched[k];
+
+			if ( (count[q] > count[best]) && (sizes[q] + 1 <= largest) && (sizes[current] >= smallest + 1) )
+			{
+				best = q;
+			}
+		}
+		for (size_t k = 0; k < touched.size(); ++k)
+		{
+			count[touched[k]] = 0;
+		}
+		if (best != current)
+		{
+			this->parts[v] = best;
+			--sizes[current];
+			++sizes[best];
+			++moved;
+		}
+	}
+	return moved;
+}
+
+
+
+template<typename T>
+inline uint32_t Partition<T>::operator[](const uint64_t node) const
+{
+	return this->parts[node];
+}
+
+template<typename T>
+inline uint64_t Partition<T>::size(void) const
+{
+	return this->parts.size();
+}
+
+template<typename T>
+inline uint32_t Partition<T>::getnparts(void) const
+{
+	return this->nparts;
+}
+
+template<typename T>
+inline const std::vector<uint32_t> &Partition<T>::getparts(void) const
+{
+	return this->parts;
+}
+
+template<typename T>
+std::vector<uint64_t> Partition<T>::sizes(void) const
+{
+	std::vector<uint64_t> sizes(this->nparts, 0);
+
+	for (size_t i = 0; i < this->parts.size(); ++i)
+	{
+		++sizes[this->parts[i]];
+	}
+	return sizes;
+}
+
+template<typename T>
+uint64_t Partition<T>::cut(const Topology<T> &topology) const
+{
+	uint64_t cut = 0;
+
+	for (uint64_t v = 0; v < topology.size(); ++v)
+	{
+		for (uint64_t e = topology.first(v); e < topology.last(v); ++e)
+		{
+			if (this->parts[topology.source(e)] != this->parts[v])
+			{
+				++cut;
+			}
+		}
+	}
+	return cut;
+}
+
+#endif
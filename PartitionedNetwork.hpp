@@ -0,0 +1,869 @@
+#ifndef __PARTITIONEDNETWORK_HPP__
+#define __PARTITIONEDNETWORK_HPP__
+
+/* 	PartitionedNetwork.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Réseau réparti entre plusieurs processus d'une même machine. Les nœuds
+ * d'une topologie (voir Topology.hpp) sont découpés en "nprocesses" parties
+ * (voir Partition.hpp) ; chaque partie est simulée par un processus fils
+ * ("run", par fork) qui ne construit que ses nœuds, plus une copie des états
+ * des nœuds voisins appartenant aux autres parties (les "fantômes").
+ *
+ *		À chaque appel de "f" (donc à chaque étage de l'intégrateur), chaque
+ * processus publie dans une mémoire partagée les états de ses nœuds de
+ * frontière (ceux qui sont les fantômes d'une autre partie), puis
+ * attend que ses voisins aient publié le même étage et recopie leurs états
+ * dans ses fantômes (voir HaloNetwork). La synchronisation se fait sans
+ * verrou : un compteur d'étage par processus, écrit avec une sémantique
+ * "release" et lu avec "acquire" ; l'attente est active puis cède le
+ * processeur (sched_yield). Les états sont publiés alternativement dans deux
+ * tampons, ce qui suffit puisqu'un processus ne peut avoir plus d'un étage
+ * d'avance sur ses voisins. La dérivée des fantômes est nulle : leur état
+ * intégré n'est jamais utilisé.
+ *
+ *		Utilisation :
+ *		- "nodes(prototype[, configure])" : les nœuds, copies du prototype,
+ *		  "configure(node, index)" recevant l'indice du nœud dans la
+ *		  topologie ;
+ *		- "couple(gain, statesoffset)" et "connect<K>(make)" : les connexions
+ *		  d'après la topologie, comme NetworkBuilder ; "make(frombase, tobase,
+ *		  w)" reçoit les positions des premiers états des deux nœuds dans le
+ *		  réseau local ;
+ *		- "initial(x)" : l'état initial complet, dans l'ordre de la topologie ;
+ *		- "run(job)" : "job(context)" est appelé dans chaque processus avec le
+ *		  réseau local (voir Context), sur lequel il lance sa Simulation.
+ *		  Au retour, "getstate()" donne l'état final complet.
+ *		Tous les processus doivent appeler "f" le même nombre de fois : même
+ *		intégrateur, même durée, pas de critère d'arrêt dépendant de l'état
+ *		local ni de cache de transitoire. Un processus qui termine ou échoue
+ *		alors que ses voisins l'attendent les fait échouer à leur tour, et
+ *		"run" lève une exception.
+ *
+ *		"run" doit être appelé avant la création de threads (fork ne duplique
+ *		que le thread appelant). Les sorties des fils (fichiers, flux) sont à
+ *		séparer selon "context.rank". Le nombre de processus se choisit
+ *		d'après le nombre de cœurs, de sockets ou de nœuds NUMA.
+ *
+ *		Placement NUMA (voir Numa.hpp) : "pin()" répartit les processus par
+ * blocs de rangs consécutifs sur les nœuds NUMA, et partage entre eux les
+ * processeurs de leur nœud ; "pin(cpus)" donne explicitement les processeurs
+ * de chaque rang. Un fils est épinglé avant de rien allouer : son réseau
+ * (états, dérivées, connexions), l'espace de travail de son intégrateur et
+ * sa part des tampons partagés sont écrits en premier par lui et donc placés
+ * sur son nœud. "setreport(true)" fait afficher par chaque fils, au
+ * démarrage, le nombre de pages locales et distantes de ses états, dérivées
+ * et tampons ; ces nombres sont aussi rendus par "getplacement()".
+ *
+ */
+
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "ConnectionStore.hpp"
+#include "GainCoupling.hpp"
+#include "Network.hpp"
+#include "NetworkBuilder.hpp"
+#include "Numa.hpp"
+#include "Partition.hpp"
+#include "Topology.hpp"
+
+
+/*    Zone de mémoire anonyme partagée entre un processus et ses fils.
+ */
+class SharedMemory
+{
+	protected:
+		void *address;
+		size_t length;
+
+	public:
+		SharedMemory(const size_t length);
+		SharedMemory(const SharedMemory&) = delete;
+		virtual ~SharedMemory(void);
+
+		inline void *data(void) const;
+		inline size_t size(void) const;
+};
+
+inline SharedMemory::SharedMemory(const size_t length)
+{
+	this->length = std::max<size_t>(length, 1);
+	this->address = mmap(NULL, this->length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (this->address == MAP_FAILED)
+	{
+		throw std::runtime_error("SharedMemory : mmap failed");
+	}
+	return;
+}
+
+inline SharedMemory::~SharedMemory(void)
+{
+	munmap(this->address, this->length);
+	return;
+}
+
+inline void *SharedMemory::data(void) const
+{
+	return this->address;
+}
+
+inline size_t SharedMemory::size(void) const
+{
+	return this->length;
+}
+
+
+
+/*    Compteur d'étage d'un processus, seul sur sa ligne de cache.
+ */
+struct alignas(64) HaloSlot
+{
+	std::atomic<uint64_t> stage;
+	std::atomic<uint32_t> finished;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "HaloSlot : lock-free 64-bit atomics are required");
+
+
+
+/*    Réseau local d'un processus : ses nœuds (états 0 <= i < nowned), suivis
+ * des fantômes. Le nœud local i est le nœud "begin / nstates + i" de la
+ * numérotation globale, où les parties sont contiguës.
+ */
+template<typename T>
+class HaloNetwork: public Network<T>
+{
+	public: typedef typename DynamicalSystem<T>::size_type size_type;
+
+	protected:
+		T *buffers[2];
+		size_type begin;
+		size_type nowned;
+		std::vector<uint64_t> ghosts;
+		std::vector<size_type> boundary;
+		HaloSlot *slot;
+		std::vector<HaloSlot*> neighbours;
+		std::atomic<uint32_t> *abort;
+		uint64_t stage;
+
+		void wait(HaloSlot &neighbour, const uint64_t stage) const;
+
+	public:
+		HaloNetwork(void);
+		virtual ~HaloNetwork(void){};
+
+		void addghosts(const std::vector<uint64_t> &ghosts);
+		void setboundary(const std::vector<size_type> &boundary);
+		void attach(T *buffer0, T *buffer1, const size_type begin, HaloSlot &slot, const std::vector<HaloSlot*> &neighbours, std::atomic<uint32_t> &abort);
+
+		inline size_type sizeowned(void) const;
+		inline uint64_t getstage(void) const;
+
+		virtual void f(T t, SystemStates<T>& x);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+};
+
+template<typename T>
+HaloNetwork<T>::HaloNetwork(void)
+{
+	this->buffers[0] = NULL;
+	this->buffers[1] = NULL;
+	this->begin = 0;
+	this->nowned = 0;
+	this->slot = NULL;
+	this->abort = NULL;
+	this->stage = 0;
+	return;
+}
+
+template<typename T>
+void HaloNetwork<T>::addghosts(const std::vector<uint64_t> &ghosts)
+/*    "ghosts" : positions globales des états fantômes, à ajouter après ceux
+ * des nœuds (qui doivent tous avoir été ajoutés).
+ */
+{
+	this->nowned = this->sizex();
+	this->ghosts = ghosts;
+	this->resize(this->nowned + ghosts.size(), this->sizey());
+	return;
+}
+
+template<typename T>
+void HaloNetwork<T>::setboundary(const std::vector<size_type> &boundary)
+/*    "boundary" : positions locales des états lus comme fantômes par les
+ * autres processus, les seuls publiés par "f".
+ */
+{
+	this->boundary = boundary;
+	return;
+}
+
+template<typename T>
+void HaloNetwork<T>::attach(T *buffer0, T *buffer1, const size_type begin, HaloSlot &slot, const std::vector<HaloSlot*> &neighbours, std::atomic<uint32_t> &abort)
+{
+	this->buffers[0] = buffer0;
+	this->buffers[1] = buffer1;
+	this->begin = begin;
+	this->slot = &slot;
+	this->neighbours = neighbours;
+	this->abort = &abort;
+	this->stage = 0;
+	return;
+}
+
+template<typename T>
+inline typename HaloNetwork<T>::size_type HaloNetwork<T>::sizeowned(void) const
+{
+	return this->nowned;
+}
+
+template<typename T>
+inline uint64_t HaloNetwork<T>::getstage(void) const
+{
+	return this->stage;
+}
+
+template<typename T>
+void HaloNetwork<T>::wait(HaloSlot &neighbour, const uint64_t stage) const
+{
+	unsigned spins = 0;
+
+	while (neighbour.stage.load(std::memory_order_acquire) < stage)
+	{
+		if (this->abort->load(std::memory_order_relaxed) != 0)
+		{
+			throw std::runtime_error("HaloNetwork::f : aborted by another process");
+		}
+		if (neighbour.finished.load(std::memory_order_acquire) != 0)
+		{
+			if (neighbour.stage.load(std::memory_order_acquire) < stage)
+			{
+				throw std::runtime_error("HaloNetwork::f : a neighbour process stopped early (unequal number of stages)");
+			}
+			break;
+		}
+		if (++spins < 256)
+		{
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#endif
+		}
+		else
+		{
+			sched_yield();
+		}
+	}
+	return;
+}
+
+template<typename T>
+void HaloNetwork<T>::f(T t, SystemStates<T>& x)
+{
+	if (this->slot != NULL)
+	{
+		T *buffer = this->buffers[this->stage & 1];
+		T *px = x.data();
+
+		for (size_t b = 0; b < this->boundary.size(); ++b)
+		{
+			buffer[this->begin + this->boundary[b]] = px[this->boundary[b]];
+		}
+		++this->stage;
+		this->slot->stage.store(this->stage, std::memory_order_release);
+		for (size_t q = 0; q < this->neighbours.size(); ++q)
+		{
+			this->wait(*this->neighbours[q], this->stage);
+		}
+		for (size_t g = 0; g < this->ghosts.size(); ++g)
+		{
+			px[this->nowned + g] = buffer[this->ghosts[g]];
+		}
+	}
+	Network<T>::f(t, x);
+	return;
+}
+
+template<typename T>
+bool HaloNetwork<T>::fingerprint(Fingerprint &) const
+/*    L'état du réseau local dépend des autres processus : pas d'empreinte.
+ */
+{
+	return false;
+}
+
+
+
+template<typename T>
+class PartitionedNetwork
+{
+	public:
+		typedef typename LocalSystem<T>::size_type size_type;
+
+		class Context
+		{
+			public:
+				uint32_t rank;
+				uint32_t nprocesses;
+				HaloNetwork<T> &network;
+				const std::vector<uint64_t> &nodes;		// nœuds de la topologie, dans l'ordre local
+				size_type nstates;					// états par nœud
+
+				Context(const uint32_t rank, const uint32_t nprocesses, HaloNetwork<T> &network, const std::vector<uint64_t> &nodes, const size_type nstates):rank(rank), nprocesses(nprocesses), network(network), nodes(nodes), nstates(nstates){};
+		};
+
+		/*    Placement mémoire d'un processus au démarrage (node < 0 : non
+		 * mesuré).
+		 */
+		struct Placement
+		{
+			int32_t node;
+			Numa::Pages pages;
+
+			Placement(void):node(-1){};
+		};
+
+	protected:
+		typedef std::function<void(NetworkBuilder<T>&, const std::vector<uint64_t>&)> Populate;
+		typedef std::function<void(ConnectionStore<T>&, const size_type, const size_type, const T)> Link;
+
+		const Topology<T> *topology;
+		Partition<T> partition;
+		size_type nstates;
+		Populate populate;
+		Link link;
+		std::vector<T> x;
+		std::vector< std::vector<int> > cpus;
+		bool report;
+		std::vector<Placement> placement;
+
+		/*    Mémoire partagée : drapeau d'abandon, compteurs, deux tampons
+		 * d'états, état final.
+		 */
+		struct Layout
+		{
+			size_t slots, placement, buffers, result, length;
+
+			Layout(const uint32_t nprocesses, const size_t nglobal)
+			{
+				this->slots = 64;
+				this->placement = this->slots + nprocesses * sizeof(HaloSlot);
+				this->buffers = (this->placement + nprocesses * sizeof(Placement) + 63) & ~(size_t)63;
+				this->result = this->buffers + 2 * nglobal * sizeof(T);
+				this->length = this->result + nglobal * sizeof(T);
+			};
+		};
+
+		void child(const uint32_t rank, SharedMemory &memory, const std::vector<uint64_t> &position, const std::vector<uint64_t> &offsets, const std::vector< std::vector<uint32_t> > &adjacent, const std::vector<uint8_t> &frontier, const std::function<void(Context&)> &job) const;
+
+	public:
+		PartitionedNetwork(const Topology<T> &topology, const uint32_t nprocesses);
+		virtual ~PartitionedNetwork(void){};
+
+		template<typename S> void nodes(const S &prototype);
+		template<typename S, typename F> void nodes(const S &prototype, F configure);
+
+		void couple(const T gain, const size_type statesoffset = 0);
+		template<typename K, typename F> void connect(F make);
+
+		void initial(const std::vector<T> &x);
+
+		void pin(void);
+		void pin(const std::vector< std::vector<int> > &cpus);
+		void unpin(void);
+		inline void setreport(const bool report);
+
+		void run(const std::function<void(Context&)> &job);
+
+		inline Partition<T> &getpartition(void);
+		inline const std::vector<T> &getstate(void) const;
+		inline const std::vector<Placement> &getplacement(void) const;
+};
+
+template<typename T>
+PartitionedNetwork<T>::PartitionedNetwork(const Topology<T> &topology, const uint32_t nprocesses)
+{
+	this->topology = &topology;
+	this->partition.greedy(topology, nprocesses);
+	this->nstates = 0;
+	this->report = false;
+	return;
+}
+
+template<typename T>
+template<typename S>
+void PartitionedNetwork<T>::nodes(const S &prototype)
+{
+	this->nodes(prototype, [](S &, const uint64_t){});
+	return;
+}
+
+template<typename T>
+template<typename S, typename F>
+void PartitionedNetwork<T>::nodes(const S &prototype, F configure)
+{
+	S copy(prototype);
+
+	this->nstates = copy.sizex();
+	this->populate = [prototype, configure](NetworkBuilder<T> &builder, const std::vector<uint64_t> &owned)
+		{
+			builder.addnodes(owned.size(), prototype,
+				[&owned, &configure](S &node, const size_type i)
+				{
+					configure(node, owned[i]);
+				});
+		};
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::couple(const T gain, const size_type statesoffset)
+{
+	this->connect< GainLink<T> >(
+		[gain, statesoffset](const size_type frombase, const size_type tobase, const T weight)
+		{
+			return GainLink<T>(frombase + statesoffset, tobase + statesoffset, gain * weight);
+		});
+	return;
+}
+
+template<typename T>
+template<typename K, typename F>
+void PartitionedNetwork<T>::connect(F make)
+{
+	this->link = [make](ConnectionStore<T> &connections, const size_type frombase, const size_type tobase, const T weight)
+		{
+			connections.add(make(frombase, tobase, weight));
+		};
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::initial(const std::vector<T> &x)
+{
+	this->x = x;
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::pin(void)
+{
+	const uint32_t nprocesses = this->partition.getnparts();
+	const int nodes = Numa::nodes();
+
+	this->cpus.assign(nprocesses, std::vector<int>());
+	for (int node = 0; node < nodes; ++node)
+	{
+		const std::vector<int> cpus = Numa::cpus(node);
+		const uint32_t first = (uint32_t)(((uint64_t)node * nprocesses + nodes - 1) / nodes);
+		const uint32_t last = (uint32_t)(((uint64_t)(node + 1) * nprocesses + nodes - 1) / nodes);
+		const size_t count = last - first;
+
+		for (uint32_t rank = first; rank < last; ++rank)
+		{
+			if (cpus.size() < count)
+			{
+				this->cpus[rank] = cpus;
+			}
+			else
+			{
+				const size_t k = rank - first;
+
+				this->cpus[rank].assign(cpus.begin() + (k * cpus.size()) / count, cpus.begin() + ((k + 1) * cpus.size()) / count);
+			}
+		}
+	}
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::pin(const std::vector< std::vector<int> > &cpus)
+{
+	if (cpus.size() != this->partition.getnparts())
+	{
+		throw std::invalid_argument("PartitionedNetwork::pin : one cpu list per process is required");
+	}
+	this->cpus = cpus;
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::unpin(void)
+{
+	this->cpus.clear();
+	return;
+}
+
+template<typename T>
+inline void PartitionedNetwork<T>::setreport(const bool report)
+{
+	this->report = report;
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::run(const std::function<void(Context&)> &job)
+{
+	const uint64_t n = this->topology->size();
+	const uint32_t nprocesses = this->partition.getnparts();
+	const size_t nglobal = n * this->nstates;
+	std::vector<uint64_t> position(n), offsets(nprocesses + 1, 0);
+	std::vector< std::vector<uint32_t> > adjacent(nprocesses);
+	std::vector<uint8_t> frontier(n, 0);
+	const Layout layout(nprocesses, nglobal);
+	std::vector<pid_t> children;
+	bool failed = false;
+
+	if (!this->populate || !this->link)
+	{
+		throw std::logic_error("PartitionedNetwork::run : nodes and connections must be set");
+	}
+	if (this->partition.size() != n)
+	{
+		throw std::invalid_argument("PartitionedNetwork::run : partition size mismatch");
+	}
+	if (this->x.size() != nglobal)
+	{
+		throw std::invalid_argument("PartitionedNetwork::run : initial state size mismatch");
+	}
+
+	// Numérotation globale : les nœuds de chaque partie sont contigus, dans
+	// l'ordre de la topologie.
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		++offsets[this->partition[i] + 1];
+	}
+	for (uint32_t p = 0; p < nprocesses; ++p)
+	{
+		offsets[p+1] += offsets[p];
+	}
+	{
+		std::vector<uint64_t> next(offsets.begin(), offsets.end() - 1);
+
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			position[i] = next[this->partition[i]]++;
+		}
+	}
+
+	// Parties voisines, dans les deux sens : un processus qui lit les états
+	// d'un autre doit aussi le retenir (double tampon). Nœuds de frontière :
+	// sources d'une connexion vers une autre partie.
+	{
+		std::vector<uint8_t> matrix((size_t)nprocesses * nprocesses, 0);
+
+		for (uint64_t j = 0; j < n; ++j)
+		{
+			for (uint64_t e = this->topology->first(j); e < this->topology->last(j); ++e)
+			{
+				const uint32_t p = this->partition[this->topology->source(e)];
+				const uint32_t q = this->partition[j];
+
+				if (p != q)
+				{
+					frontier[this->topology->source(e)] = 1;
+					matrix[(size_t)p * nprocesses + q] = 1;
+					matrix[(size_t)q * nprocesses + p] = 1;
+				}
+			}
+		}
+		for (uint32_t p = 0; p < nprocesses; ++p)
+		{
+			for (uint32_t q = 0; q < nprocesses; ++q)
+			{
+				if (matrix[(size_t)p * nprocesses + q] != 0)
+				{
+					adjacent[p].push_back(q);
+				}
+			}
+		}
+	}
+
+	SharedMemory memory(layout.length);
+
+	new (memory.data()) std::atomic<uint32_t>(0);
+	for (uint32_t p = 0; p < nprocesses; ++p)
+	{
+		HaloSlot *slot = new ((char*)memory.data() + layout.slots + p * sizeof(HaloSlot)) HaloSlot;
+
+		slot->stage.store(0);
+		slot->finished.store(0);
+		new ((char*)memory.data() + layout.placement + p * sizeof(Placement)) Placement;
+	}
+
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(NULL);
+	for (uint32_t p = 0; p < nprocesses; ++p)
+	{
+		const pid_t pid = fork();
+
+		if (pid < 0)
+		{
+			((std::atomic<uint32_t>*)memory.data())->store(1);
+			failed = true;
+			break;
+		}
+		if (pid == 0)
+		{
+			this->child(p, memory, position, offsets, adjacent, frontier, job);
+		}
+		children.push_back(pid);
+	}
+	for (size_t k = 0; k < children.size(); ++k)
+	{
+		int status;
+
+		if ( (waitpid(-1, &status, 0) < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0) )
+		{
+			((std::atomic<uint32_t>*)memory.data())->store(1);
+			failed = true;
+		}
+	}
+	if (failed)
+	{
+		throw std::runtime_error("PartitionedNetwork::run : a process failed");
+	}
+
+	this->placement.assign((const Placement*)((char*)memory.data() + layout.placement), (const Placement*)((char*)memory.data() + layout.placement) + nprocesses);
+	{
+		const T *final = (const T*)((char*)memory.data() + layout.result);
+
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			std::copy(final + position[i] * this->nstates, final + (position[i] + 1) * this->nstates, this->x.begin() + i * this->nstates);
+		}
+	}
+	return;
+}
+
+template<typename T>
+void PartitionedNetwork<T>::child(const uint32_t rank, SharedMemory &memory, const std::vector<uint64_t> &position, const std::vector<uint64_t> &offsets, const std::vector< std::vector<uint32_t> > &adjacent, const std::vector<uint8_t> &frontier, const std::function<void(Context&)> &job) const
+/*    Corps d'un processus fils : ne revient pas.
+ */
+{
+	const uint64_t n = this->topology->size();
+	const uint32_t nprocesses = this->partition.getnparts();
+	const size_t nglobal = n * this->nstates;
+	const Layout layout(nprocesses, nglobal);
+	char *base = (char*)memory.data();
+	std::atomic<uint32_t> &abort = *(std::atomic<uint32_t>*)base;
+	HaloSlot *slot = (HaloSlot*)(base + layout.slots);
+	int status = 0;
+
+	try
+	{
+		const size_type m = this->nstates;
+		std::vector<uint64_t> owned, ghostnodes, ghoststates;
+		std::vector<size_type> boundary;
+		std::unordered_map<uint64_t, uint64_t> ghostindex;
+		std::vector<HaloSlot*> neighbours;
+		T *published[2] = {(T*)(base + layout.buffers), (T*)(base + layout.buffers) + nglobal};
+
+		// Épinglage avant toute allocation : premier accès depuis le nœud
+		// du processus.
+		if ( !this->cpus.empty() && !Numa::pin(this->cpus[rank]) )
+		{
+			throw std::runtime_error("PartitionedNetwork : cannot pin process to its cpus");
+		}
+
+		HaloNetwork<T> network;
+		NetworkBuilder<T> builder(network);
+
+		owned.reserve(offsets[rank+1] - offsets[rank]);
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			if (this->partition[i] == rank)
+			{
+				owned.push_back(i);
+			}
+		}
+		this->populate(builder, owned);
+		if (builder.size() * m != network.sizex())
+		{
+			throw std::logic_error("PartitionedNetwork : nodes must all have the prototype's number of states");
+		}
+
+		// Fantômes, par ordre de première apparition.
+		for (size_t l = 0; l < owned.size(); ++l)
+		{
+			for (uint64_t e = this->topology->first(owned[l]); e < this->topology->last(owned[l]); ++e)
+			{
+				const uint64_t i = this->topology->source(e);
+
+				if ( (this->partition[i] != rank) && ghostindex.emplace(i, owned.size() + ghostnodes.size()).second )
+				{
+					ghostnodes.push_back(i);
+				}
+			}
+		}
+		ghoststates.reserve(ghostnodes.size() * m);
+		for (size_t g = 0; g < ghostnodes.size(); ++g)
+		{
+			for (size_type s = 0; s < m; ++s)
+			{
+				ghoststates.push_back(position[ghostnodes[g]] * m + s);
+			}
+		}
+		network.addghosts(ghoststates);
+
+		// États publiés à chaque étage : ceux des nœuds de frontière.
+		for (size_t l = 0; l < owned.size(); ++l)
+		{
+			if (frontier[owned[l]] != 0)
+			{
+				for (size_type s = 0; s < m; ++s)
+				{
+					boundary.push_back(l * m + s);
+				}
+			}
+		}
+		network.setboundary(boundary);
+
+		for (size_t l = 0; l < owned.size(); ++l)
+		{
+			for (uint64_t e = this->topology->first(owned[l]); e < this->topology->last(owned[l]); ++e)
+			{
+				const uint64_t i = this->topology->source(e);
+				const uint64_t from = (this->partition[i] == rank) ? position[i] - offsets[rank] : ghostindex[i];
+
+				this->link(network.getconnections(), from * m, l * m, this->topology->weight(e));
+			}
+		}
+
+		for (size_t l = 0; l < owned.size(); ++l)
+		{
+			std::copy(this->x.begin() + owned[l] * m, this->x.begin() + (owned[l] + 1) * m, network.data() + l * m);
+		}
+		for (size_t g = 0; g < ghostnodes.size(); ++g)
+		{
+			std::copy(this->x.begin() + ghostnodes[g] * m, this->x.begin() + (ghostnodes[g] + 1) * m, network.data() + (owned.size() + g) * m);
+		}
+
+		for (size_t q = 0; q < adjacent[rank].size(); ++q)
+		{
+			neighbours.push_back(slot + adjacent[rank][q]);
+		}
+		for (int k = 0; k < 2; ++k)
+		{
+			std::copy(network.data(), network.data() + network.sizeowned(), published[k] + offsets[rank] * m);
+		}
+		network.attach(published[0], published[1], offsets[rank] * m, slot[rank], neighbours, abort);
+
+		{
+			Placement &placement = *(Placement*)(base + layout.placement + rank * sizeof(Placement));
+			const int node = Numa::node();
+			bool measured = true;
+
+			measured = measured && Numa::pages(network.data(), network.sizex() * sizeof(T), node, placement.pages);
+			measured = measured && Numa::pages(&network.dx(0), network.sizedx() * sizeof(T), node, placement.pages);
+			for (int k = 0; k < 2; ++k)
+			{
+				measured = measured && Numa::pages(published[k] + offsets[rank] * m, network.sizeowned() * sizeof(T), node, placement.pages);
+			}
+			placement.node = measured ? node : -1;
+			if (this->report)
+			{
+				std::ostringstream line;
+
+				line << "PartitionedNetwork : process " << rank << " : node " << node;
+				if (measured)
+				{
+					line << ", pages local " << placement.pages.local << " remote " << placement.pages.remote << " absent " << placement.pages.absent;
+				}
+				else
+				{
+					line << ", page placement unavailable";
+				}
+				std::cerr << line.str() << std::endl;
+			}
+		}
+
+		Context context(rank, nprocesses, network, owned, m);
+		job(context);
+
+		std::copy(network.data(), network.data() + network.sizeowned(), (T*)(base + layout.result) + offsets[rank] * m);
+	}
+	catch (std::exception &e)
+	{
+		std::cerr << "PartitionedNetwork : process " << rank << " : " << e.what() << std::endl;
+		abort.store(1);
+		status = 1;
+	}
+	catch (...)
+	{
+		abort.store(1);
+		status = 1;
+	}
+	slot[rank].finished.store(1, std::memory_order_release);
+	std::cout.flush();
+	std::cerr.flush();
+	fflush(NULL);
+	_exit(status);
+}
+
+template<typename T>
+inline Partition<T> &PartitionedNetwork<T>::getpartition(void)
+{
+	return this->partition;
+}
+
+template<typename T>
+inline const std::vector<T> &PartitionedNetwork<T>::getstate(void) const
+{
+	return this->x;
+}
+
+template<typename T>
+inline const std::vector<typename PartitionedNetwork<T>::Placement> &PartitionedNetwork<T>::getplacement(void) const
+{
+	return this->placement;
+}
+
+#endif
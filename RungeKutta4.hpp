@@ -54,6 +54,8 @@ class RungeKutta4: public FixedStepIntegrator<T>
 		RungeKutta4(FixedStepIntegrator<T> &other):FixedStepIntegrator<T>(other){};
 
 		void operator()(T &t, DynamicalSystem<T> &system);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -93,16 +95,28 @@ void RungeKutta4<T>::operator()(T &t, DynamicalSystem<T> &system)
 
 	system.f(t + this->step, tmp);
 
+	this->prepare(system);
+
 	for (i = 0; i < system.size(); ++i)
 	{
-		system[i] = system[i] + ( this->step / ((T)6.0) ) * ( k1[i] + ((T)2.0) * k2[i] + ((T)2.0) * k3[i] + system.dx(i) );
+		this->increment(system, i, ( this->step / ((T)6.0) ) * ( k1[i] + ((T)2.0) * k2[i] + ((T)2.0) * k3[i] + system.dx(i) ));
 	}
 
-	t = t + this->step;
+	this->advance(t);
 
 	return;
 }
 
 
+template<typename T>
+bool RungeKutta4<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(RungeKutta4<T>))
+	{
+		return false;
+	}
+	return this->fingerprintstate(fingerprint);
+}
+
 #endif
 
@@ -37,6 +37,50 @@
  * l'intégrateur son des objets externes qui dérivent respectivement de
  * DynamicalSystem et Integrator.
  *
+ *		Les échantillons sont envoyés à une sortie (OutputSink : TextSink,
+ * BinarySink, ...). Les versions de "run" prenant un std::ostream utilisent une
+ * sortie texte (TextSink).
+ *
+ *		"snapshot" et "restore" sauvegardent et restaurent l'état complet de la
+ * simulation (temps, compteur d'écriture, états du système, état interne de
+ * l'intégrateur) pour reprendre une simulation interrompue (voir
+ * Checkpoint.hpp et Checkpointer.hpp).
+ *
+ *		"step" avance la simulation d'un seul pas, sans rien écrire : c'est la
+ * base de l'itération à la demande (voir Trajectory.hpp).
+ *
+ *		Le transitoire (non enregistré) peut être calculé avec un intégrateur
+ * moins coûteux ("settransiantintegrator") ou avec un pas plus grand pour un
+ * intégrateur à pas fixe ("settransiantstep"). L'intégrateur principal est
+ * ensuite utilisé pendant "sethandover" unités de temps avant
+ * l'enregistrement, pour que la trajectoire reconverge à sa précision. Pour un
+ * transitoire dont la fin est connue en temps (ti, voir
+ * SimulationPredicate::deadline), cette fenêtre est prise sur la fin du
+ * transitoire (de ti - handover à ti) : l'enregistrement commence à ti comme
+ * sans intégrateur rapide. Sinon (transitoire en nombre de pas), elle
+ * s'ajoute après le transitoire et décale d'autant le début de
+ * l'enregistrement.
+ *
+ *		Avec "settransiantcache", l'état obtenu après le transitoire est
+ * conservé sur disque (voir TransientCache.hpp). Une simulation identique
+ * (mêmes paramètres, topologie, état et temps initiaux, intégrateurs et durée
+ * de transitoire) reprend directement de cet état au lieu de recalculer le
+ * transitoire. Le compteur d'écriture ("writingstep") n'est pas concerné.
+ *
+ *		Les opérations pré et post-intégration de "run" ne sont pas appelées
+ * pendant le transitoire. "settransiantop" donne une opération appelée après
+ * chaque pas du transitoire (typiquement un Checkpointer, pour des points de
+ * reprise pendant un long transitoire). Pendant la phase à grand pas
+ * ("settransiantstep"), l'intégrateur principal retrouve son pas habituel le
+ * temps de cet appel.
+ *
+ *		Une condition d'arrêt ("run" avec "condition") ne porte normalement
+ * que sur l'enregistrement. Avec "throughtransiant", elle est aussi testée
+ * pendant le transitoire : la simulation s'arrête dès qu'elle est fausse, et
+ * rien n'est enregistré si c'est avant la fin du transitoire. Ce transitoire
+ * ne passe pas par le cache (une condition a un état propre, que le cache ne
+ * restaurerait pas).
+ *
  */
 
 /* TODO
@@ -46,12 +90,16 @@
 
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include "Checkpoint.hpp"
 #include "DynamicalSystem.hpp"
 #include "Integrators.hpp"
+#include "OutputSink.hpp"
 #include "PrePostOp.hpp"
 #include "SimulationPredicate.hpp"
+#include "TransientCache.hpp"
 
 template<typename T>
 class Simulation
@@ -59,11 +107,21 @@ class Simulation
 	protected:
 		DynamicalSystem<T> *dynamicalsystem;
 		Integrator<T> *integrator;
+		Integrator<T> *transiantintegrator;
+		TransientCache<T> *cache;
+		PrePostOp<T> *transiantop;
 
 		T time;
+		T transiantstep, handover;
 
 		long WSmax, WScount;	// writingstep
 
+		inline T samplingstep(void);
+
+		void integratetransiant(SimulationPredicate<T> &transiant);
+		inline void calltransiantop(FixedStepIntegrator<T> *resized, const T step);
+		void record(OutputSink<T> &sink, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop);
+		bool transiantkey(SimulationPredicate<T> &transiant, Fingerprint &key) const;
 
 	public:
 		Simulation(void);
@@ -76,7 +134,7 @@ class Simulation
 		inline void writingstep(void);
 
 		inline T getTime(void);
-		inline T setTime(T time);
+		inline void setTime(T time);
 
 		inline DynamicalSystem<T> &getdynamicalsystem();
 		inline Integrator<T> &getintegrator();
@@ -85,6 +143,23 @@ class Simulation
 		inline void unsetdynamicalsystem(void);
 		inline void unsetintegrator(void);
 
+		inline void settransiantintegrator(Integrator<T> &integrator);
+		inline void unsettransiantintegrator(void);
+		inline void settransiantstep(T step);
+		inline void sethandover(T duration);
+		inline void settransiantcache(TransientCache<T> &cache);
+		inline void unsettransiantcache(void);
+		inline void settransiantop(PrePostOp<T> &op);
+		inline void unsettransiantop(void);
+
+		void runtransiant(SimulationPredicate<T> &transiant);
+
+		inline void step(void);
+		inline void step(PrePostOp<T> &preop, PrePostOp<T> &postop);
+
+		void snapshot(Checkpoint<T> &checkpoint) const;
+		void restore(const Checkpoint<T> &checkpoint);
+
 		void run(std::ostream &ostream, T ti, T tf, PrePostOp<T> &preop, PrePostOp<T> &postop);
 		void run(std::ostream &ostream, T ti, T tf);
 	
@@ -93,6 +168,16 @@ class Simulation
 		
 		void run(std::ostream &ostream, SimulationPredicate<T> &transiant, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop);
 
+		void run(OutputSink<T> &sink, T ti, T tf, PrePostOp<T> &preop, PrePostOp<T> &postop);
+		void run(OutputSink<T> &sink, T ti, T tf);
+		void run(OutputSink<T> &sink, T ti, T tf, SimulationPredicate<T> &condition, PrePostOp<T> &preop, PrePostOp<T> &postop, bool throughtransiant = false);
+		void run(OutputSink<T> &sink, T ti, T tf, SimulationPredicate<T> &condition, bool throughtransiant = false);
+
+		void run(OutputSink<T> &sink, unsigned long nbpoints, unsigned long nbskipedpoints, PrePostOp<T> &preop, PrePostOp<T> &postop);
+		void run(OutputSink<T> &sink, unsigned long nbpoints, unsigned long nbskipedpoints = 0);
+
+		void run(OutputSink<T> &sink, SimulationPredicate<T> &transiant, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop);
+
 };
 
 template<typename T>
@@ -102,6 +187,11 @@ Simulation<T>::Simulation(void)
 	this->unsetintegrator();
 	this->writingstep((long)0);
 	this->time = (T)0.0;
+	this->unsettransiantintegrator();
+	this->settransiantstep((T)0.0);
+	this->sethandover((T)0.0);
+	this->unsettransiantcache();
+	this->unsettransiantop();
 	return;
 }
 
@@ -112,6 +202,11 @@ Simulation<T>::Simulation(DynamicalSystem<T> &dynamicalsystem)
 	this->unsetintegrator();
 	this->writingstep((long)0);
 	this->time = (T)0.0;
+	this->unsettransiantintegrator();
+	this->settransiantstep((T)0.0);
+	this->sethandover((T)0.0);
+	this->unsettransiantcache();
+	this->unsettransiantop();
 	return;
 }
 
@@ -122,6 +217,11 @@ Simulation<T>::Simulation(Integrator<T> &integrator)
 	this->setintegrator(integrator);
 	this->writingstep((long)0);
 	this->time = (T)0.0;
+	this->unsettransiantintegrator();
+	this->settransiantstep((T)0.0);
+	this->sethandover((T)0.0);
+	this->unsettransiantcache();
+	this->unsettransiantop();
 	return;
 }
 
@@ -132,6 +232,11 @@ Simulation<T>::Simulation(DynamicalSystem<T> &dynamicalsystem, Integrator<T> &in
 	this->setintegrator(integrator);
 	this->writingstep((long)0);
 	this->time = (T)0.0;
+	this->unsettransiantintegrator();
+	this->settransiantstep((T)0.0);
+	this->sethandover((T)0.0);
+	this->unsettransiantcache();
+	this->unsettransiantop();
 	return;
 }
 
@@ -159,23 +264,39 @@ inline T Simulation<T>::getTime(void)
 }
 
 template<typename T>
-inline T Simulation<T>::setTime(T time)
+inline void Simulation<T>::setTime(T time)
 {
 	this->time = time;
 	return;
 }
 
 
+template<typename T>
+inline T Simulation<T>::samplingstep(void)
+/*    Pas de temps entre deux échantillons écrits, ou 0 si l'intégrateur n'est
+ * pas à pas fixe.
+ */
+{
+	FixedStepIntegrator<T> *fixedstep = dynamic_cast< FixedStepIntegrator<T>* >(this->integrator);
+
+	if (fixedstep == NULL)
+	{
+		return (T)0.0;
+	}
+	return fixedstep->getstep() * (T)( (this->WSmax > 1) ? this->WSmax : 1 );
+}
+
+
 template<typename T>
 inline DynamicalSystem<T> &Simulation<T>::getdynamicalsystem()
 {
-	return this->*dynamicalsystem;
+	return *this->dynamicalsystem;
 }
 
 template<typename T>
 inline Integrator<T> &Simulation<T>::getintegrator()
 {
-	return this->*integrator;
+	return *this->integrator;
 }
 
 template<typename T>
@@ -210,6 +331,326 @@ inline void Simulation<T>::unsetintegrator(void)
 
 
 
+template<typename T>
+inline void Simulation<T>::settransiantintegrator(Integrator<T> &integrator)
+{
+	this->transiantintegrator = &integrator;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::unsettransiantintegrator(void)
+{
+	this->transiantintegrator = NULL;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::settransiantstep(T step)
+/*    Pas de l'intégrateur principal (s'il est à pas fixe) pendant le
+ * transitoire. 0 : le pas habituel. Ignoré si un intégrateur de transitoire
+ * est défini.
+ */
+{
+	this->transiantstep = step;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::sethandover(T duration)
+{
+	this->handover = duration;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::settransiantcache(TransientCache<T> &cache)
+{
+	this->cache = &cache;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::unsettransiantcache(void)
+{
+	this->cache = NULL;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::settransiantop(PrePostOp<T> &op)
+{
+	this->transiantop = &op;
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::unsettransiantop(void)
+{
+	this->transiantop = NULL;
+	return;
+}
+
+template<typename T>
+bool Simulation<T>::transiantkey(SimulationPredicate<T> &transiant, Fingerprint &key) const
+/*    Empreinte de tout ce qui détermine l'état à la fin du transitoire.
+ * Renvoie false si une partie de la configuration n'a pas d'empreinte.
+ */
+{
+	const T *x = this->dynamicalsystem->data();
+
+	key.add("Simulation::transiant");
+	key.add((uint32_t)BinaryType<T>::code);
+	key.add((uint32_t)sizeof(T));
+	if ( !this->dynamicalsystem->fingerprint(key) || !this->integrator->fingerprint(key) )
+	{
+		return false;
+	}
+	if (this->transiantintegrator != NULL)
+	{
+		if (!this->transiantintegrator->fingerprint(key))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		key.add((uint32_t)0);
+	}
+	key.add(this->transiantstep);
+	key.add(this->handover);
+	key.add(this->time);
+	key.add(std::vector<T>(x, x + this->dynamicalsystem->size()));
+	return transiant.fingerprint(key);
+}
+
+template<typename T>
+void Simulation<T>::runtransiant(SimulationPredicate<T> &transiant)
+/*    Transitoire : état du cache s'il existe, sinon calcul puis mise en cache
+ * (si le transitoire n'est pas vide).
+ */
+{
+	Fingerprint key;
+	Checkpoint<T> checkpoint;
+	const T start = this->time;
+	const long wsmax = this->WSmax, wscount = this->WScount;
+
+	if ( (this->cache == NULL) || !this->transiantkey(transiant, key) )
+	{
+		this->integratetransiant(transiant);
+		return;
+	}
+
+	if (this->cache->load(key.value(), checkpoint))
+	{
+		this->restore(checkpoint);
+		this->WSmax = wsmax;
+		this->WScount = wscount;
+		return;
+	}
+
+	this->integratetransiant(transiant);
+	if (this->time != start)
+	{
+		this->snapshot(checkpoint);
+		try
+		{
+			this->cache->store(key.value(), checkpoint);
+		}
+		catch (std::runtime_error &error)
+		{
+			// Cache plein ou non accessible en écriture : le transitoire
+			// reste compté comme un défaut, la simulation continue.
+		}
+	}
+	return;
+}
+
+template<typename T>
+void Simulation<T>::integratetransiant(SimulationPredicate<T> &transiant)
+/*    Intégration tant que "transiant" est vrai, sans écriture. Avec un
+ * intégrateur rapide, la fenêtre de transition avec l'intégrateur principal
+ * termine le transitoire s'il a une fin en temps ("deadline"), et le suit
+ * sinon (s'il a duré au moins un pas).
+ */
+{
+	FixedStepIntegrator<T> *fixedstep = dynamic_cast< FixedStepIntegrator<T>* >(this->integrator);
+	Integrator<T> *coarse = this->transiantintegrator;
+	bool resized = false, stepped = false;
+	T step = (T)0;
+	T end;
+	const bool timed = transiant.deadline(end);
+
+	if ( (coarse == NULL) && (this->transiantstep > (T)0) && (fixedstep != NULL) )
+	{
+		step = fixedstep->getstep();
+		fixedstep->setstep(this->transiantstep);
+		coarse = this->integrator;
+		resized = true;
+	}
+
+	if (coarse == NULL)
+	{
+		while(transiant.test() == true)
+		{
+			(*this->integrator)(this->time, *this->dynamicalsystem);
+			this->calltransiantop(NULL, (T)0);
+		}
+		return;
+	}
+
+	try
+	{
+		while ( (!timed || (this->time < end - this->handover)) && (transiant.test() == true) )
+		{
+			(*coarse)(this->time, *this->dynamicalsystem);
+			stepped = true;
+			this->calltransiantop(resized ? fixedstep : NULL, step);
+		}
+	}
+	catch (...)
+	{
+		if (resized)
+		{
+			fixedstep->setstep(step);
+		}
+		throw;
+	}
+	if (resized)
+	{
+		fixedstep->setstep(step);
+	}
+	if ( (fixedstep != NULL) && stepped )
+	{
+		fixedstep->resetcompensation();
+	}
+
+	// Fenêtre de transition avec l'intégrateur principal.
+	if (timed)
+	{
+		while(transiant.test() == true)
+		{
+			(*this->integrator)(this->time, *this->dynamicalsystem);
+			this->calltransiantop(NULL, (T)0);
+		}
+		return;
+	}
+	if (!stepped)
+	{
+		return;
+	}
+	end = this->time + this->handover;
+	while (this->time < end)
+	{
+		(*this->integrator)(this->time, *this->dynamicalsystem);
+		this->calltransiantop(NULL, (T)0);
+	}
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::calltransiantop(FixedStepIntegrator<T> *resized, const T step)
+/*    Opération du transitoire après un pas. "resized" : intégrateur principal
+ * dont le pas a été remplacé par celui du transitoire, "step" étant son pas
+ * habituel, rétabli pendant l'appel (un point de reprise l'enregistre ainsi).
+ */
+{
+	T coarse;
+
+	if (this->transiantop == NULL)
+	{
+		return;
+	}
+	if (resized == NULL)
+	{
+		(*this->transiantop)(*this->integrator, *this->dynamicalsystem);
+		return;
+	}
+	coarse = resized->getstep();
+	resized->setstep(step);
+	try
+	{
+		(*this->transiantop)(*this->integrator, *this->dynamicalsystem);
+	}
+	catch (...)
+	{
+		resized->setstep(coarse);
+		throw;
+	}
+	resized->setstep(coarse);
+	return;
+}
+
+
+
+template<typename T>
+inline void Simulation<T>::step(void)
+{
+	(*this->integrator)(this->time, *this->dynamicalsystem);
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::step(PrePostOp<T> &preop, PrePostOp<T> &postop)
+{
+	preop(*this->integrator, *this->dynamicalsystem);
+	(*this->integrator)(this->time, *this->dynamicalsystem);
+	postop(*this->integrator, *this->dynamicalsystem);
+	return;
+}
+
+
+
+template<typename T>
+void Simulation<T>::snapshot(Checkpoint<T> &checkpoint) const
+{
+	const T *x = this->dynamicalsystem->data();
+
+	checkpoint.time = this->time;
+	checkpoint.WSmax = this->WSmax;
+	checkpoint.WScount = this->WScount;
+	checkpoint.x.assign(x, x + this->dynamicalsystem->size());
+	checkpoint.y.resize(this->dynamicalsystem->sizey());
+	for (size_t i = 0; i < checkpoint.y.size(); ++i)
+	{
+		checkpoint.y[i] = this->dynamicalsystem->y(i);
+	}
+	checkpoint.integrator.clear();
+	this->integrator->save(checkpoint.integrator);
+	return;
+}
+
+template<typename T>
+void Simulation<T>::restore(const Checkpoint<T> &checkpoint)
+/*    Le système et l'intégrateur doivent être ceux de la simulation
+ * sauvegardée (mêmes dimensions).
+ */
+{
+	if ( ((long)checkpoint.x.size() != this->dynamicalsystem->size()) ||
+		 (checkpoint.y.size() != this->dynamicalsystem->sizey()) )
+	{
+		throw std::invalid_argument("Simulation::restore : dimensions mismatch");
+	}
+
+	this->integrator->load(checkpoint.integrator.data(), checkpoint.integrator.size());
+	this->time = checkpoint.time;
+	this->WSmax = checkpoint.WSmax;
+	this->WScount = checkpoint.WScount;
+	for (size_t i = 0; i < checkpoint.x.size(); ++i)
+	{
+		(*this->dynamicalsystem)[i] = checkpoint.x[i];
+	}
+	for (size_t i = 0; i < checkpoint.y.size(); ++i)
+	{
+		this->dynamicalsystem->y(i) = checkpoint.y[i];
+	}
+	return;
+}
+
+
+
+
+
 template<typename T>
 void inline Simulation<T>::run(std::ostream &ostream, T ti, T tf, PrePostOp<T> &preop, PrePostOp<T> &postop)
 {
@@ -271,31 +712,148 @@ inline void Simulation<T>::run(std::ostream &ostream, unsigned long nbpoints, un
 template<typename T>
 void Simulation<T>::run(std::ostream &ostream, SimulationPredicate<T> &transiant, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop)
 {
-	
-	// TODO raise an error if some élement are not defined (integrator and dynamicalsystem)
-		
-	std::ostringstream oss;
-	std::string aff;
+	TextSink<T> sink(ostream);
+
+	this->run(sink, transiant, nontransiant, preop, postop);
+
+	return;
+}
+
+
+
+
 
-	oss.setf(std::ios::fixed, std::ios::floatfield);
-	oss.setf(std::ios::left, std::ios::adjustfield);
+template<typename T>
+void inline Simulation<T>::run(OutputSink<T> &sink, T ti, T tf, PrePostOp<T> &preop, PrePostOp<T> &postop)
+{
+	TimePredicate<T> *transiant = new TimePredicate<T>(this->time, ti);
+	TimePredicate<T> *nontransiant = new TimePredicate<T>(this->time, tf);
+
+	this->run(sink, *transiant, *nontransiant, preop, postop);
+
+	delete transiant;
+	delete nontransiant;
+
+	return;
+}
+
+template<typename T>
+void inline Simulation<T>::run(OutputSink<T> &sink, T ti, T tf)
+{
+	NoOp<T> *noop = new NoOp<T>();
+
+	this->run(sink, ti, tf, *noop, *noop);
+
+	delete noop;
 
-	while(transiant.test() == true)
+	return;
+}
+
+template<typename T>
+void Simulation<T>::run(OutputSink<T> &sink, T ti, T tf, SimulationPredicate<T> &condition, PrePostOp<T> &preop, PrePostOp<T> &postop, bool throughtransiant)
+/*    Après le transitoire, la simulation continue tant que t < tf et que
+ * "condition" est vraie (voir FixedPointPredicate, FinitePredicate, etc.).
+ * Avec "throughtransiant", "condition" est aussi testée pendant le
+ * transitoire, sans cache.
+ */
+{
+	TimePredicate<T> *transiant = new TimePredicate<T>(this->time, ti);
+	TimePredicate<T> *duration = new TimePredicate<T>(this->time, tf);
+	AndPredicate<T> *nontransiant = new AndPredicate<T>(*duration, condition);
+	AndPredicate<T> *before;
+
+	if (!throughtransiant)
 	{
-		(*this->integrator)(this->time, *this->dynamicalsystem);
+		this->run(sink, *transiant, *nontransiant, preop, postop);
 	}
+	else
+	{
+		before = new AndPredicate<T>(*transiant, condition);
+
+		sink.open(this->dynamicalsystem->size(), this->samplingstep());
+		this->integratetransiant(*before);
+		if (!transiant->test())
+		{
+			this->record(sink, *nontransiant, preop, postop);
+		}
+		sink.close();
+
+		delete before;
+	}
+
+	delete transiant;
+	delete nontransiant;
+	delete duration;
+
+	return;
+}
+
+template<typename T>
+void Simulation<T>::run(OutputSink<T> &sink, T ti, T tf, SimulationPredicate<T> &condition, bool throughtransiant)
+{
+	NoOp<T> *noop = new NoOp<T>();
+
+	this->run(sink, ti, tf, condition, *noop, *noop, throughtransiant);
+
+	delete noop;
+
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::run(OutputSink<T> &sink, unsigned long nbpoints, unsigned long nbskipedpoints, PrePostOp<T> &preop, PrePostOp<T> &postop)
+{
+	IterativePredicate<T> *transiant = new IterativePredicate<T>(nbskipedpoints);
+	IterativePredicate<T> *nontransiant = new IterativePredicate<T>(nbpoints);
 
+	this->run(sink, *transiant, *nontransiant, preop, postop);
+
+	delete transiant;
+	delete nontransiant;
+
+	return;
+}
+
+template<typename T>
+inline void Simulation<T>::run(OutputSink<T> &sink, unsigned long nbpoints, unsigned long nbskipedpoints)
+{
+	NoOp<T> *noop = new NoOp<T>();
+
+	this->run(sink, nbpoints, nbskipedpoints, *noop, *noop);
+
+	delete noop;
+
+	return;
+}
+
+
+template<typename T>
+void Simulation<T>::run(OutputSink<T> &sink, SimulationPredicate<T> &transiant, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop)
+{
+	
+	// TODO raise an error if some élement are not defined (integrator and dynamicalsystem)
+
+	sink.open(this->dynamicalsystem->size(), this->samplingstep());
+
+	this->runtransiant(transiant);
+	this->record(sink, nontransiant, preop, postop);
+
+	sink.close();
+
+	return;
+
+}
+
+template<typename T>
+void Simulation<T>::record(OutputSink<T> &sink, SimulationPredicate<T> &nontransiant, PrePostOp<T> &preop, PrePostOp<T> &postop)
+/*    Enregistrement tant que "nontransiant" est vrai (la sortie est ouverte).
+ */
+{
 	while(nontransiant.test() == true)
 	{
 		if (this->WScount <= 0)
 		{
-			oss.precision(3);
-			oss.width(6);
-			oss << this->time;
-			aff = oss.str();
-			oss.str("");
-			this->dynamicalsystem->toString(aff);
-			ostream << aff << std::endl;
+			sink.write(this->time, *this->dynamicalsystem);
 		}
 		this->WScount++;
 		if (this->WScount >= this->WSmax)
@@ -307,9 +865,7 @@ void Simulation<T>::run(std::ostream &ostream, SimulationPredicate<T> &transiant
 		(*this->integrator)(this->time, *this->dynamicalsystem);
 		postop(*this->integrator, *this->dynamicalsystem);		// Processing Post-integration
 	}
-
 	return;
-
 }
 
 
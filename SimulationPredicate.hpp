@@ -31,8 +31,44 @@
  * The fact that you are presently reading this means that you have had
  * knowledge of the CeCILL-C license and that you accept its terms.
  *
+ *
+ *
+ *		Un prédicat de simulation décide si la boucle de Simulation::run
+ * continue ("test" renvoie true) ou s'arrête. En plus des durées en nombre de
+ * pas (IterativePredicate) et en temps (TimePredicate), des prédicats
+ * permettent d'arrêter une simulation devenue inutile :
+ *		- FixedPointPredicate : l'état ne varie plus (point fixe atteint) ;
+ *		- PeriodicPredicate : la trajectoire est périodique (retour au même
+ *		  point d'une section de Poincaré) ;
+ *		- FinitePredicate : un état est devenu infini, NaN, ou trop grand ;
+ *		- WallClockPredicate : budget de temps réel écoulé.
+ *		Ils se combinent avec AndPredicate et OrPredicate, par exemple "tant que
+ * t < tf ET pas de point fixe ET valeurs finies". Les tests coûteux ne sont
+ * faits que tous les "checkevery" appels, sur des normes vectorisées
+ * (VectorNorm.hpp). "reason" indique après coup pourquoi un prédicat a arrêté
+ * la simulation.
+ *		"fingerprint" ajoute la durée décrite par un prédicat à une empreinte,
+ * pour identifier un transitoire (voir TransientCache.hpp). Seuls les
+ * prédicats de durée (et leurs combinaisons) la définissent.
+ *		"deadline" donne le temps auquel un prédicat s'arrêtera au plus tard,
+ * s'il est connu d'avance (TimePredicate, et AndPredicate qui en contient un) :
+ * Simulation s'en sert pour finir un transitoire avec l'intégrateur principal
+ * (voir Simulation::sethandover).
+ *
  */
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <typeinfo>
+#include <vector>
+
+#include "Fingerprint.hpp"
+#include "SystemStates.hpp"
+#include "VectorNorm.hpp"
+
 
 template<typename T>
 class SimulationPredicate
@@ -47,6 +83,9 @@ class SimulationPredicate
 		}
 
 		virtual bool test(void) = 0;
+
+		virtual bool fingerprint(Fingerprint &) const {return false;};
+		virtual bool deadline(T &) const {return false;};
 };
 
 
@@ -64,6 +103,8 @@ class IterativePredicate: public SimulationPredicate<T>
 		virtual ~IterativePredicate(void){};
 
 		virtual bool test(void);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -80,6 +121,20 @@ inline bool IterativePredicate<T>::test(void)
 	return (this->i < this->nbpoints);
 }
 
+template<typename T>
+bool IterativePredicate<T>::fingerprint(Fingerprint &fingerprint) const
+/*    Nombre de pas restants.
+ */
+{
+	if (typeid(*this) != typeid(IterativePredicate<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)(this->nbpoints - this->i));
+	return true;
+}
+
 
 
 template<typename T>
@@ -95,7 +150,9 @@ class TimePredicate: public SimulationPredicate<T>
 		virtual ~TimePredicate(void){};
 
 		virtual bool test(void);
-		
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+		virtual bool deadline(T &t) const;
 };
 
 template<typename T>
@@ -111,10 +168,525 @@ inline bool TimePredicate<T>::test(void)
 	return (*this->t < this->duration);
 }
 
+template<typename T>
+bool TimePredicate<T>::fingerprint(Fingerprint &fingerprint) const
+/*    Temps de fin.
+ */
+{
+	if (typeid(*this) != typeid(TimePredicate<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add(this->duration);
+	return true;
+}
 
+template<typename T>
+bool TimePredicate<T>::deadline(T &t) const
+{
+	if (typeid(*this) != typeid(TimePredicate<T>))
+	{
+		return false;
+	}
+	t = this->duration;
+	return true;
+}
 
 
 
+/*	AndPredicate, OrPredicate
+ *
+ *		Les deux prédicats sont toujours évalués (pas d'évaluation paresseuse) :
+ * les prédicats à état (compteurs, fenêtres) restent ainsi cohérents.
+ */
+template<typename T>
+class AndPredicate: public SimulationPredicate<T>
+{
+	protected:
+		SimulationPredicate<T> *a, *b;
 
-#endif
+	public:
+		AndPredicate(SimulationPredicate<T> &a, SimulationPredicate<T> &b):a(&a), b(&b){};
+		virtual ~AndPredicate(void){};
+
+		virtual bool test(void);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+		virtual bool deadline(T &t) const;
+};
+
+template<typename T>
+inline bool AndPredicate<T>::test(void)
+{
+	const bool a = this->a->test();
+	const bool b = this->b->test();
+	return a && b;
+}
+
+template<typename T>
+bool AndPredicate<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(AndPredicate<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	return this->a->fingerprint(fingerprint) && this->b->fingerprint(fingerprint);
+}
+
+template<typename T>
+bool AndPredicate<T>::deadline(T &t) const
+/*    La plus proche des fins connues de "a" et "b".
+ */
+{
+	T ta, tb;
+	bool a, b;
+
+	if (typeid(*this) != typeid(AndPredicate<T>))
+	{
+		return false;
+	}
+	a = this->a->deadline(ta);
+	b = this->b->deadline(tb);
+	if (a && b)
+	{
+		t = std::min(ta, tb);
+	}
+	else if (a)
+	{
+		t = ta;
+	}
+	else if (b)
+	{
+		t = tb;
+	}
+	return a || b;
+}
+
+template<typename T>
+class OrPredicate: public SimulationPredicate<T>
+{
+	protected:
+		SimulationPredicate<T> *a, *b;
+
+	public:
+		OrPredicate(SimulationPredicate<T> &a, SimulationPredicate<T> &b):a(&a), b(&b){};
+		virtual ~OrPredicate(void){};
 
+		virtual bool test(void);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+};
+
+template<typename T>
+inline bool OrPredicate<T>::test(void)
+{
+	const bool a = this->a->test();
+	const bool b = this->b->test();
+	return a || b;
+}
+
+template<typename T>
+bool OrPredicate<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(OrPredicate<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	return this->a->fingerprint(fingerprint) && this->b->fingerprint(fingerprint);
+}
+
+
+
+/*	FixedPointPredicate
+ *
+ *		Continue tant que l'état n'a pas convergé : la simulation s'arrête quand
+ * la variation de l'état entre deux tests (norme infinie) reste inférieure à
+ * "tolerance" pendant "window" tests consécutifs. Pour un système continu,
+ * la variation entre deux tests vaut environ checkevery * pas * |dx|.
+ */
+template<typename T>
+class FixedPointPredicate: public SimulationPredicate<T>
+{
+	protected:
+		const SystemStates<T> *states;
+		T tolerance;
+		unsigned long window, checkevery;
+
+		std::vector<T> last;
+		unsigned long count, calm;
+		bool converged;
+
+	public:
+		FixedPointPredicate(const SystemStates<T> &states, const T tolerance, const unsigned long window = 10, const unsigned long checkevery = 1);
+		virtual ~FixedPointPredicate(void){};
+
+		inline bool reason(void) const;
+		inline void reset(void);
+
+		virtual bool test(void);
+};
+
+template<typename T>
+FixedPointPredicate<T>::FixedPointPredicate(const SystemStates<T> &states, const T tolerance, const unsigned long window, const unsigned long checkevery)
+{
+	this->states = &states;
+	this->tolerance = tolerance;
+	this->window = (window > 0) ? window : 1;
+	this->checkevery = (checkevery > 0) ? checkevery : 1;
+	this->reset();
+	return;
+}
+
+template<typename T>
+inline bool FixedPointPredicate<T>::reason(void) const
+{
+	return this->converged;
+}
+
+template<typename T>
+inline void FixedPointPredicate<T>::reset(void)
+{
+	this->last.clear();
+	this->count = 0;
+	this->calm = 0;
+	this->converged = false;
+	return;
+}
+
+template<typename T>
+bool FixedPointPredicate<T>::test(void)
+{
+	const T *x = this->states->data();
+	const size_t n = this->states->size();
+
+	if (this->converged)
+	{
+		return false;
+	}
+	if (this->count++ % this->checkevery != 0)
+	{
+		return true;
+	}
+
+	if (this->last.size() == n)
+	{
+		if (VectorNorm<T>::maxabsdiff(x, &this->last[0], n) <= this->tolerance)
+		{
+			if (++this->calm >= this->window)
+			{
+				this->converged = true;
+				return false;
+			}
+		}
+		else
+		{
+			this->calm = 0;
+		}
+	}
+	this->last.assign(x, x + n);
+	return true;
+}
+
+
+
+/*	PeriodicPredicate
+ *
+ *		Continue tant que la trajectoire n'est pas périodique. Les états sont
+ * relevés (interpolés linéairement entre deux tests) à chaque traversée
+ * croissante de la section x[index] = level ; la trajectoire est jugée
+ * périodique quand un relevé est à moins de "tolerance" (norme infinie) du
+ * relevé p traversées plus tôt (p <= maxperiod), pour "confirm" traversées
+ * consécutives. "getperiod" donne p (1 pour un cycle limite simple, 2 après
+ * un doublement de période, etc.).
+ */
+template<typename T>
+class PeriodicPredicate: public SimulationPredicate<T>
+{
+	public: typedef typename SystemStates<T>::size_type size_type;
+
+	protected:
+		const SystemStates<T> *states;
+		size_type index;
+		T level, tolerance;
+		unsigned long maxperiod, confirm;
+
+		T previous;
+		bool started;
+		std::vector<T> last;				// État au test précédent.
+		std::vector<T> history;				// (maxperiod + 1) relevés, circulaire.
+		unsigned long crossings, period, matches;
+		bool periodic;
+
+	public:
+		PeriodicPredicate(const SystemStates<T> &states, const size_type index, const T level, const T tolerance, const unsigned long maxperiod = 8, const unsigned long confirm = 3);
+		virtual ~PeriodicPredicate(void){};
+
+		inline bool reason(void) const;
+		inline unsigned long getperiod(void) const;
+		inline void reset(void);
+
+		virtual bool test(void);
+};
+
+template<typename T>
+PeriodicPredicate<T>::PeriodicPredicate(const SystemStates<T> &states, const size_type index, const T level, const T tolerance, const unsigned long maxperiod, const unsigned long confirm)
+{
+	this->states = &states;
+	this->index = index;
+	this->level = level;
+	this->tolerance = tolerance;
+	this->maxperiod = (maxperiod > 0) ? maxperiod : 1;
+	this->confirm = (confirm > 0) ? confirm : 1;
+	this->reset();
+	return;
+}
+
+template<typename T>
+inline bool PeriodicPredicate<T>::reason(void) const
+{
+	return this->periodic;
+}
+
+template<typename T>
+inline unsigned long PeriodicPredicate<T>::getperiod(void) const
+{
+	return this->periodic ? this->period : 0;
+}
+
+template<typename T>
+inline void PeriodicPredicate<T>::reset(void)
+{
+	this->started = false;
+	this->last.clear();
+	this->history.clear();
+	this->crossings = 0;
+	this->period = 0;
+	this->matches = 0;
+	this->periodic = false;
+	return;
+}
+
+template<typename T>
+bool PeriodicPredicate<T>::test(void)
+{
+	const T *x = this->states->data();
+	const size_t n = this->states->size();
+	const unsigned long slots = this->maxperiod + 1;
+	const T current = x[this->index];
+	T *recent, alpha;
+	unsigned long p, found = 0;
+
+	if (this->periodic)
+	{
+		return false;
+	}
+	if ( !this->started || (this->last.size() != n) || !((this->previous < this->level) && (current >= this->level)) )
+	{
+		this->previous = current;
+		this->last.assign(x, x + n);
+		this->started = true;
+		return true;
+	}
+
+	if (this->history.size() != slots * n)
+	{
+		this->history.assign(slots * n, (T)0);
+		this->crossings = 0;
+	}
+
+	// Relevé : état interpolé linéairement sur la section.
+	alpha = (this->level - this->previous) / (current - this->previous);
+	recent = &this->history[(this->crossings % slots) * n];
+	for (size_t i = 0; i < n; ++i)
+	{
+		recent[i] = this->last[i] + alpha * (x[i] - this->last[i]);
+	}
+	++this->crossings;
+	this->previous = current;
+	this->last.assign(x, x + n);
+
+	// Plus petite période p telle que le relevé p traversées plus tôt coïncide.
+	for (p = 1; (p <= this->maxperiod) && (p < this->crossings) && (found == 0); ++p)
+	{
+		if (VectorNorm<T>::maxabsdiff(recent, &this->history[((this->crossings - 1 - p) % slots) * n], n) <= this->tolerance)
+		{
+			found = p;
+		}
+	}
+
+	if ( (found != 0) && (found == this->period) )
+	{
+		++this->matches;
+	}
+	else
+	{
+		this->period = found;
+		this->matches = (found != 0) ? 1 : 0;
+	}
+	if ( (this->period != 0) && (this->matches >= this->confirm) )
+	{
+		this->periodic = true;
+		return false;
+	}
+	return true;
+}
+
+
+
+/*	FinitePredicate
+ *
+ *		Continue tant que tous les états sont finis et de valeur absolue au plus
+ * "bound" (infini par défaut), testé tous les "checkevery" appels.
+ */
+template<typename T>
+class FinitePredicate: public SimulationPredicate<T>
+{
+	protected:
+		const SystemStates<T> *states;
+		T bound;
+		unsigned long checkevery, count;
+		bool diverged;
+
+	public:
+		FinitePredicate(const SystemStates<T> &states, const unsigned long checkevery = 1);
+		FinitePredicate(const SystemStates<T> &states, const T bound, const unsigned long checkevery = 1);
+		virtual ~FinitePredicate(void){};
+
+		inline bool reason(void) const;
+		inline void reset(void);
+
+		virtual bool test(void);
+};
+
+template<typename T>
+FinitePredicate<T>::FinitePredicate(const SystemStates<T> &states, const unsigned long checkevery)
+{
+	this->states = &states;
+	this->bound = std::numeric_limits<T>::max();
+	this->checkevery = (checkevery > 0) ? checkevery : 1;
+	this->reset();
+	return;
+}
+
+template<typename T>
+FinitePredicate<T>::FinitePredicate(const SystemStates<T> &states, const T bound, const unsigned long checkevery)
+{
+	this->states = &states;
+	this->bound = bound;
+	this->checkevery = (checkevery > 0) ? checkevery : 1;
+	this->reset();
+	return;
+}
+
+template<typename T>
+inline bool FinitePredicate<T>::reason(void) const
+{
+	return this->diverged;
+}
+
+template<typename T>
+inline void FinitePredicate<T>::reset(void)
+{
+	this->count = 0;
+	this->diverged = false;
+	return;
+}
+
+template<typename T>
+bool FinitePredicate<T>::test(void)
+{
+	if (this->diverged)
+	{
+		return false;
+	}
+	if (this->count++ % this->checkevery != 0)
+	{
+		return true;
+	}
+	if (!VectorNorm<T>::finite(this->states->data(), this->states->size(), this->bound))
+	{
+		this->diverged = true;
+		return false;
+	}
+	return true;
+}
+
+
+
+/*	WallClockPredicate
+ *
+ *		Continue tant que "seconds" secondes de temps réel ne se sont pas
+ * écoulées depuis le premier test (horloge lue tous les "checkevery" appels).
+ */
+template<typename T>
+class WallClockPredicate: public SimulationPredicate<T>
+{
+	protected:
+		double seconds;
+		unsigned long checkevery, count;
+		bool started, expired;
+		std::chrono::steady_clock::time_point deadline;
+
+	public:
+		WallClockPredicate(const double seconds, const unsigned long checkevery = 64);
+		virtual ~WallClockPredicate(void){};
+
+		inline bool reason(void) const;
+		inline void reset(void);
+
+		virtual bool test(void);
+};
+
+template<typename T>
+WallClockPredicate<T>::WallClockPredicate(const double seconds, const unsigned long checkevery)
+{
+	this->seconds = seconds;
+	this->checkevery = (checkevery > 0) ? checkevery : 1;
+	this->reset();
+	return;
+}
+
+template<typename T>
+inline bool WallClockPredicate<T>::reason(void) const
+{
+	return this->expired;
+}
+
+template<typename T>
+inline void WallClockPredicate<T>::reset(void)
+{
+	this->count = 0;
+	this->started = false;
+	this->expired = false;
+	return;
+}
+
+template<typename T>
+bool WallClockPredicate<T>::test(void)
+{
+	if (this->expired)
+	{
+		return false;
+	}
+	if (!this->started)
+	{
+		this->deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->seconds));
+		this->started = true;
+	}
+	if (this->count++ % this->checkevery != 0)
+	{
+		return true;
+	}
+	if (std::chrono::steady_clock::now() >= this->deadline)
+	{
+		this->expired = true;
+		return false;
+	}
+	return true;
+}
+
+
+#endif
@@ -33,6 +33,8 @@
  * 
  */
 
+#include <typeinfo>
+
 #include "Connection.hpp"
 #include "LocalSystem.hpp"
 #include "Network.hpp"
@@ -61,6 +63,8 @@ class StatesCoupling: public Connection<T>
 
 		size_type getfrom(void) const;
 		size_type getto(void) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -131,6 +135,19 @@ inline typename StatesCoupling<T>::size_type StatesCoupling<T>::getto(void) cons
 	return this->to;
 }
 
+template<typename T>
+bool StatesCoupling<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(StatesCoupling<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->from);
+	fingerprint.add((uint64_t)this->to);
+	return true;
+}
+
 
 
 
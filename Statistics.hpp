@@ -0,0 +1,608 @@
+#ifndef __STATISTICS_HPP__
+#define __STATISTICS_HPP__
+
+/* 	Statistics.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Observateurs statistiques calculés en une seule passe (voir
+ * Observer.hpp), sans conserver la trajectoire :
+ *		- MomentsObserver : nombre d'échantillons, moyenne, variance (méthode de
+ *		  Welford), minimum et maximum de chaque état ;
+ *		- HistogramObserver : histogramme à classes fixes [low, high) ;
+ *		- QuantileObserver : quantiles estimés au fil de l'eau (algorithme P²
+ *		  de Jain et Chlamtac, étendu à plusieurs quantiles). Avec des
+ *		  probabilités régulièrement espacées, on obtient un histogramme à
+ *		  classes équiprobables ;
+ *		- CovarianceObserver : matrice de covariance (et corrélations) des états
+ *		  sélectionnés.
+ *
+ */
+
+#include <math.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "Observer.hpp"
+
+
+/*	MomentsObserver
+ */
+template<typename T>
+class MomentsObserver: public Observer<T>
+{
+	public: typedef typename Observer<T>::size_type size_type;
+
+	protected:
+		unsigned long n;
+		std::vector<T> mmean, m2, mmin, mmax;
+
+		virtual void observe(const T t, const T *values);
+		virtual void clear(const size_type nstates);
+
+	public:
+		MomentsObserver(void):Observer<T>(){};
+		MomentsObserver(const std::vector<size_type> &selection):Observer<T>(selection){};
+		virtual ~MomentsObserver(void){};
+
+		inline unsigned long count(void) const;
+		inline T mean(const size_type i) const;
+		inline T variance(const size_type i) const;
+		inline T stddev(const size_type i) const;
+		inline T min(const size_type i) const;
+		inline T max(const size_type i) const;
+};
+
+template<typename T>
+void MomentsObserver<T>::clear(const size_type nstates)
+{
+	this->n = 0;
+	this->mmean.assign(nstates, (T)0);
+	this->m2.assign(nstates, (T)0);
+	this->mmin.assign(nstates, (T)0);
+	this->mmax.assign(nstates, (T)0);
+	return;
+}
+
+template<typename T>
+void MomentsObserver<T>::observe(const T, const T *values)
+{
+	T delta;
+
+	++this->n;
+	for (size_type i = 0; i < this->nstates; ++i)
+	{
+		delta = values[i] - this->mmean[i];
+		this->mmean[i] += delta / (T)this->n;
+		this->m2[i] += delta * (values[i] - this->mmean[i]);
+
+		if ( (this->n == 1) || (values[i] < this->mmin[i]) )
+		{
+			this->mmin[i] = values[i];
+		}
+		if ( (this->n == 1) || (values[i] > this->mmax[i]) )
+		{
+			this->mmax[i] = values[i];
+		}
+	}
+	return;
+}
+
+template<typename T>
+inline unsigned long MomentsObserver<T>::count(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+inline T MomentsObserver<T>::mean(const size_type i) const
+{
+	return this->mmean.at(i);
+}
+
+template<typename T>
+inline T MomentsObserver<T>::variance(const size_type i) const
+/*    Variance (non biaisée) de l'état i.
+ */
+{
+	return (this->n > 1) ? this->m2.at(i) / (T)(this->n - 1) : (T)0;
+}
+
+template<typename T>
+inline T MomentsObserver<T>::stddev(const size_type i) const
+{
+	return (T)sqrt((double)this->variance(i));
+}
+
+template<typename T>
+inline T MomentsObserver<T>::min(const size_type i) const
+{
+	return this->mmin.at(i);
+}
+
+template<typename T>
+inline T MomentsObserver<T>::max(const size_type i) const
+{
+	return this->mmax.at(i);
+}
+
+
+
+/*	HistogramObserver
+ *
+ *		"nbins" classes de même largeur sur [low, high) pour chaque état. Les
+ * valeurs hors de l'intervalle sont comptées à part (underflow, overflow).
+ */
+template<typename T>
+class HistogramObserver: public Observer<T>
+{
+	public: typedef typename Observer<T>::size_type size_type;
+
+	protected:
+		T low, high, scale;
+		size_type nbins;
+
+		std::vector<unsigned long> bins;	// nstates * (nbins + 2)
+
+		virtual void observe(const T t, const T *values);
+		virtual void clear(const size_type nstates);
+
+	public:
+		HistogramObserver(const T low, const T high, const size_type nbins);
+		HistogramObserver(const std::vector<size_type> &selection, const T low, const T high, const size_type nbins);
+		virtual ~HistogramObserver(void){};
+
+		inline size_type size(void) const;
+		inline T lower(const size_type bin) const;
+		inline T upper(const size_type bin) const;
+
+		inline unsigned long bin(const size_type i, const size_type bin) const;
+		inline unsigned long underflow(const size_type i) const;
+		inline unsigned long overflow(const size_type i) const;
+};
+
+template<typename T>
+HistogramObserver<T>::HistogramObserver(const T low, const T high, const size_type nbins):Observer<T>()
+{
+	if ( !(low < high) || (nbins == 0) )
+	{
+		throw std::invalid_argument("HistogramObserver");
+	}
+	this->low = low;
+	this->high = high;
+	this->nbins = nbins;
+	this->scale = (T)nbins / (high - low);
+	return;
+}
+
+template<typename T>
+HistogramObserver<T>::HistogramObserver(const std::vector<size_type> &selection, const T low, const T high, const size_type nbins):Observer<T>(selection)
+{
+	if ( !(low < high) || (nbins == 0) )
+	{
+		throw std::invalid_argument("HistogramObserver");
+	}
+	this->low = low;
+	this->high = high;
+	this->nbins = nbins;
+	this->scale = (T)nbins / (high - low);
+	return;
+}
+
+template<typename T>
+void HistogramObserver<T>::clear(const size_type nstates)
+{
+	this->bins.assign(nstates * (this->nbins + 2), 0);
+	return;
+}
+
+template<typename T>
+void HistogramObserver<T>::observe(const T, const T *values)
+/*    Pour chaque état, la case 0 compte les valeurs inférieures à "low", la
+ * case nbins + 1 les valeurs supérieures ou égales à "high" (et NaN).
+ */
+{
+	unsigned long *bins = &this->bins[0];
+	size_type b;
+
+	for (size_type i = 0; i < this->nstates; ++i, bins += this->nbins + 2)
+	{
+		if (values[i] < this->low)
+		{
+			b = 0;
+		}
+		else if (values[i] < this->high)
+		{
+			b = 1 + (size_type)((values[i] - this->low) * this->scale);
+			if (b > this->nbins)
+			{
+				b = this->nbins;	// Arrondi au bord supérieur.
+			}
+		}
+		else
+		{
+			b = this->nbins + 1;
+		}
+		++bins[b];
+	}
+	return;
+}
+
+template<typename T>
+inline typename HistogramObserver<T>::size_type HistogramObserver<T>::size(void) const
+{
+	return this->nbins;
+}
+
+template<typename T>
+inline T HistogramObserver<T>::lower(const size_type bin) const
+{
+	return this->low + (T)bin / this->scale;
+}
+
+template<typename T>
+inline T HistogramObserver<T>::upper(const size_type bin) const
+{
+	return this->low + (T)(bin + 1) / this->scale;
+}
+
+template<typename T>
+inline unsigned long HistogramObserver<T>::bin(const size_type i, const size_type bin) const
+{
+	return this->bins.at(i * (this->nbins + 2) + 1 + bin);
+}
+
+template<typename T>
+inline unsigned long HistogramObserver<T>::underflow(const size_type i) const
+{
+	return this->bins.at(i * (this->nbins + 2));
+}
+
+template<typename T>
+inline unsigned long HistogramObserver<T>::overflow(const size_type i) const
+{
+	return this->bins.at(i * (this->nbins + 2) + this->nbins + 1);
+}
+
+
+
+/*	QuantileObserver
+ *
+ *		Estimation des quantiles de probabilités "probabilities" (dans ]0, 1[)
+ * pour chaque état, en mémoire constante. Les marqueurs du P² sont placés aux
+ * probabilités 0, 1, à chaque probabilité demandée et à mi-chemin entre elles.
+ * Tant qu'il y a moins d'échantillons que de marqueurs, les quantiles sont
+ * exacts.
+ */
+template<typename T>
+class QuantileObserver: public Observer<T>
+{
+	public: typedef typename Observer<T>::size_type size_type;
+
+	protected:
+		std::vector<double> probabilities;	// Probabilités demandées.
+		std::vector<double> q;				// Probabilités des marqueurs.
+		std::vector<size_type> markers;		// Marqueur de chaque probabilité demandée.
+
+		unsigned long n;
+		std::vector<T> heights;				// nstates * q.size()
+		std::vector<double> positions;		// nstates * q.size()
+
+		void update(T *h, double *p, const T x);
+
+		virtual void observe(const T t, const T *values);
+		virtual void clear(const size_type nstates);
+
+		void init(const std::vector<double> &probabilities);
+
+	public:
+		QuantileObserver(const std::vector<double> &probabilities);
+		QuantileObserver(const std::vector<size_type> &selection, const std::vector<double> &probabilities);
+		virtual ~QuantileObserver(void){};
+
+		inline unsigned long count(void) const;
+		T quantile(const size_type i, const size_type k) const;
+};
+
+template<typename T>
+QuantileObserver<T>::QuantileObserver(const std::vector<double> &probabilities):Observer<T>()
+{
+	this->init(probabilities);
+	return;
+}
+
+template<typename T>
+QuantileObserver<T>::QuantileObserver(const std::vector<size_type> &selection, const std::vector<double> &probabilities):Observer<T>(selection)
+{
+	this->init(probabilities);
+	return;
+}
+
+template<typename T>
+void QuantileObserver<T>::init(const std::vector<double> &probabilities)
+{
+	std::vector<double> anchors;
+
+	anchors.push_back(0.0);
+	for (size_t k = 0; k < probabilities.size(); ++k)
+	{
+		if ( !(probabilities[k] > 0.0) || !(probabilities[k] < 1.0) || !(probabilities[k] > anchors.back()) )
+		{
+			throw std::invalid_argument("QuantileObserver");
+		}
+		anchors.push_back(probabilities[k]);
+	}
+	anchors.push_back(1.0);
+
+	this->probabilities = probabilities;
+	this->q.clear();
+	this->markers.clear();
+	for (size_t k = 0; k + 1 < anchors.size(); ++k)
+	{
+		if (k > 0)
+		{
+			this->markers.push_back(this->q.size());
+		}
+		this->q.push_back(anchors[k]);
+		this->q.push_back((anchors[k] + anchors[k+1]) / 2.0);
+	}
+	this->q.push_back(1.0);
+	return;
+}
+
+template<typename T>
+void QuantileObserver<T>::clear(const size_type nstates)
+{
+	this->n = 0;
+	this->heights.assign(nstates * this->q.size(), (T)0);
+	this->positions.assign(nstates * this->q.size(), 0.0);
+	return;
+}
+
+template<typename T>
+void QuantileObserver<T>::observe(const T, const T *values)
+{
+	const size_type m = this->q.size();
+
+	++this->n;
+	for (size_type i = 0; i < this->nstates; ++i)
+	{
+		T *h = &this->heights[i * m];
+
+		if (this->n <= m)
+		{
+			// Initialisation : les m premières valeurs, triées.
+			h[this->n - 1] = values[i];
+			std::sort(h, h + this->n);
+			if (this->n == m)
+			{
+				for (size_type j = 0; j < m; ++j)
+				{
+					this->positions[i * m + j] = (double)j;
+				}
+			}
+			continue;
+		}
+		this->update(h, &this->positions[i * m], values[i]);
+	}
+	return;
+}
+
+template<typename T>
+void QuantileObserver<T>::update(T *h, double *p, const T x)
+/*    Une itération du P² (positions comptées à partir de 0).
+ */
+{
+	const size_type m = this->q.size();
+	size_type k;
+	double d, s, hp;
+
+	if (x < h[0])
+	{
+		h[0] = x;
+		k = 0;
+	}
+	else if (x >= h[m-1])
+	{
+		h[m-1] = x;
+		k = m - 2;
+	}
+	else
+	{
+		k = std::upper_bound(h, h + m, x) - h - 1;
+	}
+
+	for (size_type j = k + 1; j < m; ++j)
+	{
+		p[j] += 1.0;
+	}
+
+	for (size_type j = 1; j + 1 < m; ++j)
+	{
+		d = (double)(this->n - 1) * this->q[j] - p[j];
+		if ( ((d >= 1.0) && (p[j+1] - p[j] > 1.0)) || ((d <= -1.0) && (p[j-1] - p[j] < -1.0)) )
+		{
+			s = (d > 0.0) ? 1.0 : -1.0;
+
+			// Interpolation parabolique, ou linéaire si elle sort de l'intervalle.
+			hp = (double)h[j] + s / (p[j+1] - p[j-1]) * (
+				(p[j] - p[j-1] + s) * (double)(h[j+1] - h[j]) / (p[j+1] - p[j]) +
+				(p[j+1] - p[j] - s) * (double)(h[j] - h[j-1]) / (p[j] - p[j-1]) );
+
+			if ( ((double)h[j-1] < hp) && (hp < (double)h[j+1]) )
+			{
+				h[j] = (T)hp;
+			}
+			else if (s > 0.0)
+			{
+				h[j] = h[j] + (h[j+1] - h[j]) / (T)(p[j+1] - p[j]);
+			}
+			else
+			{
+				h[j] = h[j] - (h[j-1] - h[j]) / (T)(p[j-1] - p[j]);
+			}
+			p[j] += s;
+		}
+	}
+	return;
+}
+
+template<typename T>
+inline unsigned long QuantileObserver<T>::count(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+T QuantileObserver<T>::quantile(const size_type i, const size_type k) const
+/*    Quantile de probabilité "probabilities[k]" de l'état i.
+ */
+{
+	const size_type m = this->q.size();
+	const T *h;
+	size_type r;
+
+	if ( (i >= this->nstates) || (k >= this->probabilities.size()) || (this->n == 0) )
+	{
+		throw std::out_of_range("QuantileObserver::quantile");
+	}
+
+	h = &this->heights[i * m];
+	if (this->n < m)
+	{
+		// Valeurs triées : quantile par rang.
+		r = (size_type)(this->probabilities[k] * (double)(this->n - 1) + 0.5);
+		return h[r];
+	}
+	return h[this->markers[k]];
+}
+
+
+
+/*	CovarianceObserver
+ *
+ *		Covariances entre les états sélectionnés (mise à jour en une passe,
+ * généralisation de la méthode de Welford).
+ */
+template<typename T>
+class CovarianceObserver: public Observer<T>
+{
+	public: typedef typename Observer<T>::size_type size_type;
+
+	protected:
+		unsigned long n;
+		std::vector<T> mmean, delta;
+		std::vector<T> comoment;		// nstates * nstates
+
+		virtual void observe(const T t, const T *values);
+		virtual void clear(const size_type nstates);
+
+	public:
+		CovarianceObserver(void):Observer<T>(){};
+		CovarianceObserver(const std::vector<size_type> &selection):Observer<T>(selection){};
+		virtual ~CovarianceObserver(void){};
+
+		inline unsigned long count(void) const;
+		inline T mean(const size_type i) const;
+		inline T covariance(const size_type i, const size_type j) const;
+		inline T correlation(const size_type i, const size_type j) const;
+};
+
+template<typename T>
+void CovarianceObserver<T>::clear(const size_type nstates)
+{
+	this->n = 0;
+	this->mmean.assign(nstates, (T)0);
+	this->delta.assign(nstates, (T)0);
+	this->comoment.assign(nstates * nstates, (T)0);
+	return;
+}
+
+template<typename T>
+void CovarianceObserver<T>::observe(const T, const T *values)
+{
+	const size_type m = this->nstates;
+	T *c;
+
+	++this->n;
+	for (size_type i = 0; i < m; ++i)
+	{
+		this->delta[i] = values[i] - this->mmean[i];
+		this->mmean[i] += this->delta[i] / (T)this->n;
+	}
+	// C += (x - moyenne précédente) (x - nouvelle moyenne)^T, triangle supérieur.
+	for (size_type i = 0; i < m; ++i)
+	{
+		c = &this->comoment[i * m];
+		for (size_type j = i; j < m; ++j)
+		{
+			c[j] += this->delta[i] * (values[j] - this->mmean[j]);
+		}
+	}
+	return;
+}
+
+template<typename T>
+inline unsigned long CovarianceObserver<T>::count(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+inline T CovarianceObserver<T>::mean(const size_type i) const
+{
+	return this->mmean.at(i);
+}
+
+template<typename T>
+inline T CovarianceObserver<T>::covariance(const size_type i, const size_type j) const
+{
+	if ( (i >= this->nstates) || (j >= this->nstates) )
+	{
+		throw std::out_of_range("CovarianceObserver::covariance");
+	}
+	if (this->n < 2)
+	{
+		return (T)0;
+	}
+	return (i <= j ? this->comoment[i * this->nstates + j] : this->comoment[j * this->nstates + i]) / (T)(this->n - 1);
+}
+
+template<typename T>
+inline T CovarianceObserver<T>::correlation(const size_type i, const size_type j) const
+{
+	return this->covariance(i, j) / (T)sqrt( (double)(this->covariance(i, i) * this->covariance(j, j)) );
+}
+
+
+#endif
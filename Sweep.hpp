@@ -0,0 +1,576 @@
+#ifndef __SWEEP_HPP__
+#define __SWEEP_HPP__
+
+/* 	Sweep.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Balayage de paramètres (diagrammes de bifurcation) en parallèle. Pour
+ * chaque point d'une grille à une ou deux dimensions (p1, p2), le système est
+ * simulé pendant un transitoire puis pendant une durée d'enregistrement, et un
+ * extracteur (voir Extractors.hpp) réduit la trajectoire à quelques valeurs.
+ *
+ *		- SweepFactory crée les objets d'une tâche de fond (système et
+ *		  intégrateur) et fixe les paramètres du système pour un point ;
+ *		- Sweep distribue la grille sur un ThreadPool. Chaque tâche de fond a
+ *		  son propre système, intégrateur, Simulation et extracteur (aucun
+ *		  partage). Une ligne de la grille (p2 fixé) est découpée en blocs de
+ *		  "setblocksize" points parcourus dans l'ordre de p1 : avec
+ *		  "warmstart", chaque point part de l'état final du point précédent du
+ *		  bloc (le transitoire converge plus vite et l'on suit une même branche
+ *		  d'attracteurs). Le découpage ne dépend pas du nombre de tâches de
+ *		  fond : les résultats sont reproductibles d'une machine à l'autre.
+ *		  Avec "setcache", les transitoires déjà calculés (même point, même
+ *		  état initial) sont relus d'un TransientCache partagé, sauf pour les
+ *		  points ayant une condition d'arrêt (SweepFactory::condition) ;
+ *		- SweepResult stocke les valeurs de tous les points et les écrit dans un
+ *		  format binaire compact (petit-boutiste) :
+ *			 0	char[8]		"SYSSIMSW"
+ *			 8	uint32		version
+ *			12	uint32		code du type des valeurs (voir BinaryType)
+ *			16	uint32		taille (octets) d'une valeur
+ *			20	uint32		réservé
+ *			24	uint64		n1 (nombre de valeurs de p1)
+ *			32	uint64		n2 (nombre de valeurs de p2, 1 pour une grille 1D)
+ *			40	T[n1]		valeurs de p1, puis T[n2] valeurs de p2
+ *				uint64[n1 n2 + 1]	position (en valeurs) des résultats de
+ *						chaque point, le point (i, j) ayant l'indice j n1 + i
+ *				T[...]		valeurs extraites, à la suite.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "DynamicalSystem.hpp"
+#include "Extractors.hpp"
+#include "Integrators.hpp"
+#include "Simulation.hpp"
+#include "SimulationPredicate.hpp"
+#include "ThreadPool.hpp"
+#include "TransientCache.hpp"
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class SweepFactory
+{
+	public:
+		SweepFactory(void){};
+		virtual ~SweepFactory(void){};
+
+		/* Objets d'une tâche de fond, détruits (delete) par Sweep. */
+		virtual DynamicalSystem<T> *system(void) = 0;
+		virtual Integrator<T> *integrator(void) = 0;
+
+		/* Paramètres du point (p1, p2) ; p2 vaut 0 pour une grille 1D. */
+		virtual void parameters(DynamicalSystem<T> &system, const T p1, const T p2) = 0;
+
+		/* Condition d'arrêt anticipé d'un point (point fixe, divergence,
+		 * ... voir SimulationPredicate.hpp), créée pour chaque point et
+		 * détruite (delete) par Sweep. NULL : aucune. Elle est testée dès le
+		 * transitoire : le point s'arrête dès qu'elle est fausse. Le
+		 * transitoire d'un point avec condition ne passe pas par le cache
+		 * ("setcache").
+		 */
+		virtual SimulationPredicate<T> *condition(DynamicalSystem<T> &){return NULL;};
+};
+
+
+
+/*	SweepResult
+ */
+template<typename T>
+class SweepResult
+{
+	public: typedef typename std::vector<T>::size_type size_type;
+
+	public:
+		static const uint32_t version = 1;
+
+		std::vector<T> p1, p2;
+		std::vector<uint64_t> offsets;		// n1 n2 + 1
+		std::vector<T> values;
+
+		SweepResult(void){};
+		virtual ~SweepResult(void){};
+
+		inline size_type size1(void) const;
+		inline size_type size2(void) const;
+
+		inline size_type count(const size_type i, const size_type j = 0) const;
+		inline const T *at(const size_type i, const size_type j = 0) const;
+
+		void write(std::ostream &ostream) const;
+		void read(std::istream &istream);
+};
+
+template<typename T>
+inline typename SweepResult<T>::size_type SweepResult<T>::size1(void) const
+{
+	return this->p1.size();
+}
+
+template<typename T>
+inline typename SweepResult<T>::size_type SweepResult<T>::size2(void) const
+{
+	return this->p2.size();
+}
+
+template<typename T>
+inline typename SweepResult<T>::size_type SweepResult<T>::count(const size_type i, const size_type j) const
+{
+	const size_type k = j * this->p1.size() + i;
+
+	if ( (i >= this->p1.size()) || (j >= this->p2.size()) )
+	{
+		throw std::out_of_range("SweepResult::count");
+	}
+	return (size_type)(this->offsets[k+1] - this->offsets[k]);
+}
+
+template<typename T>
+inline const T* SweepResult<T>::at(const size_type i, const size_type j) const
+/*    Valeurs extraites au point (i, j) ("count(i, j)" valeurs).
+ */
+{
+	const size_type k = j * this->p1.size() + i;
+
+	if ( (i >= this->p1.size()) || (j >= this->p2.size()) )
+	{
+		throw std::out_of_range("SweepResult::at");
+	}
+	return this->values.empty() ? NULL : &this->values[0] + this->offsets[k];
+}
+
+template<typename T>
+void SweepResult<T>::write(std::ostream &ostream) const
+{
+	std::string buffer;
+
+	buffer.reserve(40 + sizeof(T) * (this->p1.size() + this->p2.size() + this->values.size()) + sizeof(uint64_t) * this->offsets.size());
+	buffer.append("SYSSIMSW", 8);
+	BinaryFormat::append(buffer, (uint32_t)version);
+	BinaryFormat::append(buffer, (uint32_t)BinaryType<T>::code);
+	BinaryFormat::append(buffer, (uint32_t)sizeof(T));
+	BinaryFormat::append(buffer, (uint32_t)0);
+	BinaryFormat::append(buffer, (uint64_t)this->p1.size());
+	BinaryFormat::append(buffer, (uint64_t)this->p2.size());
+	for (size_t i = 0; i < this->p1.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->p1[i]);
+	}
+	for (size_t i = 0; i < this->p2.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->p2[i]);
+	}
+	for (size_t i = 0; i < this->offsets.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->offsets[i]);
+	}
+	for (size_t i = 0; i < this->values.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->values[i]);
+	}
+
+	ostream.write(buffer.data(), (std::streamsize)buffer.size());
+	if (!ostream)
+	{
+		throw std::runtime_error("SweepResult::write");
+	}
+	return;
+}
+
+template<typename T>
+void SweepResult<T>::read(std::istream &istream)
+{
+	char header[40];
+	std::vector<char> data;
+	uint64_t n1, n2, n, available, cells;
+	std::streampos position;
+	const char *p;
+
+	if ( !istream.read(header, sizeof(header)) || (memcmp(header, "SYSSIMSW", 8) != 0) )
+	{
+		throw std::runtime_error("SweepResult::read : not a sweep result");
+	}
+	if ( (BinaryFormat::load<uint32_t>(header + 8) != version) ||
+		 (BinaryFormat::load<uint32_t>(header + 12) != (uint32_t)BinaryType<T>::code) ||
+		 (BinaryFormat::load<uint32_t>(header + 16) != (uint32_t)sizeof(T)) )
+	{
+		throw std::runtime_error("SweepResult::read : incompatible sweep result");
+	}
+	n1 = BinaryFormat::load<uint64_t>(header + 24);
+	n2 = BinaryFormat::load<uint64_t>(header + 32);
+
+	// Les tailles lues sont bornées par la longueur restante du flux (si elle
+	// est connue) avant toute allocation, sans débordement de n1 n2.
+	available = (uint64_t)-1;
+	position = istream.tellg();
+	if (position != std::streampos(-1))
+	{
+		istream.seekg(0, std::ios::end);
+		available = (uint64_t)(istream.tellg() - position);
+		istream.seekg(position);
+	}
+	if ( (n1 > available / sizeof(T)) || (n2 > available / sizeof(T) - n1) )
+	{
+		throw std::runtime_error("SweepResult::read : corrupted sweep result");
+	}
+	available -= sizeof(T) * (n1 + n2);
+	cells = available / sizeof(uint64_t);
+	if ( (cells == 0) || ( (n2 > 0) && (n1 > (cells - 1) / n2) ) )
+	{
+		throw std::runtime_error("SweepResult::read : corrupted sweep result");
+	}
+	available -= sizeof(uint64_t) * (n1 * n2 + 1);
+
+	data.resize(sizeof(T) * (n1 + n2) + sizeof(uint64_t) * (n1 * n2 + 1));
+	if (!istream.read(&data[0], (std::streamsize)data.size()))
+	{
+		throw std::runtime_error("SweepResult::read : truncated sweep result");
+	}
+	p = &data[0];
+	this->p1.resize(n1);
+	for (size_t i = 0; i < n1; ++i, p += sizeof(T))
+	{
+		this->p1[i] = BinaryFormat::load<T>(p);
+	}
+	this->p2.resize(n2);
+	for (size_t i = 0; i < n2; ++i, p += sizeof(T))
+	{
+		this->p2[i] = BinaryFormat::load<T>(p);
+	}
+	this->offsets.resize(n1 * n2 + 1);
+	for (size_t i = 0; i < this->offsets.size(); ++i, p += sizeof(uint64_t))
+	{
+		this->offsets[i] = BinaryFormat::load<uint64_t>(p);
+		if ( (i == 0) ? (this->offsets[0] != 0) : (this->offsets[i] < this->offsets[i-1]) )
+		{
+			throw std::runtime_error("SweepResult::read : corrupted sweep result");
+		}
+	}
+
+	n = this->offsets.back();
+	if (n > available / sizeof(T))
+	{
+		throw std::runtime_error("SweepResult::read : corrupted sweep result");
+	}
+	data.resize(sizeof(T) * n);
+	if ( (n > 0) && !istream.read(&data[0], (std::streamsize)data.size()) )
+	{
+		throw std::runtime_error("SweepResult::read : truncated sweep result");
+	}
+	this->values.resize(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		this->values[i] = BinaryFormat::load<T>(&data[0] + i * sizeof(T));
+	}
+	return;
+}
+
+
+
+/*	Sweep
+ */
+template<typename T>
+class Sweep
+{
+	public: typedef typename std::vector<T>::size_type size_type;
+
+	protected:
+		/* Espace de travail d'une tâche de fond. */
+		struct Workspace
+		{
+			DynamicalSystem<T> *system;
+			Integrator<T> *integrator;
+			Simulation<T> *simulation;
+			Extractor<T> *extractor;
+		};
+
+		SweepFactory<T> *factory;
+		const Extractor<T> *extractor;
+
+		std::vector<T> p1, p2;
+		std::vector<T> x0;
+		T transiant, record;
+		bool warm;
+		size_type blocksize;
+		TransientCache<T> *cache;
+
+		std::vector< std::vector<T> > values;	// Résultats de chaque point.
+		SweepResult<T> result;
+
+		void compute(Workspace &workspace, const size_type j, const size_type first, const size_type last);
+		static void release(std::vector<Workspace> &workspaces);
+
+	public:
+		Sweep(SweepFactory<T> &factory, const Extractor<T> &extractor);
+		virtual ~Sweep(void){};
+
+		void grid(const std::vector<T> &p1);
+		void grid(const std::vector<T> &p1, const std::vector<T> &p2);
+
+		inline void initial(const std::vector<T> &x0);
+		inline void duration(const T transiant, const T record);
+		inline void warmstart(const bool enabled);
+		inline void setblocksize(const size_type points);
+		inline void setcache(TransientCache<T> &cache);
+
+		void run(ThreadPool &pool);
+
+		inline const SweepResult<T> &getresult(void) const;
+};
+
+template<typename T>
+Sweep<T>::Sweep(SweepFactory<T> &factory, const Extractor<T> &extractor)
+{
+	this->factory = &factory;
+	this->extractor = &extractor;
+	this->transiant = (T)0;
+	this->record = (T)0;
+	this->warm = true;
+	this->blocksize = 32;
+	this->cache = NULL;
+	this->p2.assign(1, (T)0);
+	return;
+}
+
+template<typename T>
+void Sweep<T>::grid(const std::vector<T> &p1)
+{
+	this->p1 = p1;
+	this->p2.assign(1, (T)0);
+	return;
+}
+
+template<typename T>
+void Sweep<T>::grid(const std::vector<T> &p1, const std::vector<T> &p2)
+{
+	this->p1 = p1;
+	this->p2 = p2;
+	return;
+}
+
+template<typename T>
+inline void Sweep<T>::initial(const std::vector<T> &x0)
+/*    État initial (du premier point de chaque bloc, ou de tous les points
+ * sans "warmstart"). Par défaut, l'état du système créé par la fabrique.
+ */
+{
+	this->x0 = x0;
+	return;
+}
+
+template<typename T>
+inline void Sweep<T>::duration(const T transiant, const T record)
+{
+	this->transiant = transiant;
+	this->record = record;
+	return;
+}
+
+template<typename T>
+inline void Sweep<T>::warmstart(const bool enabled)
+{
+	this->warm = enabled;
+	return;
+}
+
+template<typename T>
+inline void Sweep<T>::setblocksize(const size_type points)
+/*    Nombre de points consécutifs (selon p1) d'un bloc (32 par défaut). Des
+ * blocs plus longs prolongent le démarrage à chaud, des blocs plus courts
+ * équilibrent mieux la charge.
+ */
+{
+	this->blocksize = (points > 0) ? points : 1;
+	return;
+}
+
+template<typename T>
+inline void Sweep<T>::setcache(TransientCache<T> &cache)
+{
+	this->cache = &cache;
+	return;
+}
+
+template<typename T>
+inline const SweepResult<T>& Sweep<T>::getresult(void) const
+{
+	return this->result;
+}
+
+
+
+template<typename T>
+void Sweep<T>::compute(Workspace &workspace, const size_type j, const size_type first, const size_type last)
+/*    Points first <= i < last de la ligne j.
+ */
+{
+	DynamicalSystem<T> &system = *workspace.system;
+	FixedStepIntegrator<T> *fixedstep = dynamic_cast< FixedStepIntegrator<T>* >(workspace.integrator);
+	SimulationPredicate<T> *condition;
+
+	for (size_type i = first; i < last; ++i)
+	{
+		if ( (i == first) || !this->warm )
+		{
+			for (long k = 0; k < system.size(); ++k)
+			{
+				system[k] = this->x0[k];
+			}
+		}
+		if (fixedstep != NULL)
+		{
+			fixedstep->resetcompensation();
+		}
+		this->factory->parameters(system, this->p1[i], this->p2[j]);
+
+		workspace.simulation->setTime((T)0);
+		workspace.simulation->writingstep((long)0);
+		condition = this->factory->condition(system);
+		if (condition != NULL)
+		{
+			try
+			{
+				workspace.simulation->run(*workspace.extractor, this->transiant, this->transiant + this->record, *condition, true);
+			}
+			catch (...)
+			{
+				delete condition;
+				throw;
+			}
+			delete condition;
+		}
+		else
+		{
+			workspace.simulation->run(*workspace.extractor, this->transiant, this->transiant + this->record);
+		}
+
+		this->values[j * this->p1.size() + i] = workspace.extractor->getvalues();
+	}
+	return;
+}
+
+template<typename T>
+void Sweep<T>::release(std::vector<Workspace> &workspaces)
+{
+	for (size_t w = 0; w < workspaces.size(); ++w)
+	{
+		delete workspaces[w].extractor;
+		delete workspaces[w].simulation;
+		delete workspaces[w].integrator;
+		delete workspaces[w].system;
+	}
+	workspaces.clear();
+	return;
+}
+
+template<typename T>
+void Sweep<T>::run(ThreadPool &pool)
+{
+	const size_type n1 = this->p1.size();
+	const size_type n2 = this->p2.size();
+	size_type blocks, width;
+	std::vector<Workspace> workspaces(pool.size());
+	std::vector<T> initial;
+
+	// Une fabrique n'est pas supposée réentrante : création séquentielle.
+	for (size_t w = 0; w < workspaces.size(); ++w)
+	{
+		workspaces[w].system = this->factory->system();
+		workspaces[w].integrator = this->factory->integrator();
+		workspaces[w].simulation = new Simulation<T>(*workspaces[w].system, *workspaces[w].integrator);
+		workspaces[w].extractor = this->extractor->clone();
+		if (this->cache != NULL)
+		{
+			workspaces[w].simulation->settransiantcache(*this->cache);
+		}
+	}
+	if (this->x0.empty() && !workspaces.empty())
+	{
+		const T *x = workspaces[0].system->data();
+		this->x0.assign(x, x + workspaces[0].system->size());
+	}
+
+	// Découpage indépendant du nombre de tâches de fond : les résultats (avec
+	// "warmstart") ne dépendent pas de la machine.
+	width = std::max((size_type)1, this->blocksize);
+	blocks = (n1 + width - 1) / width;
+
+	this->values.assign(n1 * n2, std::vector<T>());
+	try
+	{
+		if ( (n1 > 0) && ((long)this->x0.size() != workspaces[0].system->size()) )
+		{
+			throw std::invalid_argument("Sweep::run : initial state size mismatch");
+		}
+		pool.run(n2 * blocks, [&](size_t task, size_t worker)
+		{
+			const size_type j = task / blocks;
+			const size_type first = (task % blocks) * width;
+			this->compute(workspaces[worker], j, first, std::min(first + width, n1));
+		});
+	}
+	catch (...)
+	{
+		release(workspaces);
+		throw;
+	}
+	release(workspaces);
+
+	// Résultats regroupés (points dans l'ordre j n1 + i).
+	this->result.p1 = this->p1;
+	this->result.p2 = this->p2;
+	this->result.offsets.resize(n1 * n2 + 1);
+	this->result.offsets[0] = 0;
+	for (size_t k = 0; k < this->values.size(); ++k)
+	{
+		this->result.offsets[k+1] = this->result.offsets[k] + this->values[k].size();
+	}
+	this->result.values.clear();
+	this->result.values.reserve(this->result.offsets.back());
+	for (size_t k = 0; k < this->values.size(); ++k)
+	{
+		this->result.values.insert(this->result.values.end(), this->values[k].begin(), this->values[k].end());
+	}
+	std::vector< std::vector<T> >().swap(this->values);
+	return;
+}
+
+
+#endif
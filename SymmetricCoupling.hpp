@@ -0,0 +1,235 @@
+#ifndef __SYMMETRICCOUPLING_HPP__
+#define __SYMMETRICCOUPLING_HPP__
+
+/* 	SymmetricCoupling.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Connexions symétriques d'un réseau, évaluées une seule fois par arête
+ * au lieu d'une fois par sens. Une sorte de connexion K (voir
+ * ConnectionStore.hpp) convient si elle a des membres "from" et "to" et si
+ * "v = link(x)" est un flux antisymétrique : l'arête ajoute v à dx[to] et
+ * retire v de dx[from]. C'est le cas de GainLink (couplage diffusif
+ * "gain (x[from] - x[to])"), sorte par défaut.
+ *
+ *		"build()" colore les arêtes (voir EdgeColouring.hpp, les extrémités
+ * étant les états écrits) et les range par couleur. "apply" traite les
+ * couleurs l'une après l'autre ; les arêtes d'une couleur n'ont aucune
+ * extrémité commune, et sont réparties sans atomique ni verrou entre les
+ * tâches de fond d'un ThreadPool si "setpool" en a donné un (par tranches
+ * de "grain" arêtes ; une couleur plus petite que deux tranches est traitée
+ * directement). Le groupe de tâches ne doit pas être celui qui exécute la
+ * simulation elle-même (voir Sweep).
+ *		"add" après "build" impose un nouveau "build" avant "apply".
+ *
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <typeinfo>
+#include <vector>
+
+#include "ConnectionStore.hpp"
+#include "EdgeColouring.hpp"
+#include "Fingerprint.hpp"
+#include "GlobalCoupling.hpp"
+#include "ThreadPool.hpp"
+
+template<typename T, typename K = GainLink<T> >
+class SymmetricCoupling: public GlobalCoupling<T>
+{
+	protected:
+		std::vector<K> links;
+		std::vector<uint64_t> offsets;		// Arêtes de la couleur c : offsets[c] à offsets[c+1] - 1.
+		bool built;
+		ThreadPool *pool;
+		size_t grain;
+
+		inline void scatter(const T *x, T *dx, const uint64_t first, const uint64_t last) const;
+
+	public:
+		SymmetricCoupling(void);
+		virtual ~SymmetricCoupling(void){};
+
+		void add(const K &link);
+		void reserve(const size_t n);
+		void build(void);
+
+		void setpool(ThreadPool *pool, const size_t grain = 4096);
+
+		inline size_t size(void) const;
+		inline uint32_t sizecolours(void) const;
+
+		virtual void apply(const T *x, T *dx) const;
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+};
+
+template<typename T, typename K>
+SymmetricCoupling<T,K>::SymmetricCoupling(void)
+{
+	this->built = true;
+	this->offsets.assign(1, 0);
+	this->pool = NULL;
+	this->grain = 4096;
+	return;
+}
+
+template<typename T, typename K>
+void SymmetricCoupling<T,K>::add(const K &link)
+{
+	if (link.from == link.to)
+	{
+		throw std::invalid_argument("SymmetricCoupling::add : both ends are the same state");
+	}
+	this->links.push_back(link);
+	this->built = false;
+	return;
+}
+
+template<typename T, typename K>
+void SymmetricCoupling<T,K>::reserve(const size_t n)
+{
+	this->links.reserve(n);
+	return;
+}
+
+template<typename T, typename K>
+void SymmetricCoupling<T,K>::build(void)
+{
+	std::vector<uint64_t> a(this->links.size()), b(this->links.size()), order;
+	std::vector<K> sorted;
+	uint64_t n = 0;
+
+	for (size_t e = 0; e < this->links.size(); ++e)
+	{
+		a[e] = this->links[e].from;
+		b[e] = this->links[e].to;
+		n = std::max(n, std::max(a[e], b[e]) + 1);
+	}
+
+	EdgeColouring colouring(n, a, b);
+
+	order = colouring.order(this->offsets);
+	sorted.reserve(this->links.size());
+	for (size_t k = 0; k < order.size(); ++k)
+	{
+		sorted.push_back(this->links[order[k]]);
+	}
+	this->links.swap(sorted);
+	this->built = true;
+	return;
+}
+
+template<typename T, typename K>
+void SymmetricCoupling<T,K>::setpool(ThreadPool *pool, const size_t grain)
+{
+	this->pool = pool;
+	this->grain = std::max<size_t>(grain, 1);
+	return;
+}
+
+template<typename T, typename K>
+inline size_t SymmetricCoupling<T,K>::size(void) const
+{
+	return this->links.size();
+}
+
+template<typename T, typename K>
+inline uint32_t SymmetricCoupling<T,K>::sizecolours(void) const
+{
+	return (uint32_t)(this->offsets.size() - 1);
+}
+
+template<typename T, typename K>
+inline void SymmetricCoupling<T,K>::scatter(const T *x, T *dx, const uint64_t first, const uint64_t last) const
+{
+	for (uint64_t e = first; e < last; ++e)
+	{
+		const K &link = this->links[e];
+		const T value = link(x);
+
+		dx[link.to] += value;
+		dx[link.from] -= value;
+	}
+	return;
+}
+
+template<typename T, typename K>
+void SymmetricCoupling<T,K>::apply(const T *x, T *dx) const
+{
+	if (!this->built)
+	{
+		throw std::logic_error("SymmetricCoupling::apply : build() must be called after add()");
+	}
+	for (size_t c = 0; c + 1 < this->offsets.size(); ++c)
+	{
+		const uint64_t first = this->offsets[c];
+		const uint64_t count = this->offsets[c+1] - first;
+
+		if ( (this->pool == NULL) || (count < 2 * this->grain) )
+		{
+			this->scatter(x, dx, first, first + count);
+			continue;
+		}
+		this->pool->run((count + this->grain - 1) / this->grain,
+			[this, x, dx, first, count](size_t task, size_t)
+			{
+				const uint64_t begin = first + task * this->grain;
+
+				this->scatter(x, dx, begin, std::min(begin + this->grain, first + count));
+			});
+	}
+	return;
+}
+
+template<typename T, typename K>
+bool SymmetricCoupling<T,K>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(SymmetricCoupling<T,K>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add((uint64_t)this->links.size());
+	for (size_t e = 0; e < this->links.size(); ++e)
+	{
+		if (!ConnectionStore<T>::fingerprintlink(this->links[e], fingerprint))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
@@ -53,6 +53,8 @@
 #include <string>
 #include <sstream>
 
+#include "TextFormat.hpp"
+
 template<typename T>
 class SystemStates
 {
@@ -75,6 +77,12 @@ class SystemStates
 		inline T &operator[](const size_type index);
 		inline T operator[](const size_type index) const;
 
+		/* Accès direct au tableau (contigu) des états. Renvoie NULL si le
+		 * vecteur est vide.
+		 */
+		inline T *data(void);
+		inline const T *data(void) const;
+
 		inline long size(void) const;
 
 		inline void resize(const size_type nbstates);
@@ -105,7 +113,16 @@ class SystemStates
 		 *		défaut).
 		 *	- int width : donne le nombre total de caractères utilisés pour
 		 *		écrire le nombre (6 par défaut).
+		 *
+		 * Les versions non constantes appellent les versions constantes. Elles
+		 * ne sont gardées que pour les classes dérivées qui redéfinissent
+		 * encore "toString" sans "const", et seront retirées. Une telle
+		 * redéfinition n'est appelée que sur un objet non constant : TextSink
+		 * (donc Simulation::run sur un flux) appelle les versions constantes,
+		 * qu'il faut redéfinir pour changer la sortie texte.
 		 */
+		virtual inline void toString(std::string &string) const;
+		virtual inline void toString(std::string &string, int precision, int width, char separator) const;
 		virtual inline void toString(std::string &string);
 		virtual inline void toString(std::string &string, int precision, int width, char separator);
 		/* FIXME
@@ -167,6 +184,20 @@ inline T SystemStates<T>::operator[](const size_type index) const
 
 
 
+template<typename T>
+inline T* SystemStates<T>::data(void)
+{
+	return this->mx.empty() ? NULL : &this->mx[0];
+}
+
+template<typename T>
+inline const T* SystemStates<T>::data(void) const
+{
+	return this->mx.empty() ? NULL : &this->mx[0];
+}
+
+
+
 template<typename T>
 inline long SystemStates<T>::size(void) const
 {
@@ -238,14 +269,28 @@ inline bool SystemStates<T>::operator!=(SystemStates<T> const &other) const
 /* Affichage */
 
 template<typename T>
-inline void SystemStates<T>::toString(std::string &string)
+inline void SystemStates<T>::toString(std::string &string) const
 {
 	this->toString(string,2,6,' ');
 	return;
 }
 
 template<typename T>
-inline void SystemStates<T>::toString(std::string &string, int precision, int width , char separator = ' ')
+inline void SystemStates<T>::toString(std::string &string)
+{
+	static_cast<const SystemStates<T>*>(this)->toString(string);
+	return;
+}
+
+template<typename T>
+inline void SystemStates<T>::toString(std::string &string, int precision, int width, char separator)
+{
+	static_cast<const SystemStates<T>*>(this)->toString(string, precision, width, separator);
+	return;
+}
+
+template<typename T>
+inline void SystemStates<T>::toString(std::string &string, int precision, int width , char separator = ' ') const
 /*    Ajoute les élements de l'objet SystemStates à la chaine de caractère
  * "string". Les éléments sont ajouter les uns à la suite des autres en
  * commençant par les éléments de x puis en terminant avec les élements de y.
@@ -258,13 +303,8 @@ inline void SystemStates<T>::toString(std::string &string, int precision, int wi
  * "separator". Par défaut, le séparateur utilisé est l'espace ' '.
  */
 {
-
-	std::ostringstream oss;
 	size_type i;
 
-	oss.setf(std::ios::fixed, std::ios::floatfield);
-	oss.setf(std::ios::left, std::ios::adjustfield);
-
 	if ( (this->size() <= 0) && (this->size() <= 0) )
 	{
 		return;
@@ -277,19 +317,12 @@ inline void SystemStates<T>::toString(std::string &string, int precision, int wi
 
 	if (this->size() > 0)
 	{
-		oss.precision(precision);
-		oss.width(width);
-		oss << this->at(0);
-		string += oss.str();
-		oss.str("");
+		TextFormat::append(string, this->at(0), precision, width);
 
 		for(i = 1; i < this->size(); ++i)
 		{
-			oss.precision(precision);
-			oss.width(width);
-			oss << this->at(i);
-			string += separator + oss.str();
-			oss.str("");
+			string += separator;
+			TextFormat::append(string, this->at(i), precision, width);
 		}
 	}
 	
@@ -0,0 +1,285 @@
+#ifndef __TEXTFORMAT_HPP__
+#define __TEXTFORMAT_HPP__
+
+/* 	TextFormat.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Écriture rapide de nombres sous forme de texte, sans allocation (hors
+ * agrandissement du tampon) et sans passer par les flux (std::ostream).
+ *		Les nombres sont ajoutés à la fin d'une chaîne de caractères réutilisée
+ * d'un appel à l'autre :
+ *		- "precision" >= 0 : notation fixe avec "precision" chiffres après la
+ *		  virgule (identique à std::ios::fixed) ;
+ *		- "precision" < 0 : écriture la plus courte permettant de relire
+ *		  exactement la valeur ("shortest round-trip").
+ *		La valeur est alignée à gauche et complétée par des espaces jusqu'à
+ * "width" caractères (identique à std::ios::left).
+ *		Le résultat ne dépend pas de la "locale" : il est identique d'une
+ * machine à l'autre.
+ *
+ *		Les types flottants et entiers utilisent std::to_chars (ou snprintf si
+ * la bibliothèque standard ne le fournit pas). Les autres types passent par
+ * l'opérateur << (voir SystemStates.hpp).
+ *
+ */
+
+#include <stdio.h>
+
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+class TextFormat
+{
+	protected:
+		static inline bool fixed(char *first, char *last, const double value, const int precision, size_t &length);
+
+		template<typename U>
+		static inline bool put(std::string &out, const size_t pos, const U value, const int precision, size_t &length, std::true_type);
+		template<typename U>
+		static inline bool put(std::string &out, const size_t pos, const U value, const int precision, size_t &length, std::false_type);
+
+	public:
+		template<typename U>
+		static inline typename std::enable_if<std::is_arithmetic<U>::value && !std::is_same<U, bool>::value>::type append(std::string &out, const U value, const int precision, const int width);
+
+		template<typename U>
+		static inline typename std::enable_if<!std::is_arithmetic<U>::value || std::is_same<U, bool>::value>::type append(std::string &out, const U &value, const int precision, const int width);
+};
+
+inline bool TextFormat::fixed(char *first, char *last, const double value, const int precision, size_t &length)
+/*    Voie rapide de la notation fixe pour les valeurs "raisonnables" : la valeur
+ * est multipliée par 10^precision puis arrondie à l'entier le plus proche et
+ * écrite comme un entier. Le produit n'étant pas exact, l'arrondi n'est retenu
+ * que si la partie fractionnaire est loin de 0.5 (au-delà de l'erreur du
+ * produit) ; sinon (ou pour les valeurs trop grandes, infinies ou NaN) renvoie
+ * false et la conversion exacte est utilisée. Le résultat est donc toujours
+ * identique à celui de std::ios::fixed.
+ */
+{
+	static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+	char digits[24];
+	double scaled, rounded, error;
+	unsigned long long integer;
+	int n = 0, i;
+	char *p = first;
+
+	if ( (precision < 0) || (precision > 15) )
+	{
+		return false;
+	}
+
+	scaled = (value < 0.0 ? -value : value) * powers[precision];
+	if ( !(scaled < 4.0e15) )	// Faux aussi pour NaN.
+	{
+		return false;
+	}
+
+	rounded = (double)(unsigned long long)(scaled + 0.5);
+	error = scaled * 2.3e-16;	// Majorant de l'erreur du produit (et de "scaled + 0.5").
+	if ( ((rounded - scaled) - 0.5 > -error) && ((rounded - scaled) - 0.5 < error) )
+	{
+		return false;
+	}
+	if ( ((scaled - rounded) - 0.5 > -error) && ((scaled - rounded) - 0.5 < error) )
+	{
+		return false;
+	}
+	integer = (unsigned long long)rounded;
+
+	do
+	{
+		digits[n++] = (char)('0' + integer % 10);
+		integer /= 10;
+	} while ( (integer > 0) || (n <= precision) );
+
+	if (last - first < n + 2)
+	{
+		return false;
+	}
+
+	if ( (value < 0.0) || ((value == 0.0) && (1.0 / value < 0.0)) )
+	{
+		*p++ = '-';
+	}
+	for (i = n - 1; i >= precision; --i)
+	{
+		*p++ = digits[i];
+	}
+	if (precision > 0)
+	{
+		*p++ = '.';
+		for (; i >= 0; --i)
+		{
+			*p++ = digits[i];
+		}
+	}
+
+	length = p - first;
+	return true;
+}
+
+template<typename U>
+inline bool TextFormat::put(std::string &out, const size_t pos, const U value, const int precision, size_t &length, std::true_type)
+/*    Écrit le flottant "value" à partir de "out[pos]". Renvoie false si la place
+ * disponible ne suffit pas.
+ */
+{
+	char *first = &out[pos];
+	char *last = &out[0] + out.size();
+
+	if ( (sizeof(U) <= sizeof(double)) && fixed(first, last, (double)value, precision, length) )
+	{
+		return true;
+	}
+
+#if defined(__cpp_lib_to_chars)
+	std::to_chars_result result;
+
+	if (precision >= 0)
+	{
+		result = std::to_chars(first, last, value, std::chars_format::fixed, precision);
+	}
+	else
+	{
+		result = std::to_chars(first, last, value);
+	}
+	if (result.ec != std::errc())
+	{
+		return false;
+	}
+	length = result.ptr - first;
+	return true;
+#else
+	int n;
+
+	if (precision >= 0)
+	{
+		n = snprintf(first, last - first, "%.*Lf", precision, (long double)value);
+	}
+	else
+	{
+		n = snprintf(first, last - first, "%.*Lg", std::numeric_limits<U>::max_digits10, (long double)value);
+	}
+	if ( (n < 0) || (n >= last - first) )
+	{
+		return false;
+	}
+	length = n;
+	return true;
+#endif
+}
+
+template<typename U>
+inline bool TextFormat::put(std::string &out, const size_t pos, const U value, const int, size_t &length, std::false_type)
+/*    Écrit l'entier "value" à partir de "out[pos]".
+ */
+{
+	char *first = &out[pos];
+	char *last = &out[0] + out.size();
+
+#if defined(__cpp_lib_to_chars)
+	std::to_chars_result result = std::to_chars(first, last, value);
+
+	if (result.ec != std::errc())
+	{
+		return false;
+	}
+	length = result.ptr - first;
+	return true;
+#else
+	int n;
+
+	if (std::is_signed<U>::value)
+	{
+		n = snprintf(first, last - first, "%lld", (long long)value);
+	}
+	else
+	{
+		n = snprintf(first, last - first, "%llu", (unsigned long long)value);
+	}
+	if ( (n < 0) || (n >= last - first) )
+	{
+		return false;
+	}
+	length = n;
+	return true;
+#endif
+}
+
+template<typename U>
+inline typename std::enable_if<std::is_arithmetic<U>::value && !std::is_same<U, bool>::value>::type TextFormat::append(std::string &out, const U value, const int precision, const int width)
+{
+	const size_t pos = out.size();
+	size_t room = 64 + ( (precision > 0) ? precision : 0 );
+	size_t length = 0;
+
+	out.resize(pos + room);
+	while (!put(out, pos, value, precision, length, typename std::is_floating_point<U>::type()))
+	{
+		// Très grands nombres en notation fixe (jusqu'à ~5000 chiffres).
+		room *= 4;
+		out.resize(pos + room);
+	}
+	out.resize(pos + length);
+
+	if ((int)length < width)
+	{
+		out.append(width - length, ' ');
+	}
+	return;
+}
+
+template<typename U>
+inline typename std::enable_if<!std::is_arithmetic<U>::value || std::is_same<U, bool>::value>::type TextFormat::append(std::string &out, const U &value, const int precision, const int width)
+{
+	std::ostringstream oss;
+
+	oss.setf(std::ios::left, std::ios::adjustfield);
+	if (precision >= 0)
+	{
+		oss.setf(std::ios::fixed, std::ios::floatfield);
+		oss.precision(precision);
+	}
+	oss.width(width);
+	oss << value;
+	out += oss.str();
+	return;
+}
+
+
+#endif
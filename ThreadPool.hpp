@@ -0,0 +1,206 @@
+#ifndef __THREADPOOL_HPP__
+#define __THREADPOOL_HPP__
+
+/* 	ThreadPool.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Groupe de tâches de fond (std::thread) réutilisées d'un calcul à
+ * l'autre. "run(ntasks, job)" exécute job(task, worker) pour chaque tâche
+ * 0 <= task < ntasks et attend la fin de toutes les tâches. Les tâches sont
+ * distribuées dynamiquement (compteur atomique) : une tâche longue n'en bloque
+ * pas d'autres. "worker" (0 <= worker < size()) identifie la tâche de fond,
+ * ce qui permet d'associer à chacune son propre espace de travail (système,
+ * intégrateur, etc.).
+ *
+ *		La première exception levée par une tâche est relancée par "run" (les
+ * tâches non commencées sont alors abandonnées).
+ *
+ */
+
+#include <stddef.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+	protected:
+		std::vector<std::thread> threads;
+
+		std::mutex mutex;
+		std::condition_variable start, done;
+
+		std::function<void(size_t, size_t)> job;
+		size_t ntasks;
+		std::atomic<size_t> nexttask;
+		size_t active;						// Tâches de fond occupées.
+		unsigned long generation;			// Numéro du calcul en cours.
+		bool stopping;
+		std::exception_ptr error;
+
+		void work(const size_t worker);
+
+	public:
+		ThreadPool(size_t nthreads = 0);
+		virtual ~ThreadPool(void);
+
+		inline size_t size(void) const;
+
+		void run(const size_t ntasks, const std::function<void(size_t task, size_t worker)> &job);
+};
+
+inline ThreadPool::ThreadPool(size_t nthreads)
+/*    nthreads = 0 : une tâche de fond par cœur.
+ */
+{
+	if (nthreads == 0)
+	{
+		nthreads = std::thread::hardware_concurrency();
+		if (nthreads == 0)
+		{
+			nthreads = 1;
+		}
+	}
+	this->ntasks = 0;
+	this->nexttask = 0;
+	this->active = 0;
+	this->generation = 0;
+	this->stopping = false;
+	for (size_t i = 0; i < nthreads; ++i)
+	{
+		this->threads.push_back(std::thread(&ThreadPool::work, this, i));
+	}
+	return;
+}
+
+inline ThreadPool::~ThreadPool(void)
+{
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->start.notify_all();
+	for (size_t i = 0; i < this->threads.size(); ++i)
+	{
+		this->threads[i].join();
+	}
+	return;
+}
+
+inline size_t ThreadPool::size(void) const
+{
+	return this->threads.size();
+}
+
+inline void ThreadPool::work(const size_t worker)
+{
+	unsigned long seen = 0;
+	size_t task;
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true)
+	{
+		while ( (this->generation == seen) && !this->stopping )
+		{
+			this->start.wait(lock);
+		}
+		if (this->stopping)
+		{
+			return;
+		}
+		seen = this->generation;
+		lock.unlock();
+
+		while ( (task = this->nexttask.fetch_add(1)) < this->ntasks )
+		{
+			try
+			{
+				this->job(task, worker);
+			}
+			catch (...)
+			{
+				std::unique_lock<std::mutex> guard(this->mutex);
+				if (!this->error)
+				{
+					this->error = std::current_exception();
+				}
+				this->nexttask = this->ntasks;	// Abandon des tâches restantes.
+			}
+		}
+
+		lock.lock();
+		if (--this->active == 0)
+		{
+			this->done.notify_all();
+		}
+	}
+}
+
+inline void ThreadPool::run(const size_t ntasks, const std::function<void(size_t task, size_t worker)> &job)
+{
+	std::exception_ptr error;
+
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->job = job;
+		this->ntasks = ntasks;
+		this->nexttask = 0;
+		this->active = this->threads.size();
+		this->error = std::exception_ptr();
+		++this->generation;
+	}
+	this->start.notify_all();
+
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		while (this->active > 0)
+		{
+			this->done.wait(lock);
+		}
+		error = this->error;
+		this->error = std::exception_ptr();
+		this->job = std::function<void(size_t, size_t)>();
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+	return;
+}
+
+
+#endif
@@ -0,0 +1,828 @@
+#ifndef __TOPOLOGY_HPP__
+#define __TOPOLOGY_HPP__
+
+/* 	Topology.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Topologie d'un réseau : graphe orienté à "size()" nœuds stocké sous
+ * forme compacte (CSR) par nœud de destination. L'arc i -> j signifie que le
+ * nœud j reçoit une connexion venant de i ; les arcs arrivant au nœud j sont
+ * les arcs first(j) <= e < last(j), de source "source(e)" et de poids
+ * "weight(e)" (1 si la topologie n'est pas pondérée). Un graphe non orienté
+ * contient les deux arcs de chaque arête. Voir NetworkBuilder.hpp pour
+ * construire le réseau correspondant.
+ *
+ *		Générateurs (graphes non orientés, sans boucle ni arête multiple) :
+ *		- ring(n), lattice(n, k) : anneau, chaque nœud relié à ses k plus
+ *		  proches voisins de chaque côté ;
+ *		- grid(nx, ny[, nz], periodic) : grille 2-D ou 3-D (4 ou 6 voisins),
+ *		  éventuellement torique ;
+ *		- wattsstrogatz(n, k, p, seed) : anneau "lattice(n, k)" dont chaque
+ *		  arête est recâblée avec la probabilité p (petit monde) ;
+ *		- barabasialbert(n, m, seed) : attachement préférentiel, chaque
+ *		  nouveau nœud est relié à m nœuds existants ;
+ *		- erdosrenyi(n, p, seed) : chaque arête existe avec la probabilité p
+ *		  (tirage par sauts géométriques, en O(n + arêtes)).
+ *		Les générateurs aléatoires sont reproductibles (même graphe pour une
+ * même graine, quelle que soit la bibliothèque standard).
+ *
+ *		"readedges" lit une liste d'arcs texte, en flux (par blocs, sans
+ * charger le fichier en mémoire) : une ligne "source destination [poids]" par
+ * arc, les lignes vides ou commençant par '#' ou '%' sont ignorées. "write" et
+ * "read" écrivent et relisent (par projection en mémoire) la forme compacte
+ * (petit-boutiste) :
+ *		 0	char[8]		"SYSSIMTP"
+ *		 8	uint32		version
+ *		12	uint32		code du type des poids (voir BinaryType)
+ *		16	uint32		taille (octets) d'un poids
+ *		20	uint32		drapeaux (1 : pondérée)
+ *		24	uint64		nombre de nœuds n
+ *		32	uint64		nombre d'arcs m
+ *		40	uint64[n+1]	positions des arcs de chaque nœud, puis uint64[m]
+ *						sources, puis T[m] poids (si pondérée).
+ *
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryFormat.hpp"
+
+template<typename T>
+class Topology
+{
+	public:
+		typedef uint64_t index_type;
+
+		static const uint32_t version = 1;
+		static const size_t headersize = 40;
+
+	protected:
+		index_type n;
+		std::vector<uint64_t> offsets;
+		std::vector<index_type> sources;
+		std::vector<T> weights;				// Vide : poids 1.
+
+		class Random
+		{
+			protected:
+				std::mt19937_64 generator;
+			public:
+				Random(const uint64_t seed):generator(seed){};
+				inline double uniform(void)
+				{
+					return (double)(this->generator() >> 11) * (1.0 / 9007199254740992.0);
+				};
+				inline index_type below(const index_type n)
+				{
+					return (index_type)(this->generator() % n);
+				};
+		};
+
+		static inline void edge(std::vector<index_type> &from, std::vector<index_type> &to, const index_type a, const index_type b);
+		static Topology<T> grid(const std::vector<index_type> &dimensions, const bool periodic);
+		static void parseline(char *line, const unsigned long number, std::vector<index_type> &from, std::vector<index_type> &to, std::vector<T> &weights, index_type &largest);
+
+	public:
+		Topology(void);
+		Topology(const index_type nodes, const std::vector<index_type> &from, const std::vector<index_type> &to, const std::vector<T> &weights = std::vector<T>());
+		virtual ~Topology(void){};
+
+		void assign(const index_type nodes, const std::vector<index_type> &from, const std::vector<index_type> &to, const std::vector<T> &weights = std::vector<T>());
+
+		inline index_type size(void) const;
+		inline uint64_t edges(void) const;
+		inline bool weighted(void) const;
+
+		inline uint64_t first(const index_type node) const;
+		inline uint64_t last(const index_type node) const;
+		inline index_type indegree(const index_type node) const;
+		inline index_type source(const uint64_t e) const;
+		inline T weight(const uint64_t e) const;
+
+		static Topology<T> ring(const index_type n);
+		static Topology<T> lattice(const index_type n, const index_type k);
+		static Topology<T> grid(const index_type nx, const index_type ny, const bool periodic = false);
+		static Topology<T> grid(const index_type nx, const index_type ny, const index_type nz, const bool periodic = false);
+		static Topology<T> wattsstrogatz(const index_type n, const index_type k, const double p, const uint64_t seed = 0);
+		static Topology<T> barabasialbert(const index_type n, const index_type m, const uint64_t seed = 0);
+		static Topology<T> erdosrenyi(const index_type n, const double p, const uint64_t seed = 0);
+
+		void readedges(std::istream &istream, const index_type nodes = 0);
+		void readedges(const std::string &path, const index_type nodes = 0);
+
+		void write(std::ostream &ostream) const;
+		void write(const std::string &path) const;
+		void read(const std::string &path);
+};
+
+template<typename T>
+Topology<T>::Topology(void)
+{
+	this->n = 0;
+	this->offsets.assign(1, 0);
+	return;
+}
+
+template<typename T>
+Topology<T>::Topology(const index_type nodes, const std::vector<index_type> &from, const std::vector<index_type> &to, const std::vector<T> &weights)
+{
+	this->assign(nodes, from, to, weights);
+	return;
+}
+
+template<typename T>
+void Topology<T>::assign(const index_type nodes, const std::vector<index_type> &from, const std::vector<index_type> &to, const std::vector<T> &weights)
+/*    Tri par dénombrement selon la destination (stable : l'ordre des arcs
+ * d'un même nœud est celui de la liste).
+ */
+{
+	std::vector<uint64_t> position;
+
+	if ( (from.size() != to.size()) || (!weights.empty() && (weights.size() != from.size())) )
+	{
+		throw std::invalid_argument("Topology::assign : size mismatch");
+	}
+	for (size_t e = 0; e < from.size(); ++e)
+	{
+		if ( (from[e] >= nodes) || (to[e] >= nodes) )
+		{
+			throw std::out_of_range("Topology::assign : node index");
+		}
+	}
+
+	this->n = nodes;
+	this->offsets.assign(nodes + 1, 0);
+	for (size_t e = 0; e < to.size(); ++e)
+	{
+		++this->offsets[to[e] + 1];
+	}
+	for (index_type i = 0; i < nodes; ++i)
+	{
+		this->offsets[i+1] += this->offsets[i];
+	}
+
+	position.assign(this->offsets.begin(), this->offsets.end() - 1);
+	this->sources.resize(from.size());
+	this->weights.resize(weights.size());
+	for (size_t e = 0; e < from.size(); ++e)
+	{
+		const uint64_t k = position[to[e]]++;
+
+		this->sources[k] = from[e];
+		if (!weights.empty())
+		{
+			this->weights[k] = weights[e];
+		}
+	}
+	return;
+}
+
+
+
+template<typename T>
+inline typename Topology<T>::index_type Topology<T>::size(void) const
+{
+	return this->n;
+}
+
+template<typename T>
+inline uint64_t Topology<T>::edges(void) const
+{
+	return this->sources.size();
+}
+
+template<typename T>
+inline bool Topology<T>::weighted(void) const
+{
+	return !this->weights.empty();
+}
+
+template<typename T>
+inline uint64_t Topology<T>::first(const index_type node) const
+{
+	return this->offsets[node];
+}
+
+template<typename T>
+inline uint64_t Topology<T>::last(const index_type node) const
+{
+	return this->offsets[node+1];
+}
+
+template<typename T>
+inline typename Topology<T>::index_type Topology<T>::indegree(const index_type node) const
+{
+	return (index_type)(this->offsets[node+1] - this->offsets[node]);
+}
+
+template<typename T>
+inline typename Topology<T>::index_type Topology<T>::source(const uint64_t e) const
+{
+	return this->sources[e];
+}
+
+template<typename T>
+inline T Topology<T>::weight(const uint64_t e) const
+{
+	return this->weights.empty() ? (T)1 : this->weights[e];
+}
+
+
+
+template<typename T>
+inline void Topology<T>::edge(std::vector<index_type> &from, std::vector<index_type> &to, const index_type a, const index_type b)
+/*    Arête non orientée : les deux arcs.
+ */
+{
+	from.push_back(a);
+	to.push_back(b);
+	from.push_back(b);
+	to.push_back(a);
+	return;
+}
+
+template<typename T>
+Topology<T> Topology<T>::ring(const index_type n)
+{
+	return lattice(n, 1);
+}
+
+template<typename T>
+Topology<T> Topology<T>::lattice(const index_type n, const index_type k)
+{
+	std::vector<index_type> from, to;
+
+	if (2 * k >= n)
+	{
+		throw std::invalid_argument("Topology::lattice : 2 k must be smaller than n");
+	}
+	from.reserve(2 * n * k);
+	to.reserve(2 * n * k);
+	for (index_type i = 0; i < n; ++i)
+	{
+		for (index_type j = 1; j <= k; ++j)
+		{
+			edge(from, to, i, (i + j) % n);
+		}
+	}
+	return Topology<T>(n, from, to);
+}
+
+template<typename T>
+Topology<T> Topology<T>::grid(const std::vector<index_type> &dimensions, const bool periodic)
+/*    Nœud (x0, x1, ...) d'indice x0 + d0 (x1 + d1 (...)), relié à son voisin
+ * suivant dans chaque dimension. Une dimension de taille 2 n'est pas
+ * refermée (l'arête existerait deux fois).
+ */
+{
+	std::vector<index_type> from, to;
+	std::vector<index_type> stride(dimensions.size());
+	index_type n = 1;
+
+	for (size_t d = 0; d < dimensions.size(); ++d)
+	{
+		stride[d] = n;
+		n *= dimensions[d];
+	}
+	from.reserve(2 * n * dimensions.size());
+	to.reserve(2 * n * dimensions.size());
+	for (index_type i = 0; i < n; ++i)
+	{
+		for (size_t d = 0; d < dimensions.size(); ++d)
+		{
+			const index_type x = (i / stride[d]) % dimensions[d];
+
+			if (x + 1 < dimensions[d])
+			{
+				edge(from, to, i, i + stride[d]);
+			}
+			else if (periodic && (dimensions[d] > 2))
+			{
+				edge(from, to, i, i - x * stride[d]);
+			}
+		}
+	}
+	return Topology<T>(n, from, to);
+}
+
+template<typename T>
+Topology<T> Topology<T>::grid(const index_type nx, const index_type ny, const bool periodic)
+{
+	std::vector<index_type> dimensions(2);
+
+	dimensions[0] = nx;
+	dimensions[1] = ny;
+	return grid(dimensions, periodic);
+}
+
+template<typename T>
+Topology<T> Topology<T>::grid(const index_type nx, const index_type ny, const index_type nz, const bool periodic)
+{
+	std::vector<index_type> dimensions(3);
+
+	dimensions[0] = nx;
+	dimensions[1] = ny;
+	dimensions[2] = nz;
+	return grid(dimensions, periodic);
+}
+
+template<typename T>
+Topology<T> Topology<T>::wattsstrogatz(const index_type n, const index_type k, const double p, const uint64_t seed)
+/*    Pour j = 1..k puis pour chaque nœud i, l'arête (i, i + j) est remplacée
+ * avec la probabilité p par une arête (i, c), c tiré uniformément parmi les
+ * nœuds qui ne sont pas déjà voisins de i.
+ */
+{
+	std::vector< std::vector<index_type> > neighbours(n);
+	std::vector<index_type> from, to;
+	Random random(seed);
+
+	if (2 * k >= n)
+	{
+		throw std::invalid_argument("Topology::wattsstrogatz : 2 k must be smaller than n");
+	}
+	for (index_type i = 0; i < n; ++i)
+	{
+		neighbours[i].reserve(2 * k);
+	}
+	for (index_type i = 0; i < n; ++i)
+	{
+		for (index_type j = 1; j <= k; ++j)
+		{
+			neighbours[i].push_back((i + j) % n);
+			neighbours[(i + j) % n].push_back(i);
+		}
+	}
+
+	for (index_type j = 1; j <= k; ++j)
+	{
+		for (index_type i = 0; i < n; ++i)
+		{
+			const index_type b = (i + j) % n;
+			std::vector<index_type> &ni = neighbours[i];
+			std::vector<index_type> &nb = neighbours[b];
+			index_type c;
+
+			if ( (random.uniform() >= p) || (ni.size() + 1 >= n) )
+			{
+				continue;
+			}
+			if (std::find(ni.begin(), ni.end(), b) == ni.end())
+			{
+				continue;	// Arête déjà recâblée depuis b.
+			}
+			do
+			{
+				c = random.below(n);
+			} while ( (c == i) || (std::find(ni.begin(), ni.end(), c) != ni.end()) );
+
+			*std::find(ni.begin(), ni.end(), b) = c;
+			*std::find(nb.begin(), nb.end(), i) = nb.back();
+			nb.pop_back();
+			neighbours[c].push_back(i);
+		}
+	}
+
+	from.reserve(2 * n * k);
+	to.reserve(2 * n * k);
+	for (index_type i = 0; i < n; ++i)
+	{
+		for (size_t j = 0; j < neighbours[i].size(); ++j)
+		{
+			from.push_back(neighbours[i][j]);
+			to.push_back(i);
+		}
+		std::vector<index_type>().swap(neighbours[i]);
+	}
+	return Topology<T>(n, from, to);
+}
+
+template<typename T>
+Topology<T> Topology<T>::barabasialbert(const index_type n, const index_type m, const uint64_t seed)
+/*    Les m premiers nœuds ne sont pas reliés entre eux ; le nœud m est relié
+ * à chacun d'eux. Ensuite, chaque nœud choisit m nœuds distincts avec une
+ * probabilité proportionnelle à leur degré (tirage dans la liste des
+ * extrémités de toutes les arêtes).
+ */
+{
+	std::vector<index_type> from, to;
+	std::vector<index_type> ends, targets;
+	Random random(seed);
+
+	if ( (m < 1) || (m >= n) )
+	{
+		throw std::invalid_argument("Topology::barabasialbert : 1 <= m < n");
+	}
+	from.reserve(2 * m * (n - m));
+	to.reserve(2 * m * (n - m));
+	ends.reserve(2 * m * (n - m));
+	for (index_type i = 0; i < m; ++i)
+	{
+		targets.push_back(i);
+	}
+	for (index_type source = m; source < n; ++source)
+	{
+		for (index_type j = 0; j < m; ++j)
+		{
+			edge(from, to, source, targets[j]);
+			ends.push_back(targets[j]);
+			ends.push_back(source);
+		}
+		targets.clear();
+		while (targets.size() < m)
+		{
+			const index_type c = ends[random.below(ends.size())];
+
+			if (std::find(targets.begin(), targets.end(), c) == targets.end())
+			{
+				targets.push_back(c);
+			}
+		}
+	}
+	return Topology<T>(n, from, to);
+}
+
+template<typename T>
+Topology<T> Topology<T>::erdosrenyi(const index_type n, const double p, const uint64_t seed)
+/*    Méthode de Batagelj et Brandes : on saute directement à la prochaine
+ * arête (v, w), w < v, du triangle inférieur, l'écart suivant une loi
+ * géométrique.
+ */
+{
+	std::vector<index_type> from, to;
+	Random random(seed);
+	double logq;
+	uint64_t v, w;
+
+	if ( (p <= 0.0) || (n < 2) )
+	{
+		return Topology<T>(n, from, to);
+	}
+	if (p < 1.0)
+	{
+		const double expected = p * (double)n * (double)(n - 1);
+
+		from.reserve((size_t)(expected * 1.05) + 16);
+		to.reserve((size_t)(expected * 1.05) + 16);
+	}
+
+	logq = log(1.0 - p);
+	v = 1;
+	w = 0;
+	while (v < n)
+	{
+		if (p < 1.0)
+		{
+			w += (uint64_t)floor(log(1.0 - random.uniform()) / logq);
+		}
+		while ( (w >= v) && (v < n) )
+		{
+			w -= v;
+			++v;
+		}
+		if (v < n)
+		{
+			edge(from, to, v, w);
+			++w;
+		}
+	}
+	return Topology<T>(n, from, to);
+}
+
+
+
+template<typename T>
+void Topology<T>::parseline(char *line, const unsigned long number, std::vector<index_type> &from, std::vector<index_type> &to, std::vector<T> &weights, index_type &largest)
+/*    Les poids ne sont stockés qu'à partir de la première ligne pondérée (les
+ * arcs précédents reçoivent alors le poids 1).
+ */
+{
+	char *end;
+	index_type a, b;
+	T w;
+
+	while ( (*line == ' ') || (*line == '\t') )
+	{
+		++line;
+	}
+	if ( (*line == '\0') || (*line == '\r') || (*line == '#') || (*line == '%') )
+	{
+		return;
+	}
+
+	a = strtoull(line, &end, 10);
+	if (end == line)
+	{
+		throw std::runtime_error("Topology::readedges : syntax error line " + std::to_string(number));
+	}
+	line = end;
+	b = strtoull(line, &end, 10);
+	if (end == line)
+	{
+		throw std::runtime_error("Topology::readedges : syntax error line " + std::to_string(number));
+	}
+	line = end;
+	w = (T)strtod(line, &end);
+	if (end != line)
+	{
+		if (weights.size() < from.size())
+		{
+			weights.resize(from.size(), (T)1);
+		}
+		weights.push_back(w);
+	}
+	else if (!weights.empty())
+	{
+		weights.push_back((T)1);
+	}
+
+	from.push_back(a);
+	to.push_back(b);
+	largest = std::max(largest, std::max(a, b));
+	return;
+}
+
+template<typename T>
+void Topology<T>::readedges(std::istream &istream, const index_type nodes)
+/*    nodes = 0 : le nombre de nœuds est le plus grand indice lu plus un.
+ */
+{
+	std::vector<char> buffer((size_t)1 << 20);
+	std::vector<index_type> from, to;
+	std::vector<T> weights;
+	index_type largest = 0;
+	unsigned long number = 0;
+	size_t kept = 0, begin, got;
+	char *newline;
+
+	while (true)
+	{
+		istream.read(&buffer[kept], (std::streamsize)(buffer.size() - 1 - kept));
+		got = (size_t)istream.gcount();
+		begin = 0;
+		while ( (newline = (char*)memchr(&buffer[begin], '\n', kept + got - begin)) != NULL )
+		{
+			*newline = '\0';
+			parseline(&buffer[begin], ++number, from, to, weights, largest);
+			begin = (size_t)(newline - &buffer[0]) + 1;
+		}
+		kept = kept + got - begin;
+		if (got == 0)
+		{
+			// Dernière ligne sans fin de ligne.
+			if (kept > 0)
+			{
+				buffer[kept] = '\0';
+				parseline(&buffer[0], ++number, from, to, weights, largest);
+			}
+			break;
+		}
+		memmove(&buffer[0], &buffer[begin], kept);
+		if (kept + 1 >= buffer.size())
+		{
+			buffer.resize(2 * buffer.size());	// Ligne plus longue que le tampon.
+		}
+	}
+	if (istream.bad())
+	{
+		throw std::runtime_error("Topology::readedges : read error");
+	}
+
+	this->assign( (nodes > 0) ? nodes : (from.empty() ? 0 : largest + 1), from, to, weights);
+	return;
+}
+
+template<typename T>
+void Topology<T>::readedges(const std::string &path, const index_type nodes)
+{
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+
+	if (!file)
+	{
+		throw std::runtime_error("Topology::readedges : cannot open " + path);
+	}
+	this->readedges(file, nodes);
+	return;
+}
+
+
+
+template<typename T>
+void Topology<T>::write(std::ostream &ostream) const
+/*    Écriture par tampons de 1 Mo.
+ */
+{
+	const size_t chunk = (size_t)1 << 20;
+	std::string buffer;
+
+	buffer.reserve(chunk + 64);
+	buffer.append("SYSSIMTP", 8);
+	BinaryFormat::append(buffer, (uint32_t)version);
+	BinaryFormat::append(buffer, (uint32_t)BinaryType<T>::code);
+	BinaryFormat::append(buffer, (uint32_t)sizeof(T));
+	BinaryFormat::append(buffer, (uint32_t)(this->weighted() ? 1 : 0));
+	BinaryFormat::append(buffer, (uint64_t)this->n);
+	BinaryFormat::append(buffer, (uint64_t)this->sources.size());
+
+	for (size_t i = 0; i < this->offsets.size(); ++i)
+	{
+		BinaryFormat::append(buffer, this->offsets[i]);
+		if (buffer.size() >= chunk)
+		{
+			ostream.write(buffer.data(), (std::streamsize)buffer.size());
+			buffer.clear();
+		}
+	}
+	for (size_t e = 0; e < this->sources.size(); ++e)
+	{
+		BinaryFormat::append(buffer, (uint64_t)this->sources[e]);
+		if (buffer.size() >= chunk)
+		{
+			ostream.write(buffer.data(), (std::streamsize)buffer.size());
+			buffer.clear();
+		}
+	}
+	for (size_t e = 0; e < this->weights.size(); ++e)
+	{
+		BinaryFormat::append(buffer, this->weights[e]);
+		if (buffer.size() >= chunk)
+		{
+			ostream.write(buffer.data(), (std::streamsize)buffer.size());
+			buffer.clear();
+		}
+	}
+	ostream.write(buffer.data(), (std::streamsize)buffer.size());
+	if (!ostream)
+	{
+		throw std::runtime_error("Topology::write");
+	}
+	return;
+}
+
+template<typename T>
+void Topology<T>::write(const std::string &path) const
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+
+	if (!file)
+	{
+		throw std::runtime_error("Topology::write : cannot open " + path);
+	}
+	this->write(file);
+	file.close();
+	if (!file)
+	{
+		throw std::runtime_error("Topology::write : cannot write " + path);
+	}
+	return;
+}
+
+template<typename T>
+void Topology<T>::read(const std::string &path)
+/*    Vérifie l'en-tête, la taille du fichier et la cohérence des positions
+ * et des sources. En cas d'erreur, une exception est levée et l'objet n'est
+ * pas modifié.
+ */
+{
+	struct stat info;
+	const char *data, *p;
+	void *address;
+	uint64_t nodes, m, flags, expected;
+	std::vector<uint64_t> offsets;
+	std::vector<index_type> sources;
+	std::vector<T> weights;
+	int fd;
+
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Topology::read : cannot open " + path);
+	}
+	if ( (fstat(fd, &info) != 0) || ((size_t)info.st_size < headersize) )
+	{
+		::close(fd);
+		throw std::runtime_error("Topology::read : not a topology " + path);
+	}
+	address = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (address == MAP_FAILED)
+	{
+		throw std::runtime_error("Topology::read : cannot map " + path);
+	}
+	data = (const char*)address;
+
+	try
+	{
+		if (memcmp(data, "SYSSIMTP", 8) != 0)
+		{
+			throw std::runtime_error("Topology::read : not a topology " + path);
+		}
+		if ( (BinaryFormat::load<uint32_t>(data + 8) != version) ||
+			 (BinaryFormat::load<uint32_t>(data + 12) != (uint32_t)BinaryType<T>::code) ||
+			 (BinaryFormat::load<uint32_t>(data + 16) != (uint32_t)sizeof(T)) )
+		{
+			throw std::runtime_error("Topology::read : incompatible topology " + path);
+		}
+		flags = BinaryFormat::load<uint32_t>(data + 20);
+		nodes = BinaryFormat::load<uint64_t>(data + 24);
+		m = BinaryFormat::load<uint64_t>(data + 32);
+
+		expected = (uint64_t)(info.st_size - headersize);
+		if ( (nodes >= expected / sizeof(uint64_t)) || (m > expected / sizeof(uint64_t)) ||
+			 (expected != (nodes + 1 + m) * sizeof(uint64_t) + ((flags & 1) ? m * sizeof(T) : 0)) )
+		{
+			throw std::runtime_error("Topology::read : truncated topology " + path);
+		}
+
+		p = data + headersize;
+		offsets.resize(nodes + 1);
+		for (size_t i = 0; i <= nodes; ++i, p += sizeof(uint64_t))
+		{
+			offsets[i] = BinaryFormat::load<uint64_t>(p);
+			if ( (i == 0) ? (offsets[i] != 0) : ((offsets[i] < offsets[i-1]) || (offsets[i] > m)) )
+			{
+				throw std::runtime_error("Topology::read : corrupted topology " + path);
+			}
+		}
+		if (offsets[nodes] != m)
+		{
+			throw std::runtime_error("Topology::read : corrupted topology " + path);
+		}
+		sources.resize(m);
+		for (size_t e = 0; e < m; ++e, p += sizeof(uint64_t))
+		{
+			sources[e] = BinaryFormat::load<uint64_t>(p);
+			if (sources[e] >= nodes)
+			{
+				throw std::runtime_error("Topology::read : corrupted topology " + path);
+			}
+		}
+		if (flags & 1)
+		{
+			weights.resize(m);
+			for (size_t e = 0; e < m; ++e, p += sizeof(T))
+			{
+				weights[e] = BinaryFormat::load<T>(p);
+			}
+		}
+	}
+	catch (...)
+	{
+		munmap(address, (size_t)info.st_size);
+		throw;
+	}
+	munmap(address, (size_t)info.st_size);
+
+	this->n = nodes;
+	this->offsets.swap(offsets);
+	this->sources.swap(sources);
+	this->weights.swap(weights);
+	return;
+}
+
+#endif
@@ -0,0 +1,182 @@
+#ifndef __TOPOLOGYBATCH_HPP__
+#define __TOPOLOGYBATCH_HPP__
+
+/* 	TopologyBatch.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Modification de la topologie d'un réseau pendant une simulation
+ * (réseaux adaptatifs). Les ajouts ("insert") et suppressions ("remove") de
+ * connexions stockées par valeur (voir ConnectionStore.hpp) sont mis en
+ * attente, puis appliqués ensemble par "apply", entre deux pas. Un
+ * TopologyBatch est une opération post-intégration (PrePostOp) : passé à
+ * Simulation::run, il applique les modifications en attente après chaque pas.
+ * Les modifications peuvent donc être demandées de n'importe où (autre
+ * opération, observateur, sortie ; "insert" et "remove" sont protégés par un
+ * verrou).
+ *
+ *		Chaque modification coûte un temps constant (ajout en fin de tableau,
+ * suppression par déplacement de la dernière connexion) : le coût d'une mise à
+ * jour ne dépend que du nombre de modifications, pas de la taille du réseau.
+ *		Les suppressions sont appliquées avant les ajouts. Une connexion déjà
+ * supprimée (même référence demandée deux fois, ou référence périmée dont le
+ * numéro a été réattribué à un ajout suivant) est ignorée. "insert" renvoie
+ * le rang de l'ajout dans le lot : après "apply", "getinserted()[rang]" est la
+ * référence (Handle) de la nouvelle connexion.
+ *
+ */
+
+#include <stddef.h>
+
+#include <mutex>
+#include <vector>
+
+#include "ConnectionStore.hpp"
+#include "Network.hpp"
+#include "PrePostOp.hpp"
+
+template<typename T>
+class TopologyBatch: public PrePostOp<T>
+{
+	public: typedef typename ConnectionStore<T>::Handle Handle;
+
+	protected:
+		ConnectionStore<T> *store;
+
+		ConnectionStore<T> pending;		// Ajouts en attente.
+		std::vector<size_t> order;		// Sorte (dans "pending") de chaque ajout.
+		std::vector<Handle> removals;
+		std::vector<Handle> inserted;
+
+		std::mutex mutex;
+
+	public:
+		TopologyBatch(Network<T> &network);
+		TopologyBatch(ConnectionStore<T> &store);
+		virtual ~TopologyBatch(void){};
+
+		template<typename K> size_t insert(const K &link);
+		void remove(const Handle handle);
+
+		bool empty(void);
+		void apply(void);
+
+		inline const std::vector<Handle> &getinserted(void) const;
+
+		virtual void operator()(Integrator<T> &integrator, SystemStates<T> &states);
+};
+
+template<typename T>
+TopologyBatch<T>::TopologyBatch(Network<T> &network)
+{
+	this->store = &network.getconnections();
+	return;
+}
+
+template<typename T>
+TopologyBatch<T>::TopologyBatch(ConnectionStore<T> &store)
+{
+	this->store = &store;
+	return;
+}
+
+template<typename T>
+template<typename K>
+size_t TopologyBatch<T>::insert(const K &link)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->order.push_back(this->pending.add(link).kind);
+	return this->order.size() - 1;
+}
+
+template<typename T>
+void TopologyBatch<T>::remove(const Handle handle)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->removals.push_back(handle);
+	return;
+}
+
+template<typename T>
+bool TopologyBatch<T>::empty(void)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	return this->order.empty() && this->removals.empty();
+}
+
+template<typename T>
+void TopologyBatch<T>::apply(void)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<size_t> next(this->pending.sizekinds(), 0);
+
+	for (size_t i = 0; i < this->removals.size(); ++i)
+	{
+		if (this->store->valid(this->removals[i]))
+		{
+			this->store->remove(this->removals[i]);
+		}
+	}
+
+	this->inserted.resize(this->order.size());
+	for (size_t i = 0; i < this->order.size(); ++i)
+	{
+		const size_t kind = this->order[i];
+
+		this->inserted[i] = this->pending.transfer(kind, next[kind]++, *this->store);
+	}
+
+	this->removals.clear();
+	this->order.clear();
+	this->pending.clear();
+	return;
+}
+
+template<typename T>
+inline const std::vector<typename TopologyBatch<T>::Handle> &TopologyBatch<T>::getinserted(void) const
+{
+	return this->inserted;
+}
+
+template<typename T>
+void TopologyBatch<T>::operator()(Integrator<T> &, SystemStates<T> &)
+{
+	if (!this->empty())
+	{
+		this->apply();
+	}
+	return;
+}
+
+#endif
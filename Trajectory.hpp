@@ -0,0 +1,339 @@
+#ifndef __TRAJECTORY_HPP__
+#define __TRAJECTORY_HPP__
+
+/* 	Trajectory.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Itération à la demande sur la trajectoire d'une simulation : au lieu de
+ * pousser les échantillons vers une sortie (Simulation::run), l'appelant les
+ * tire un par un. L'intégration n'avance que jusqu'à l'échantillon demandé.
+ *
+ *		Trajectory<double> trajectory(sim, ti, tf);
+ *		trajectory.every(10);				// ou trajectory.interval(0.5);
+ *		for (Trajectory<double>::iterator it = trajectory.begin(); it != trajectory.end(); ++it)
+ *		{
+ *			... it->t, it->x[0], it->x[1] ...
+ *		}
+ *
+ *		Comme pour "run", les pas tels que t < ti ne sont pas échantillonnés
+ * (transitoire, voir Simulation::runtransiant), puis un échantillon est
+ * produit au premier pas puis tous les k pas ("every") ou tous les dt en temps
+ * de simulation ("interval"), tant que t < tf. Avec "every(k)", les
+ * échantillons sont ceux qu'écrirait "run" avec writingstep(k).
+ *
+ *		Un échantillon (TrajectorySample) ne copie rien : "x" pointe directement
+ * sur les états du système et n'est valide que jusqu'à l'échantillon suivant.
+ *
+ */
+
+#include <math.h>
+
+#include <iterator>
+#include <typeinfo>
+
+#include "PrePostOp.hpp"
+#include "Simulation.hpp"
+#include "SimulationPredicate.hpp"
+#include "SystemStates.hpp"
+
+template<typename T>
+struct TrajectorySample
+{
+	typedef typename SystemStates<T>::size_type size_type;
+
+	T t;
+	const T *x;
+	size_type size;
+
+	inline T operator[](const size_type index) const
+	{
+		return this->x[index];
+	}
+};
+
+
+
+template<typename T>
+class Trajectory
+{
+	public: typedef typename SystemStates<T>::size_type size_type;
+
+	protected:
+		Simulation<T> *simulation;
+		PrePostOp<T> *preop, *postop;
+
+		T ti, tf;
+
+		unsigned long stride, count;
+		T dt, tfirst, tnext;
+		unsigned long nsamples;
+
+		bool started, finished;
+		TrajectorySample<T> sample;
+
+		/* Transitoire : t < ti. */
+		class Before: public SimulationPredicate<T>
+		{
+			protected:
+				Simulation<T> *simulation;
+				T ti;
+			public:
+				Before(Simulation<T> *simulation, const T ti):simulation(simulation), ti(ti){};
+				bool test(void)
+				{
+					return (this->simulation->getTime() < this->ti);
+				};
+				bool fingerprint(Fingerprint &fingerprint) const
+				{
+					if (typeid(*this) != typeid(Before))
+					{
+						return false;
+					}
+					fingerprint.add(typeid(*this).name());
+					fingerprint.add(this->ti);
+					return true;
+				};
+				bool deadline(T &t) const
+				{
+					t = this->ti;
+					return true;
+				};
+		};
+
+		inline bool due(void);
+		inline void step(void);
+		inline void update(void);
+
+	public:
+		class iterator
+		{
+			protected:
+				Trajectory<T> *trajectory;
+
+			public:
+				typedef std::input_iterator_tag iterator_category;
+				typedef TrajectorySample<T> value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef const TrajectorySample<T>* pointer;
+				typedef const TrajectorySample<T>& reference;
+
+				iterator(Trajectory<T> *trajectory = NULL):trajectory(trajectory){};
+
+				inline reference operator*(void) const {return this->trajectory->current();};
+				inline pointer operator->(void) const {return &this->trajectory->current();};
+
+				inline iterator& operator++(void)
+				{
+					if (!this->trajectory->next())
+					{
+						this->trajectory = NULL;
+					}
+					return *this;
+				};
+
+				inline bool operator==(const iterator &other) const {return this->trajectory == other.trajectory;};
+				inline bool operator!=(const iterator &other) const {return this->trajectory != other.trajectory;};
+		};
+
+		Trajectory(Simulation<T> &simulation, const T ti, const T tf);
+		Trajectory(Simulation<T> &simulation, const T ti, const T tf, PrePostOp<T> &preop, PrePostOp<T> &postop);
+		virtual ~Trajectory(void){};
+
+		inline void every(const unsigned long k);
+		inline void interval(const T dt);
+
+		bool next(void);
+		inline const TrajectorySample<T> &current(void) const;
+
+		iterator begin(void);
+		inline iterator end(void);
+};
+
+template<typename T>
+Trajectory<T>::Trajectory(Simulation<T> &simulation, const T ti, const T tf)
+{
+	this->simulation = &simulation;
+	this->preop = NULL;
+	this->postop = NULL;
+	this->ti = ti;
+	this->tf = tf;
+	this->every(1);
+	this->started = false;
+	this->finished = false;
+	return;
+}
+
+template<typename T>
+Trajectory<T>::Trajectory(Simulation<T> &simulation, const T ti, const T tf, PrePostOp<T> &preop, PrePostOp<T> &postop)
+{
+	this->simulation = &simulation;
+	this->preop = &preop;
+	this->postop = &postop;
+	this->ti = ti;
+	this->tf = tf;
+	this->every(1);
+	this->started = false;
+	this->finished = false;
+	return;
+}
+
+template<typename T>
+inline void Trajectory<T>::every(const unsigned long k)
+{
+	this->stride = (k > 0) ? k : 1;
+	this->dt = (T)0;
+	return;
+}
+
+template<typename T>
+inline void Trajectory<T>::interval(const T dt)
+/*    Un échantillon au premier pas tel que t >= t0 + n dt (t0 : premier
+ * échantillon). dt <= 0 revient à every(1).
+ */
+{
+	this->stride = 1;
+	this->dt = (dt > (T)0) ? dt : (T)0;
+	return;
+}
+
+
+
+template<typename T>
+inline void Trajectory<T>::step(void)
+{
+	if (this->preop != NULL)
+	{
+		this->simulation->step(*this->preop, *this->postop);
+	}
+	else
+	{
+		this->simulation->step();
+	}
+	return;
+}
+
+template<typename T>
+inline bool Trajectory<T>::due(void)
+{
+	if (this->dt <= (T)0)
+	{
+		return (++this->count % this->stride == 0);
+	}
+	if (this->simulation->getTime() < this->tnext - this->dt * (T)1e-9)
+	{
+		return false;
+	}
+	this->nsamples = (unsigned long)floor((double)((this->simulation->getTime() - this->tfirst) / this->dt) + 1e-9) + 1;
+	this->tnext = this->tfirst + (T)this->nsamples * this->dt;
+	return true;
+}
+
+template<typename T>
+inline void Trajectory<T>::update(void)
+{
+	DynamicalSystem<T> &system = this->simulation->getdynamicalsystem();
+
+	this->sample.t = this->simulation->getTime();
+	this->sample.x = system.data();
+	this->sample.size = system.size();
+	return;
+}
+
+template<typename T>
+bool Trajectory<T>::next(void)
+/*    Avance jusqu'à l'échantillon suivant. Renvoie false à la fin de la
+ * trajectoire (t >= tf).
+ */
+{
+	if (this->finished)
+	{
+		return false;
+	}
+
+	if (!this->started)
+	{
+		this->started = true;
+		Before transiant(this->simulation, this->ti);
+		this->simulation->runtransiant(transiant);
+		this->count = 0;
+		this->tfirst = this->simulation->getTime();
+		this->tnext = this->tfirst + this->dt;
+	}
+	else
+	{
+		do
+		{
+			this->step();
+			if (!(this->simulation->getTime() < this->tf))
+			{
+				break;
+			}
+		}
+		while (!this->due());
+	}
+
+	if (!(this->simulation->getTime() < this->tf))
+	{
+		this->finished = true;
+		return false;
+	}
+	this->update();
+	return true;
+}
+
+template<typename T>
+inline const TrajectorySample<T>& Trajectory<T>::current(void) const
+{
+	return this->sample;
+}
+
+template<typename T>
+typename Trajectory<T>::iterator Trajectory<T>::begin(void)
+/*    Produit le premier échantillon (si ce n'est déjà fait). Une trajectoire
+ * ne se parcourt qu'une fois.
+ */
+{
+	if (!this->started)
+	{
+		this->next();
+	}
+	return iterator(this->finished ? NULL : this);
+}
+
+template<typename T>
+inline typename Trajectory<T>::iterator Trajectory<T>::end(void)
+{
+	return iterator(NULL);
+}
+
+
+#endif
@@ -0,0 +1,543 @@
+#ifndef __TRAJECTORYCODEC_HPP__
+#define __TRAJECTORYCODEC_HPP__
+
+/* 	TrajectoryCodec.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Compression sans perte des colonnes d'un fichier de trajectoire (voir
+ * CompressedSink). Une colonne (suite de valeurs flottantes) est codée comme
+ * une suite de bits à partir de la représentation binaire des valeurs :
+ *
+ *		- XOR (méthode "Gorilla") : chaque valeur est combinée (ou exclusif) avec
+ *		  la précédente ; seuls les bits significatifs du résultat sont écrits.
+ *		  Adapté aux états d'un système régulier (valeurs voisines).
+ *		- DELTA (différence de différences) : la différence entre deux écarts
+ *		  successifs des représentations (vues comme des entiers) est écrite
+ *		  sur un nombre de bits variable. Adapté aux suites quasi linéaires
+ *		  comme le temps.
+ *		- RAW : valeurs brutes (types non flottants, ou si rien n'est gagné).
+ *
+ *		L'encodeur essaye les deux méthodes et garde la plus compacte. Seuls les
+ * types de 4 ou 8 octets sont compressés.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryFormat.hpp"
+
+
+/*	CodecWord
+ *
+ *		Entier non signé de même taille que le type des valeurs.
+ */
+template<size_t N> struct CodecWord { typedef uint8_t type; enum { bits = 0 }; };
+template<> struct CodecWord<4> { typedef uint32_t type; enum { bits = 32 }; };
+template<> struct CodecWord<8> { typedef uint64_t type; enum { bits = 64 }; };
+
+
+
+/*	BitWriter / BitReader
+ *
+ *		Écriture et lecture d'une suite de bits (bit de poids fort en premier).
+ */
+class BitWriter
+{
+	protected:
+		std::string *out;
+		uint64_t accumulator;
+		unsigned int count;		// Nombre de bits en attente dans "accumulator".
+
+	public:
+		BitWriter(std::string &out)
+		{
+			this->out = &out;
+			this->accumulator = 0;
+			this->count = 0;
+			return;
+		}
+
+		inline void put(const uint64_t value, const unsigned int nbits);
+		inline void flush(void);
+};
+
+inline void BitWriter::put(const uint64_t value, const unsigned int nbits)
+/*    Écrit les "nbits" bits de poids faible de "value" (nbits <= 64).
+ */
+{
+	unsigned int n;
+	uint64_t v;
+
+	if (nbits > 32)
+	{
+		this->put(value >> 32, nbits - 32);
+		this->put(value & 0xFFFFFFFFull, 32);
+		return;
+	}
+
+	n = nbits;
+	v = (n == 0) ? 0 : (value & ((~(uint64_t)0) >> (64 - n)));
+	this->accumulator = (this->accumulator << n) | v;
+	this->count += n;
+
+	while (this->count >= 8)
+	{
+		this->count -= 8;
+		this->out->push_back((char)(this->accumulator >> this->count));
+	}
+	return;
+}
+
+inline void BitWriter::flush(void)
+{
+	if (this->count > 0)
+	{
+		this->out->push_back((char)(this->accumulator << (8 - this->count)));
+		this->count = 0;
+	}
+	this->accumulator = 0;
+	return;
+}
+
+class BitReader
+{
+	protected:
+		const unsigned char *data;
+		uint64_t size;			// en octets
+		uint64_t position;		// en bits
+
+	public:
+		BitReader(const char *data, const uint64_t size)
+		{
+			this->data = (const unsigned char*)data;
+			this->size = size;
+			this->position = 0;
+			return;
+		}
+
+		inline uint64_t get(const unsigned int nbits);
+};
+
+inline uint64_t BitReader::get(const unsigned int nbits)
+/*    Lit "nbits" bits (nbits <= 64). Lève std::out_of_range si la suite de bits
+ * est trop courte.
+ */
+{
+	uint64_t value = 0;
+	unsigned int n = nbits;
+	unsigned int offset, take;
+
+	if (this->position + nbits > this->size * 8)
+	{
+		throw std::out_of_range("BitReader::get");
+	}
+
+	while (n > 0)
+	{
+		offset = (unsigned int)(this->position & 7);
+		take = 8 - offset;
+		if (take > n)
+		{
+			take = n;
+		}
+		value = (value << take) | ((this->data[this->position >> 3] >> (8 - offset - take)) & ((1u << take) - 1));
+		this->position += take;
+		n -= take;
+	}
+	return value;
+}
+
+
+
+/*	TrajectoryCodec
+ *
+ *		Codage et décodage d'une colonne de valeurs de type T.
+ */
+template<typename T>
+class TrajectoryCodec
+{
+	public:
+		enum { RAW = 0, XOR = 1, DELTA = 2 };
+
+	protected:
+		typedef typename CodecWord<sizeof(T)>::type word;
+		enum { BITS = CodecWord<sizeof(T)>::bits };
+		enum { LEADBITS = (BITS == 64) ? 6 : 5, LENGTHBITS = (BITS == 64) ? 6 : 5 };
+
+		static inline unsigned int leading(word x);
+		static inline unsigned int trailing(word x);
+
+		static void encodexor(const word *values, const uint64_t n, std::string &out);
+		static void decodexor(BitReader &in, word *values, const uint64_t n);
+
+		static void encodedelta(const word *values, const uint64_t n, std::string &out);
+		static void decodedelta(BitReader &in, word *values, const uint64_t n);
+
+	public:
+		static uint32_t encode(const T *values, const uint64_t n, std::string &out);
+		static void decode(const uint32_t codec, const char *data, const uint64_t size, T *values, const uint64_t n);
+};
+
+template<typename T>
+inline unsigned int TrajectoryCodec<T>::leading(word x)
+{
+	unsigned int n = 0;
+
+	if (x == 0)
+	{
+		return BITS;
+	}
+	while ( (x & ((word)1 << (BITS > 0 ? BITS - 1 : 0))) == 0 )
+	{
+		x <<= 1;
+		++n;
+	}
+	return n;
+}
+
+template<typename T>
+inline unsigned int TrajectoryCodec<T>::trailing(word x)
+{
+	unsigned int n = 0;
+
+	if (x == 0)
+	{
+		return BITS;
+	}
+	while ( (x & 1) == 0 )
+	{
+		x >>= 1;
+		++n;
+	}
+	return n;
+}
+
+
+
+template<typename T>
+void TrajectoryCodec<T>::encodexor(const word *values, const uint64_t n, std::string &out)
+/*    Première valeur brute, puis pour chaque valeur x = v ^ précédente :
+ *		'0'								x == 0
+ *		'10' + bits significatifs		mêmes zéros de tête et de queue (au moins)
+ *										que la fenêtre précédente
+ *		'11' + zéros de tête + longueur - 1 + bits significatifs
+ */
+{
+	BitWriter bits(out);
+	unsigned int lead = BITS + 1, trail = 0;	// Pas encore de fenêtre.
+	unsigned int l, t, length;
+	word x;
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	bits.put(values[0], BITS);
+	for (uint64_t i = 1; i < n; ++i)
+	{
+		x = values[i] ^ values[i-1];
+		if (x == 0)
+		{
+			bits.put(0, 1);
+			continue;
+		}
+
+		l = leading(x);
+		t = trailing(x);
+		if (l >= (1u << LEADBITS))
+		{
+			l = (1u << LEADBITS) - 1;
+		}
+
+		if ( (lead <= BITS) && (l >= lead) && (t >= trail) )
+		{
+			bits.put(2, 2);
+			bits.put(x >> trail, BITS - lead - trail);
+		}
+		else
+		{
+			lead = l;
+			trail = t;
+			length = BITS - lead - trail;
+			bits.put(3, 2);
+			bits.put(lead, LEADBITS);
+			bits.put(length - 1, LENGTHBITS);
+			bits.put(x >> trail, length);
+		}
+	}
+	bits.flush();
+	return;
+}
+
+template<typename T>
+void TrajectoryCodec<T>::decodexor(BitReader &in, word *values, const uint64_t n)
+{
+	unsigned int lead = 0, trail = 0, length;
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	values[0] = (word)in.get(BITS);
+	for (uint64_t i = 1; i < n; ++i)
+	{
+		if (in.get(1) == 0)
+		{
+			values[i] = values[i-1];
+			continue;
+		}
+		if (in.get(1) == 1)
+		{
+			lead = (unsigned int)in.get(LEADBITS);
+			length = (unsigned int)in.get(LENGTHBITS) + 1;
+			if (lead + length > BITS)
+			{
+				throw std::out_of_range("TrajectoryCodec::decode");
+			}
+			trail = BITS - lead - length;
+		}
+		values[i] = values[i-1] ^ ((word)in.get(BITS - lead - trail) << trail);
+	}
+	return;
+}
+
+
+
+template<typename T>
+void TrajectoryCodec<T>::encodedelta(const word *values, const uint64_t n, std::string &out)
+/*    Première valeur et premier écart bruts, puis pour chaque différence
+ * d'écarts dd (codée en "zigzag" : 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) :
+ *		'0'					dd == 0
+ *		'10' + 7 bits		'110' + 12 bits		'1110' + 20 bits
+ *		'1111' + BITS bits
+ */
+{
+	BitWriter bits(out);
+	word delta, previous = 0, dd, zz;
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	bits.put(values[0], BITS);
+	for (uint64_t i = 1; i < n; ++i)
+	{
+		delta = values[i] - values[i-1];		// Arithmétique modulo 2^BITS.
+		if (i == 1)
+		{
+			bits.put(delta, BITS);
+			previous = delta;
+			continue;
+		}
+		dd = delta - previous;
+		previous = delta;
+
+		zz = (dd << 1) ^ ((word)0 - (dd >> (BITS > 0 ? BITS - 1 : 0)));
+		if (zz == 0)
+		{
+			bits.put(0, 1);
+		}
+		else if (zz < ((word)1 << 7))
+		{
+			bits.put(2, 2);
+			bits.put(zz, 7);
+		}
+		else if (zz < ((word)1 << 12))
+		{
+			bits.put(6, 3);
+			bits.put(zz, 12);
+		}
+		else if (zz < ((word)1 << 20))
+		{
+			bits.put(14, 4);
+			bits.put(zz, 20);
+		}
+		else
+		{
+			bits.put(15, 4);
+			bits.put(zz, BITS);
+		}
+	}
+	bits.flush();
+	return;
+}
+
+template<typename T>
+void TrajectoryCodec<T>::decodedelta(BitReader &in, word *values, const uint64_t n)
+{
+	word delta = 0, zz, dd;
+	unsigned int width;
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	values[0] = (word)in.get(BITS);
+	for (uint64_t i = 1; i < n; ++i)
+	{
+		if (i == 1)
+		{
+			delta = (word)in.get(BITS);
+			values[1] = values[0] + delta;
+			continue;
+		}
+
+		if (in.get(1) == 0)
+		{
+			width = 0;
+		}
+		else if (in.get(1) == 0)
+		{
+			width = 7;
+		}
+		else if (in.get(1) == 0)
+		{
+			width = 12;
+		}
+		else if (in.get(1) == 0)
+		{
+			width = 20;
+		}
+		else
+		{
+			width = BITS;
+		}
+
+		zz = (width == 0) ? 0 : (word)in.get(width);
+		dd = (zz >> 1) ^ ((word)0 - (zz & 1));
+		delta += dd;
+		values[i] = values[i-1] + delta;
+	}
+	return;
+}
+
+
+
+template<typename T>
+uint32_t TrajectoryCodec<T>::encode(const T *values, const uint64_t n, std::string &out)
+/*    Ajoute à "out" la colonne codée et renvoie la méthode utilisée.
+ */
+{
+	std::vector<word> words;
+	std::string xorcoded, deltacoded;
+	const uint64_t raw = n * sizeof(T);
+
+	if ( (BITS > 0) && (n > 0) )
+	{
+		words.resize(n);
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			memcpy(&words[i], &values[i], sizeof(T));
+		}
+
+		encodexor(&words[0], n, xorcoded);
+		encodedelta(&words[0], n, deltacoded);
+
+		if ( (xorcoded.size() <= deltacoded.size()) && (xorcoded.size() < raw) )
+		{
+			out += xorcoded;
+			return XOR;
+		}
+		if (deltacoded.size() < raw)
+		{
+			out += deltacoded;
+			return DELTA;
+		}
+	}
+
+	// Valeurs brutes en petit-boutiste.
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		BinaryFormat::append(out, values[i]);
+	}
+	return RAW;
+}
+
+template<typename T>
+void TrajectoryCodec<T>::decode(const uint32_t codec, const char *data, const uint64_t size, T *values, const uint64_t n)
+/*    Décode une colonne de "n" valeurs. Lève std::out_of_range si les données
+ * sont incomplètes ou la méthode inconnue.
+ */
+{
+	std::vector<word> words;
+	BitReader in(data, size);
+
+	if ( (codec == RAW) || (BITS == 0) )
+	{
+		if ( (codec != RAW) || (size < n * sizeof(T)) )
+		{
+			throw std::out_of_range("TrajectoryCodec::decode");
+		}
+		for (uint64_t i = 0; i < n; ++i)
+		{
+			values[i] = BinaryFormat::load<T>(data + i * sizeof(T));
+		}
+		return;
+	}
+
+	if (n == 0)
+	{
+		return;
+	}
+
+	words.resize(n);
+	if (codec == XOR)
+	{
+		decodexor(in, &words[0], n);
+	}
+	else if (codec == DELTA)
+	{
+		decodedelta(in, &words[0], n);
+	}
+	else
+	{
+		throw std::out_of_range("TrajectoryCodec::decode");
+	}
+
+	for (uint64_t i = 0; i < n; ++i)
+	{
+		memcpy(&values[i], &words[i], sizeof(T));
+	}
+	return;
+}
+
+
+#endif
@@ -0,0 +1,472 @@
+#ifndef __TRAJECTORYFORMAT_HPP__
+#define __TRAJECTORYFORMAT_HPP__
+
+/* 	TrajectoryFormat.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Format binaire des fichiers de trajectoire (voir BinarySink). Toutes
+ * les valeurs sont stockées en petit-boutiste (little-endian).
+ *
+ *	En-tête du fichier (complété par des zéros jusqu'à "headersize", multiple
+ * de "alignment") :
+ *		 0	char[8]		"SYSSIMTR"
+ *		 8	uint32		version
+ *		12	uint32		layout (0 : colonnes brutes, 1 : colonnes compressées)
+ *		16	uint32		code du type des valeurs (voir BinaryType)
+ *		20	uint32		taille (octets) d'une valeur
+ *		24	uint64		dimension (nombre d'états)
+ *		32	float64		pas d'échantillonnage (0 si inconnu)
+ *		40	uint32		alignement des blocs
+ *		44	uint32		nombre de lignes par bloc
+ *		48	uint64		headersize (position du premier bloc)
+ *		56	uint32		nombre de noms, puis pour chaque nom : uint32 longueur
+ *						suivi des caractères.
+ *
+ *	Chaque bloc ("chunk") commence par un en-tête de 64 octets :
+ *		 0	char[4]		"CHNK"
+ *		 4	uint32		drapeaux (réservé)
+ *		 8	uint64		nombre de lignes du bloc
+ *		16	uint64		taille totale du bloc (en-tête et remplissage compris)
+ *		24	float64		premier temps du bloc
+ *		32	float64		dernier temps du bloc
+ *	suivi des colonnes : le temps puis chacun des états, chaque colonne étant
+ * contiguë ("rows" valeurs). La taille du bloc est un multiple de l'alignement.
+ *
+ *	Format compressé (layout 1, voir CompressedSink) : l'en-tête de bloc
+ * (drapeau 1) est suivi d'un répertoire de "dimension + 1" entrées de 16 octets
+ * (uint32 méthode de codage, uint32 réservé, uint64 taille) puis des colonnes
+ * codées (voir TrajectoryCodec.hpp). Le fichier se termine par un index des
+ * blocs permettant l'accès direct :
+ *		 0	char[4]		"CIDX"
+ *		 4	uint32		réservé
+ *		 8	uint64		nombre de blocs
+ *		16	pour chaque bloc (32 octets) : uint64 position, uint64 nombre de
+ *			lignes, float64 premier temps, float64 dernier temps
+ *	suivi de 16 octets : uint64 position de l'index, char[8] "SYSSIMIX".
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+
+/*	BinaryType
+ *
+ *		Code identifiant le type des valeurs dans un fichier binaire. Les types
+ * non reconnus ont le code 0 (seule leur taille est alors connue).
+ */
+template<typename T> struct BinaryType { enum { code = 0 }; };
+template<> struct BinaryType<float> { enum { code = 1 }; };
+template<> struct BinaryType<double> { enum { code = 2 }; };
+template<> struct BinaryType<long double> { enum { code = 3 }; };
+template<> struct BinaryType<int8_t> { enum { code = 10 }; };
+template<> struct BinaryType<uint8_t> { enum { code = 11 }; };
+template<> struct BinaryType<int16_t> { enum { code = 12 }; };
+template<> struct BinaryType<uint16_t> { enum { code = 13 }; };
+template<> struct BinaryType<int32_t> { enum { code = 14 }; };
+template<> struct BinaryType<uint32_t> { enum { code = 15 }; };
+template<> struct BinaryType<int64_t> { enum { code = 16 }; };
+template<> struct BinaryType<uint64_t> { enum { code = 17 }; };
+
+
+
+/*	BinaryFormat
+ *
+ *		Lecture et écriture de valeurs en petit-boutiste, quel que soit
+ * l'ordre des octets de la machine.
+ */
+class BinaryFormat
+{
+	public:
+		static inline bool littleendian(void)
+		{
+			const uint16_t one = 1;
+			return *(const unsigned char*)&one == 1;
+		}
+
+		static inline uint64_t align(const uint64_t size, const uint64_t alignment)
+		{
+			if (alignment <= 1)
+			{
+				return size;
+			}
+			return ((size + alignment - 1) / alignment) * alignment;
+		}
+
+		template<typename U>
+		static inline void store(char *dst, const U &value)
+		{
+			memcpy(dst, &value, sizeof(U));
+			if (!littleendian())
+			{
+				swap(dst, sizeof(U));
+			}
+			return;
+		}
+
+		template<typename U>
+		static inline U load(const char *src)
+		{
+			U value;
+			if (littleendian())
+			{
+				memcpy(&value, src, sizeof(U));
+			}
+			else
+			{
+				char tmp[sizeof(U)];
+				memcpy(tmp, src, sizeof(U));
+				swap(tmp, sizeof(U));
+				memcpy(&value, tmp, sizeof(U));
+			}
+			return value;
+		}
+
+		template<typename U>
+		static inline void append(std::string &dst, const U &value)
+		{
+			char tmp[sizeof(U)];
+			store(tmp, value);
+			dst.append(tmp, sizeof(U));
+			return;
+		}
+
+		static inline void swap(char *data, const size_t size)
+		{
+			for (size_t i = 0; i < size / 2; ++i)
+			{
+				char c = data[i];
+				data[i] = data[size - 1 - i];
+				data[size - 1 - i] = c;
+			}
+			return;
+		}
+};
+
+
+
+/*	TrajectoryHeader
+ *
+ *		En-tête d'un fichier de trajectoire.
+ */
+class TrajectoryHeader
+{
+	public:
+		enum { COLUMNAR = 0, COMPRESSED = 1 };
+		enum { VERSION = 1 };
+		enum { PREFIX = 60 };	// Partie fixe (jusqu'au nombre de noms).
+
+		uint32_t version;
+		uint32_t layout;
+		uint32_t typecode;
+		uint32_t typesize;
+		uint64_t dimension;
+		double samplingstep;
+		uint32_t alignment;
+		uint32_t chunkrows;
+		uint64_t headersize;
+		std::vector<std::string> names;
+
+		TrajectoryHeader(void)
+		{
+			this->version = VERSION;
+			this->layout = COLUMNAR;
+			this->typecode = 0;
+			this->typesize = 0;
+			this->dimension = 0;
+			this->samplingstep = 0.0;
+			this->alignment = 1;
+			this->chunkrows = 0;
+			this->headersize = 0;
+			return;
+		}
+
+		inline void encode(std::string &out);
+		inline bool decode(const char *data, const uint64_t size);
+
+		static inline uint64_t peek(const char *data, const uint64_t size);
+};
+
+inline void TrajectoryHeader::encode(std::string &out)
+/*    Écrit l'en-tête dans "out" (remplissage compris) et met à jour
+ * "headersize".
+ */
+{
+	std::string names;
+
+	BinaryFormat::append(names, (uint32_t)this->names.size());
+	for (size_t i = 0; i < this->names.size(); ++i)
+	{
+		BinaryFormat::append(names, (uint32_t)this->names[i].size());
+		names += this->names[i];
+	}
+
+	this->headersize = BinaryFormat::align(56 + names.size(), this->alignment);
+
+	out.assign("SYSSIMTR", 8);
+	BinaryFormat::append(out, this->version);
+	BinaryFormat::append(out, this->layout);
+	BinaryFormat::append(out, this->typecode);
+	BinaryFormat::append(out, this->typesize);
+	BinaryFormat::append(out, this->dimension);
+	BinaryFormat::append(out, this->samplingstep);
+	BinaryFormat::append(out, this->alignment);
+	BinaryFormat::append(out, this->chunkrows);
+	BinaryFormat::append(out, this->headersize);
+	out += names;
+	out.resize(this->headersize, '\0');
+	return;
+}
+
+inline bool TrajectoryHeader::decode(const char *data, const uint64_t size)
+/*    Lit un en-tête. Renvoie false si les données ne sont pas un en-tête
+ * valide.
+ */
+{
+	uint64_t offset;
+	uint32_t count, length;
+
+	if ( (size < PREFIX) || (memcmp(data, "SYSSIMTR", 8) != 0) )
+	{
+		return false;
+	}
+
+	this->version = BinaryFormat::load<uint32_t>(data + 8);
+	this->layout = BinaryFormat::load<uint32_t>(data + 12);
+	this->typecode = BinaryFormat::load<uint32_t>(data + 16);
+	this->typesize = BinaryFormat::load<uint32_t>(data + 20);
+	this->dimension = BinaryFormat::load<uint64_t>(data + 24);
+	this->samplingstep = BinaryFormat::load<double>(data + 32);
+	this->alignment = BinaryFormat::load<uint32_t>(data + 40);
+	this->chunkrows = BinaryFormat::load<uint32_t>(data + 44);
+	this->headersize = BinaryFormat::load<uint64_t>(data + 48);
+	count = BinaryFormat::load<uint32_t>(data + 56);
+
+	if ( (this->version != VERSION) || (this->headersize > size) )
+	{
+		return false;
+	}
+
+	this->names.clear();
+	offset = PREFIX;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (offset + 4 > this->headersize)
+		{
+			return false;
+		}
+		length = BinaryFormat::load<uint32_t>(data + offset);
+		offset += 4;
+		if (offset + length > this->headersize)
+		{
+			return false;
+		}
+		this->names.push_back(std::string(data + offset, length));
+		offset += length;
+	}
+	return true;
+}
+
+inline uint64_t TrajectoryHeader::peek(const char *data, const uint64_t size)
+/*    Taille complète ("headersize") d'un en-tête dont seule la partie fixe
+ * (PREFIX octets) a été lue. Renvoie 0 si ce n'est pas un en-tête valide.
+ */
+{
+	uint64_t headersize;
+
+	if ( (size < PREFIX) || (memcmp(data, "SYSSIMTR", 8) != 0) )
+	{
+		return 0;
+	}
+	headersize = BinaryFormat::load<uint64_t>(data + 48);
+	return (headersize < PREFIX) ? 0 : headersize;
+}
+
+
+
+/*	TrajectoryChunk
+ *
+ *		En-tête (64 octets) d'un bloc de trajectoire.
+ */
+class TrajectoryChunk
+{
+	public:
+		enum { SIZE = 64 };
+
+		uint32_t flags;
+		uint64_t rows;
+		uint64_t bytes;
+		double tfirst;
+		double tlast;
+
+		TrajectoryChunk(void)
+		{
+			this->flags = 0;
+			this->rows = 0;
+			this->bytes = 0;
+			this->tfirst = 0.0;
+			this->tlast = 0.0;
+			return;
+		}
+
+		inline void encode(char *dst) const;
+		inline bool decode(const char *data, const uint64_t size);
+};
+
+inline void TrajectoryChunk::encode(char *dst) const
+{
+	memset(dst, 0, SIZE);
+	memcpy(dst, "CHNK", 4);
+	BinaryFormat::store(dst + 4, this->flags);
+	BinaryFormat::store(dst + 8, this->rows);
+	BinaryFormat::store(dst + 16, this->bytes);
+	BinaryFormat::store(dst + 24, this->tfirst);
+	BinaryFormat::store(dst + 32, this->tlast);
+	return;
+}
+
+inline bool TrajectoryChunk::decode(const char *data, const uint64_t size)
+{
+	if ( (size < SIZE) || (memcmp(data, "CHNK", 4) != 0) )
+	{
+		return false;
+	}
+	this->flags = BinaryFormat::load<uint32_t>(data + 4);
+	this->rows = BinaryFormat::load<uint64_t>(data + 8);
+	this->bytes = BinaryFormat::load<uint64_t>(data + 16);
+	this->tfirst = BinaryFormat::load<double>(data + 24);
+	this->tlast = BinaryFormat::load<double>(data + 32);
+	return (this->bytes >= SIZE) && (this->bytes <= size);
+}
+
+
+
+
+/*	TrajectoryIndex
+ *
+ *		Index des blocs d'un fichier de trajectoire compressé.
+ */
+class TrajectoryIndex
+{
+	public:
+		enum { ENTRY = 32, TRAILER = 16 };
+
+		std::vector<uint64_t> offsets;
+		std::vector<uint64_t> rows;
+		std::vector<double> tfirst;
+		std::vector<double> tlast;
+
+		inline void add(const uint64_t offset, const TrajectoryChunk &chunk);
+		inline size_t size(void) const;
+		inline void clear(void);
+
+		inline void encode(std::string &out, const uint64_t position) const;
+		inline bool decode(const char *data, const uint64_t size);
+};
+
+inline void TrajectoryIndex::add(const uint64_t offset, const TrajectoryChunk &chunk)
+{
+	this->offsets.push_back(offset);
+	this->rows.push_back(chunk.rows);
+	this->tfirst.push_back(chunk.tfirst);
+	this->tlast.push_back(chunk.tlast);
+	return;
+}
+
+inline size_t TrajectoryIndex::size(void) const
+{
+	return this->offsets.size();
+}
+
+inline void TrajectoryIndex::clear(void)
+{
+	this->offsets.clear();
+	this->rows.clear();
+	this->tfirst.clear();
+	this->tlast.clear();
+	return;
+}
+
+inline void TrajectoryIndex::encode(std::string &out, const uint64_t position) const
+/*    Écrit l'index (et la fin de fichier) ; "position" est la position de
+ * l'index dans le fichier.
+ */
+{
+	out.assign("CIDX", 4);
+	BinaryFormat::append(out, (uint32_t)0);
+	BinaryFormat::append(out, (uint64_t)this->size());
+	for (size_t i = 0; i < this->size(); ++i)
+	{
+		BinaryFormat::append(out, this->offsets[i]);
+		BinaryFormat::append(out, this->rows[i]);
+		BinaryFormat::append(out, this->tfirst[i]);
+		BinaryFormat::append(out, this->tlast[i]);
+	}
+	BinaryFormat::append(out, position);
+	out.append("SYSSIMIX", 8);
+	return;
+}
+
+inline bool TrajectoryIndex::decode(const char *data, const uint64_t size)
+/*    Lit un index à partir de "data" (début de l'index) ; "size" est le nombre
+ * d'octets disponibles.
+ */
+{
+	uint64_t count;
+	const char *entry;
+
+	this->clear();
+	if ( (size < 16) || (memcmp(data, "CIDX", 4) != 0) )
+	{
+		return false;
+	}
+	count = BinaryFormat::load<uint64_t>(data + 8);
+	if ( (size - 16) / ENTRY < count )
+	{
+		return false;
+	}
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		entry = data + 16 + i * ENTRY;
+		this->offsets.push_back(BinaryFormat::load<uint64_t>(entry));
+		this->rows.push_back(BinaryFormat::load<uint64_t>(entry + 8));
+		this->tfirst.push_back(BinaryFormat::load<double>(entry + 16));
+		this->tlast.push_back(BinaryFormat::load<double>(entry + 24));
+	}
+	return true;
+}
+
+
+#endif
@@ -0,0 +1,483 @@
+#ifndef __TRAJECTORYREADER_HPP__
+#define __TRAJECTORYREADER_HPP__
+
+/* 	TrajectoryReader.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Lecture d'un fichier de trajectoire binaire (voir BinarySink) par
+ * projection en mémoire (mmap). Aucune donnée n'est analysée ni copiée : à
+ * l'ouverture, seuls les en-têtes de blocs sont lus pour construire l'index des
+ * temps (premier et dernier temps de chaque bloc).
+ *		- "window(t0, t1)" trouve par dichotomie (sur l'index puis sur la
+ *		  colonne des temps) les échantillons de l'intervalle [t0, t1] ;
+ *		- "column(...)" donne une vue (ColumnView, pointeur et taille) sur une
+ *		  colonne d'un bloc directement dans le fichier projeté.
+ *		Une fenêtre peut s'étendre sur plusieurs blocs : elle est alors formée
+ * de plusieurs segments, un par bloc.
+ *
+ *		TrajectoryInput permet d'utiliser une colonne d'une trajectoire comme
+ * entrée (interpolée linéairement en temps) d'un autre système, par exemple
+ * dans sa fonction "f".
+ *
+ *		Les vues pointant directement dans le fichier, la lecture n'est possible
+ * que sur une machine petit-boutiste et pour le type T avec lequel le fichier a
+ * été écrit (std::invalid_argument sinon). Linux/POSIX uniquement.
+ *
+ */
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TrajectoryFormat.hpp"
+
+
+/*	ColumnView
+ *
+ *		Vue (sans copie) sur des valeurs contiguës.
+ */
+template<typename T>
+class ColumnView
+{
+	protected:
+		const T *values;
+		size_t count;
+
+	public:
+		ColumnView(void)
+		{
+			this->values = NULL;
+			this->count = 0;
+			return;
+		}
+		ColumnView(const T *values, const size_t count)
+		{
+			this->values = values;
+			this->count = count;
+			return;
+		}
+
+		inline const T &operator[](const size_t index) const { return this->values[index]; };
+		inline const T *data(void) const { return this->values; };
+		inline size_t size(void) const { return this->count; };
+		inline const T *begin(void) const { return this->values; };
+		inline const T *end(void) const { return this->values + this->count; };
+};
+
+
+
+/*	TrajectorySegment
+ *
+ *		Partie d'une fenêtre contenue dans un seul bloc : lignes [first, first +
+ * rows) du bloc "chunk".
+ */
+class TrajectorySegment
+{
+	public:
+		size_t chunk;
+		uint64_t first;
+		uint64_t rows;
+};
+
+
+
+template<typename T>
+class TrajectoryReader
+{
+	public: typedef typename std::vector<T>::size_type size_type;
+
+	protected:
+		int fd;
+		const char *map;
+		uint64_t length;
+
+		TrajectoryHeader header;
+		TrajectoryIndex index;
+
+		void scan(void);
+
+	public:
+		TrajectoryReader(const std::string &path);
+		TrajectoryReader(const TrajectoryReader<T>&) = delete;
+		TrajectoryReader<T> &operator=(const TrajectoryReader<T>&) = delete;
+		virtual ~TrajectoryReader(void);
+
+		inline const TrajectoryHeader &getheader(void) const;
+
+		inline size_t chunks(void) const;
+		inline uint64_t rows(const size_t chunk) const;
+		inline uint64_t rows(void) const;
+		inline double tfirst(const size_t chunk) const;
+		inline double tlast(const size_t chunk) const;
+
+		inline ColumnView<T> time(const size_t chunk) const;
+		inline ColumnView<T> column(const size_t chunk, const size_type state) const;
+		inline ColumnView<T> time(const TrajectorySegment &segment) const;
+		inline ColumnView<T> column(const TrajectorySegment &segment, const size_type state) const;
+
+		void window(const T t0, const T t1, std::vector<TrajectorySegment> &segments) const;
+};
+
+template<typename T>
+TrajectoryReader<T>::TrajectoryReader(const std::string &path)
+/*    Projette le fichier et construit l'index. Lève std::runtime_error si le
+ * fichier ne peut être lu ou n'est pas une trajectoire binaire en colonnes.
+ */
+{
+	struct stat status;
+	void *address;
+
+	if (!BinaryFormat::littleendian())
+	{
+		throw std::invalid_argument("TrajectoryReader");
+	}
+
+	this->fd = ::open(path.c_str(), O_RDONLY);
+	if (this->fd < 0)
+	{
+		throw std::runtime_error("TrajectoryReader: " + path);
+	}
+	if ( (fstat(this->fd, &status) != 0) || (status.st_size <= 0) )
+	{
+		::close(this->fd);
+		throw std::runtime_error("TrajectoryReader: " + path);
+	}
+	this->length = (uint64_t)status.st_size;
+
+	address = mmap(NULL, this->length, PROT_READ, MAP_SHARED, this->fd, 0);
+	if (address == MAP_FAILED)
+	{
+		::close(this->fd);
+		throw std::runtime_error("TrajectoryReader: " + path);
+	}
+	this->map = (const char*)address;
+
+	if ( !this->header.decode(this->map, this->length) || (this->header.layout != TrajectoryHeader::COLUMNAR) )
+	{
+		munmap((void*)this->map, this->length);
+		::close(this->fd);
+		throw std::runtime_error("TrajectoryReader: " + path);
+	}
+	if ( (this->header.typesize != sizeof(T)) || (this->header.typecode != (uint32_t)BinaryType<T>::code) )
+	{
+		munmap((void*)this->map, this->length);
+		::close(this->fd);
+		throw std::invalid_argument("TrajectoryReader: " + path);
+	}
+
+	this->scan();
+	return;
+}
+
+template<typename T>
+TrajectoryReader<T>::~TrajectoryReader(void)
+{
+	munmap((void*)this->map, this->length);
+	::close(this->fd);
+	return;
+}
+
+template<typename T>
+void TrajectoryReader<T>::scan(void)
+/*    Construit l'index à partir des en-têtes de blocs. Un bloc incomplet en fin
+ * de fichier (écriture interrompue) est ignoré.
+ */
+{
+	TrajectoryChunk info;
+	uint64_t position = this->header.headersize;
+	const uint64_t columns = this->header.dimension + 1;
+
+	while (position + TrajectoryChunk::SIZE <= this->length)
+	{
+		if ( !info.decode(this->map + position, this->length - position) )
+		{
+			break;
+		}
+		if (TrajectoryChunk::SIZE + columns * info.rows * sizeof(T) > info.bytes)
+		{
+			break;
+		}
+		this->index.add(position, info);
+		position += info.bytes;
+	}
+	return;
+}
+
+
+
+template<typename T>
+inline const TrajectoryHeader& TrajectoryReader<T>::getheader(void) const
+{
+	return this->header;
+}
+
+template<typename T>
+inline size_t TrajectoryReader<T>::chunks(void) const
+{
+	return this->index.size();
+}
+
+template<typename T>
+inline uint64_t TrajectoryReader<T>::rows(const size_t chunk) const
+{
+	return this->index.rows[chunk];
+}
+
+template<typename T>
+inline uint64_t TrajectoryReader<T>::rows(void) const
+{
+	uint64_t total = 0;
+
+	for (size_t i = 0; i < this->index.size(); ++i)
+	{
+		total += this->index.rows[i];
+	}
+	return total;
+}
+
+template<typename T>
+inline double TrajectoryReader<T>::tfirst(const size_t chunk) const
+{
+	return this->index.tfirst[chunk];
+}
+
+template<typename T>
+inline double TrajectoryReader<T>::tlast(const size_t chunk) const
+{
+	return this->index.tlast[chunk];
+}
+
+
+
+template<typename T>
+inline ColumnView<T> TrajectoryReader<T>::time(const size_t chunk) const
+{
+	return ColumnView<T>((const T*)(this->map + this->index.offsets[chunk] + TrajectoryChunk::SIZE), this->index.rows[chunk]);
+}
+
+template<typename T>
+inline ColumnView<T> TrajectoryReader<T>::column(const size_t chunk, const size_type state) const
+{
+	const uint64_t n = this->index.rows[chunk];
+
+	if (state >= this->header.dimension)
+	{
+		throw std::out_of_range("TrajectoryReader::column");
+	}
+	return ColumnView<T>((const T*)(this->map + this->index.offsets[chunk] + TrajectoryChunk::SIZE + (state + 1) * n * sizeof(T)), n);
+}
+
+template<typename T>
+inline ColumnView<T> TrajectoryReader<T>::time(const TrajectorySegment &segment) const
+{
+	return ColumnView<T>(this->time(segment.chunk).data() + segment.first, segment.rows);
+}
+
+template<typename T>
+inline ColumnView<T> TrajectoryReader<T>::column(const TrajectorySegment &segment, const size_type state) const
+{
+	return ColumnView<T>(this->column(segment.chunk, state).data() + segment.first, segment.rows);
+}
+
+
+
+template<typename T>
+void TrajectoryReader<T>::window(const T t0, const T t1, std::vector<TrajectorySegment> &segments) const
+/*    "segments" reçoit les échantillons de temps t tels que t0 <= t <= t1 (les
+ * temps étant croissants dans le fichier).
+ */
+{
+	TrajectorySegment segment;
+	ColumnView<T> times;
+	size_t first, last;
+
+	segments.clear();
+	if (t1 < t0)
+	{
+		return;
+	}
+
+	first = std::lower_bound(this->index.tlast.begin(), this->index.tlast.end(), (double)t0) - this->index.tlast.begin();
+	last = std::upper_bound(this->index.tfirst.begin(), this->index.tfirst.end(), (double)t1) - this->index.tfirst.begin();
+
+	for (size_t c = first; c < last; ++c)
+	{
+		times = this->time(c);
+		segment.chunk = c;
+		segment.first = (c == first) ? std::lower_bound(times.begin(), times.end(), t0) - times.begin() : 0;
+		segment.rows = ( (c + 1 == last) ? std::upper_bound(times.begin(), times.end(), t1) - times.begin() : times.size() ) - segment.first;
+		if (segment.rows > 0)
+		{
+			segments.push_back(segment);
+		}
+	}
+	return;
+}
+
+
+
+/*	TrajectoryInput
+ *
+ *		Entrée d'un système issue d'une trajectoire enregistrée : "operator()(t)"
+ * renvoie la valeur de l'état "state" au temps t, interpolée linéairement entre
+ * les deux échantillons voisins (la valeur extrême hors de la trajectoire).
+ * Les accès successifs à des temps croissants (cas d'une simulation) ne
+ * demandent pas de recherche.
+ */
+template<typename T>
+class TrajectoryInput
+{
+	public: typedef typename TrajectoryReader<T>::size_type size_type;
+
+	protected:
+		const TrajectoryReader<T> *reader;
+		size_type state;
+
+		size_t chunk;			// Bloc de l'échantillon courant.
+		uint64_t row;			// Échantillon courant : t[row] <= t < t[row+1].
+
+		inline bool next(size_t &chunk, uint64_t &row) const;
+		void seek(const T t);
+
+	public:
+		TrajectoryInput(const TrajectoryReader<T> &reader, const size_type state);
+		virtual ~TrajectoryInput(void){};
+
+		T operator()(const T t);
+};
+
+template<typename T>
+TrajectoryInput<T>::TrajectoryInput(const TrajectoryReader<T> &reader, const size_type state)
+{
+	if ( (reader.chunks() == 0) || (state >= reader.getheader().dimension) )
+	{
+		throw std::invalid_argument("TrajectoryInput");
+	}
+	this->reader = &reader;
+	this->state = state;
+	this->chunk = 0;
+	this->row = 0;
+	return;
+}
+
+template<typename T>
+inline bool TrajectoryInput<T>::next(size_t &chunk, uint64_t &row) const
+/*    Passe à l'échantillon suivant. Renvoie false à la fin de la trajectoire.
+ */
+{
+	if (row + 1 < this->reader->rows(chunk))
+	{
+		++row;
+		return true;
+	}
+	if (chunk + 1 < this->reader->chunks())
+	{
+		++chunk;
+		row = 0;
+		return true;
+	}
+	return false;
+}
+
+template<typename T>
+void TrajectoryInput<T>::seek(const T t)
+/*    Place l'échantillon courant sur le dernier échantillon de temps inférieur
+ * ou égal à t (ou le premier de la trajectoire).
+ */
+{
+	ColumnView<T> times;
+	size_t low = 0, high = this->reader->chunks(), middle;
+
+	while (low < high)
+	{
+		middle = (low + high) / 2;
+		if (this->reader->tfirst(middle) <= (double)t)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	this->chunk = (low > 0) ? low - 1 : 0;
+
+	times = this->reader->time(this->chunk);
+	this->row = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+	this->row = (this->row > 0) ? this->row - 1 : 0;
+	return;
+}
+
+template<typename T>
+T TrajectoryInput<T>::operator()(const T t)
+{
+	size_t c;
+	uint64_t r;
+	T t0, t1, x0, x1;
+
+	if ( (t < this->reader->time(this->chunk)[this->row]) || ((double)t > this->reader->tlast(this->chunk)) )
+	{
+		this->seek(t);
+	}
+
+	// L'échantillon suivant est au plus dans le bloc suivant.
+	c = this->chunk;
+	r = this->row;
+	while (this->next(c, r))
+	{
+		t1 = this->reader->time(c)[r];
+		if (t1 > t)
+		{
+			t0 = this->reader->time(this->chunk)[this->row];
+			x0 = this->reader->column(this->chunk, this->state)[this->row];
+			if (t <= t0)
+			{
+				return x0;
+			}
+			x1 = this->reader->column(c, this->state)[r];
+			return x0 + (x1 - x0) * ((t - t0) / (t1 - t0));
+		}
+		this->chunk = c;
+		this->row = r;
+	}
+	return this->reader->column(this->chunk, this->state)[this->row];
+}
+
+
+#endif
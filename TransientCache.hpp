@@ -0,0 +1,212 @@
+#ifndef __TRANSIENTCACHE_HPP__
+#define __TRANSIENTCACHE_HPP__
+
+/* 	TransientCache.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Cache sur disque des états obtenus après le transitoire d'une
+ * simulation. Une entrée est un point de reprise (Checkpoint) stocké dans
+ * "répertoire/<empreinte>.ck", où l'empreinte (voir Fingerprint.hpp) résume
+ * tout ce qui détermine le résultat du transitoire : paramètres du système,
+ * topologie du réseau, état initial et temps de départ, réglages des
+ * intégrateurs (principal et de transitoire, pas, fenêtre de transition) et
+ * durée du transitoire. Simulation::runtransiant (et donc "run") consulte le
+ * cache avant de calculer le transitoire (voir Simulation::settransiantcache).
+ *
+ *		Le cache n'est utilisé que si toutes les parties de la configuration
+ * savent calculer leur empreinte ("fingerprint" renvoie true) : un système,
+ * une connexion ou un prédicat qui ne la redéfinit pas (y compris une classe
+ * dérivée d'une classe qui la définit) désactive le cache pour cette
+ * simulation (par prudence, plutôt que de réutiliser un état faux).
+ *
+ *		Les entrées sont écrites dans un fichier temporaire unique puis
+ * renommées : plusieurs tâches de fond ou programmes peuvent partager le même
+ * répertoire. Une entrée illisible (incomplète, d'un autre type de valeurs)
+ * est ignorée et recalculée. "store" lève une exception si l'entrée ne peut
+ * être écrite (disque plein, droits) ; Simulation l'ignore (le transitoire
+ * reste un défaut). Les entrées ne sont jamais effacées automatiquement.
+ *
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+#include "Checkpoint.hpp"
+#include "Fingerprint.hpp"
+
+template<typename T>
+class TransientCache
+{
+	protected:
+		std::string directory;
+
+		std::atomic<unsigned long> hits, misses;
+
+	public:
+		TransientCache(const std::string &directory);
+		virtual ~TransientCache(void){};
+
+		inline std::string path(const uint64_t key) const;
+
+		bool load(const uint64_t key, Checkpoint<T> &checkpoint);
+		void store(const uint64_t key, const Checkpoint<T> &checkpoint);
+
+		inline unsigned long gethits(void) const;
+		inline unsigned long getmisses(void) const;
+};
+
+template<typename T>
+TransientCache<T>::TransientCache(const std::string &directory)
+/*    Le répertoire est créé s'il n'existe pas.
+ */
+{
+	struct stat info;
+
+	this->directory = directory.empty() ? std::string(".") : directory;
+	this->hits = 0;
+	this->misses = 0;
+	if ( (::mkdir(this->directory.c_str(), 0755) != 0) && (errno != EEXIST) )
+	{
+		throw std::runtime_error("TransientCache : cannot create " + this->directory);
+	}
+	if ( (::stat(this->directory.c_str(), &info) != 0) || !S_ISDIR(info.st_mode) )
+	{
+		throw std::runtime_error("TransientCache : not a directory " + this->directory);
+	}
+	return;
+}
+
+template<typename T>
+inline std::string TransientCache<T>::path(const uint64_t key) const
+{
+	return this->directory + "/" + Fingerprint::hex(key) + ".ck";
+}
+
+template<typename T>
+bool TransientCache<T>::load(const uint64_t key, Checkpoint<T> &checkpoint)
+/*    Renvoie false si l'entrée n'existe pas ou est illisible.
+ */
+{
+	bool found;
+
+	try
+	{
+		found = checkpoint.read(this->path(key));
+	}
+	catch (const std::runtime_error &error)
+	{
+		found = false;
+	}
+	if (found)
+	{
+		++this->hits;
+	}
+	else
+	{
+		++this->misses;
+	}
+	return found;
+}
+
+template<typename T>
+void TransientCache<T>::store(const uint64_t key, const Checkpoint<T> &checkpoint)
+/*    Pas de synchronisation (fsync) : une entrée perdue lors d'un arrêt brutal
+ * est simplement recalculée. Le renommage garantit qu'une entrée visible est
+ * complète.
+ */
+{
+	const std::string path = this->path(key);
+	std::string buffer;
+	std::string tmp = path + ".XXXXXX";
+	const char *p;
+	size_t remaining;
+	ssize_t written;
+	int fd;
+
+	checkpoint.encode(buffer);
+
+	fd = ::mkstemp(&tmp[0]);
+	if (fd < 0)
+	{
+		throw std::runtime_error("TransientCache::store : cannot create " + tmp);
+	}
+	p = buffer.data();
+	remaining = buffer.size();
+	while (remaining > 0)
+	{
+		written = ::write(fd, p, remaining);
+		if ( (written < 0) && (errno == EINTR) )
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			::close(fd);
+			::unlink(tmp.c_str());
+			throw std::runtime_error("TransientCache::store : cannot write " + tmp);
+		}
+		p += written;
+		remaining -= (size_t)written;
+	}
+	if ( (::fchmod(fd, 0644) != 0) | (::close(fd) != 0) )
+	{
+		::unlink(tmp.c_str());
+		throw std::runtime_error("TransientCache::store : cannot write " + tmp);
+	}
+	if (::rename(tmp.c_str(), path.c_str()) != 0)
+	{
+		::unlink(tmp.c_str());
+		throw std::runtime_error("TransientCache::store : cannot rename " + tmp);
+	}
+	return;
+}
+
+template<typename T>
+inline unsigned long TransientCache<T>::gethits(void) const
+{
+	return this->hits;
+}
+
+template<typename T>
+inline unsigned long TransientCache<T>::getmisses(void) const
+{
+	return this->misses;
+}
+
+#endif
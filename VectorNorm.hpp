@@ -0,0 +1,177 @@
+#ifndef __VECTORNORM_HPP__
+#define __VECTORNORM_HPP__
+
+/* 	VectorNorm.hpp
+ *
+ * Copyright Adrien KERFOURN (2014)
+ *
+ * This software is governed by the CeCILL-C license under French law and
+ * abiding by the rules of distribution of free software.  You can  use, 
+ * modify and/ or redistribute the software under the terms of the CeCILL-C
+ * license as circulated by CEA, CNRS and INRIA at the following URL
+ * "http://www.cecill.info". 
+ * 
+ * As a counterpart to the access to the source code and  rights to copy,
+ * modify and redistribute granted by the license, users are provided only
+ * with a limited warranty  and the software's author,  the holder of the
+ * economic rights,  and the successive licensors  have only  limited
+ * liability. 
+ * 
+ * In this respect, the user's attention is drawn to the risks associated
+ * with loading,  using,  modifying and/or developing or reproducing the
+ * software by the user in light of its specific status of free software,
+ * that may mean  that it is complicated to manipulate,  and  that  also
+ * therefore means  that it is reserved for developers  and  experienced
+ * professionals having in-depth computer knowledge. Users are therefore
+ * encouraged to load and test the software's suitability as regards their
+ * requirements in conditions enabling the security of their systems and/or 
+ * data to be ensured and,  more generally, to use and operate it in the 
+ * same conditions as regards security. 
+ * 
+ * The fact that you are presently reading this means that you have had
+ * knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *
+ *
+ *		Normes et tests de vecteurs contigus, écrits pour être vectorisés par
+ * le compilateur (SSE, AVX, NEON selon la cible) : boucles simples sur des
+ * tableaux, sans branchement ni sortie anticipée. Les tests d'arrêt
+ * (SimulationPredicate.hpp) les appellent sur le vecteur d'état complet.
+ *		/!\ Avec "-ffast-math", le compilateur suppose qu'il n'y a ni NaN ni
+ * infini : "finite" n'est alors plus fiable.
+ *		"maxabs" et "maxabsdiff" propagent les NaN (un NaN en entrée donne NaN) :
+ * une comparaison "<= tolerance" sur leur résultat est alors fausse, comme
+ * pour un état qui a divergé.
+ *
+ */
+
+#include <stddef.h>
+
+template<typename T>
+class VectorNorm
+{
+	public:
+		/* Nombre d'accumulateurs indépendants : sans "-ffast-math", le
+		 * compilateur ne réordonne pas une réduction flottante ; des
+		 * accumulateurs séparés (un par voie SIMD) lui permettent de
+		 * vectoriser sans changer le résultat.
+		 */
+		static const size_t lanes = 8;
+
+		/* max |x[i]| */
+		static inline T maxabs(const T *x, const size_t n)
+		{
+			T m[lanes] = {}, a;
+			size_t i = 0;
+
+			for (; i + lanes <= n; i += lanes)
+			{
+				for (size_t k = 0; k < lanes; ++k)
+				{
+					a = (x[i+k] < (T)0) ? -x[i+k] : x[i+k];
+					m[k] = ( (a > m[k]) || (a != a) ) ? a : m[k];
+				}
+			}
+			for (; i < n; ++i)
+			{
+				a = (x[i] < (T)0) ? -x[i] : x[i];
+				m[0] = ( (a > m[0]) || (a != a) ) ? a : m[0];
+			}
+			return reducemax(m);
+		}
+
+		/* max |x[i] - y[i]| */
+		static inline T maxabsdiff(const T *x, const T *y, const size_t n)
+		{
+			T m[lanes] = {}, a;
+			size_t i = 0;
+
+			for (; i + lanes <= n; i += lanes)
+			{
+				for (size_t k = 0; k < lanes; ++k)
+				{
+					a = x[i+k] - y[i+k];
+					a = (a < (T)0) ? -a : a;
+					m[k] = ( (a > m[k]) || (a != a) ) ? a : m[k];
+				}
+			}
+			for (; i < n; ++i)
+			{
+				a = x[i] - y[i];
+				a = (a < (T)0) ? -a : a;
+				m[0] = ( (a > m[0]) || (a != a) ) ? a : m[0];
+			}
+			return reducemax(m);
+		}
+
+		/* somme des x[i]^2 */
+		static inline T squared(const T *x, const size_t n)
+		{
+			T s[lanes] = {}, r = (T)0;
+			size_t i = 0;
+
+			for (; i + lanes <= n; i += lanes)
+			{
+				for (size_t k = 0; k < lanes; ++k)
+				{
+					s[k] += x[i+k] * x[i+k];
+				}
+			}
+			for (; i < n; ++i)
+			{
+				s[0] += x[i] * x[i];
+			}
+			for (size_t k = 0; k < lanes; ++k)
+			{
+				r += s[k];
+			}
+			return r;
+		}
+
+		/* Toutes les valeurs sont finies et |x[i]| <= bound. Un NaN ou un
+		 * infini rend "x[i] * 0" non nul (NaN), ce qui se détecte sans
+		 * branchement.
+		 */
+		static inline bool finite(const T *x, const size_t n, const T bound)
+		{
+			T nan[lanes] = {}, m[lanes] = {}, a, r = (T)0;
+			size_t i = 0;
+
+			for (; i + lanes <= n; i += lanes)
+			{
+				for (size_t k = 0; k < lanes; ++k)
+				{
+					nan[k] += x[i+k] * (T)0;
+					a = (x[i+k] < (T)0) ? -x[i+k] : x[i+k];
+					m[k] = (a > m[k]) ? a : m[k];
+				}
+			}
+			for (; i < n; ++i)
+			{
+				nan[0] += x[i] * (T)0;
+				a = (x[i] < (T)0) ? -x[i] : x[i];
+				m[0] = (a > m[0]) ? a : m[0];
+			}
+			for (size_t k = 0; k < lanes; ++k)
+			{
+				r += nan[k];
+			}
+			return (r == (T)0) && (reducemax(m) <= bound);
+		}
+
+	protected:
+		static inline T reducemax(const T *m)
+		/*    Maximum des accumulateurs, NaN si l'un d'eux l'est.
+		 */
+		{
+			T r = m[0];
+			for (size_t k = 1; k < lanes; ++k)
+			{
+				r = ( (m[k] > r) || (m[k] != m[k]) ) ? m[k] : r;
+			}
+			return r;
+		}
+};
+
+
+#endif
@@ -57,6 +57,8 @@
  *
  */
 
+#include <typeinfo>
+
 #include "DynamicalSystem.hpp"
 
 template<typename T>
@@ -74,6 +76,8 @@ class Rossler: public DynamicalSystem<T>
 		inline void changeparameters(T a, T b, T c);
 
 		virtual void f(T t, SystemStates<T>& x);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 
@@ -115,5 +119,19 @@ void Rossler<T>::f(T t, SystemStates<T>& x)
 	return;
 }
 
+template<typename T>
+bool Rossler<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(Rossler<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add(this->a);
+	fingerprint.add(this->b);
+	fingerprint.add(this->c);
+	return true;
+}
+
 #endif
 
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+
+#include "examples/Rossler/Rossler.hpp"
+#include "RungeKutta4.hpp"
+#include "Sweep.hpp"
+
+/*	Diagramme de bifurcation du système de Rössler selon le paramètre c
+ * (maxima de x), calculé sur tous les cœurs et écrit dans "out.bin".
+ */
+class RosslerFactory: public SweepFactory<double>
+{
+	public:
+		DynamicalSystem<double> *system(void)
+		{
+			Rossler<double> *ross = new Rossler<double>(0.2, 0.2, 5.7);
+			ross->x(0) = 1.0;
+			ross->x(1) = 1.0;
+			ross->x(2) = 0.0;
+			return ross;
+		}
+
+		Integrator<double> *integrator(void)
+		{
+			return new RungeKutta4<double>(1e-2);
+		}
+
+		void parameters(DynamicalSystem<double> &system, const double c, const double unused)
+		{
+			static_cast< Rossler<double>& >(system).changeparameters(0.2, 0.2, c);
+			return;
+		}
+};
+
+int main(void)
+{
+	RosslerFactory factory;
+	ExtremaExtractor<double> maxima(0, ExtremaExtractor<double>::MAXIMA, 100);
+	ThreadPool pool;
+
+	std::vector<double> c;
+	for (int i = 0; i < 1000; ++i)
+	{
+		c.push_back(2.0 + i * 0.005);
+	}
+
+	Sweep<double> sweep(factory, maxima);
+	sweep.grid(c);
+	sweep.duration(500.0, 500.0);
+	sweep.run(pool);
+
+	std::ofstream binfile("out.bin", std::ios::out | std::ios::trunc | std::ios::binary);
+
+	if (binfile)
+	{
+		sweep.getresult().write(binfile);
+		binfile.close();
+	}
+	else
+	{
+		std::cerr << "Erreur à l'ouverture du fichier !" << std::endl;
+	}
+
+	return 0;
+}
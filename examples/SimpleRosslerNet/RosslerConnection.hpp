@@ -33,6 +33,8 @@
  *
  */
 
+#include <typeinfo>
+
 #include "Connection.hpp"
 
 template<typename T>
@@ -49,6 +51,8 @@ class RosslerConnection: public Connection<T>
 		virtual ~RosslerConnection(void){};
 
 		T operator()(void);
+
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
 };
 
 template<typename T>
@@ -67,5 +71,19 @@ T RosslerConnection<T>::operator()(void)
 	return K*( this->network->x(this->i) - this->network->x(this->j) );
 }
 
+template<typename T>
+bool RosslerConnection<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(RosslerConnection<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add(this->i);
+	fingerprint.add(this->j);
+	fingerprint.add(this->K);
+	return true;
+}
+
 #endif
 
@@ -33,6 +33,8 @@
  *
  */
 
+#include <typeinfo>
+
 #include "LocalSystem.hpp"
 #include "GainCoupling.hpp"
 #include <iostream>
@@ -66,6 +68,8 @@ class LRossler: public LocalSystem<T>
 		virtual inline size_type sizex(void){return (size_type)3;};
 		virtual inline size_type sizey(void){return (size_type)0;};
 
+		virtual bool fingerprint(Fingerprint &fingerprint) const;
+
 };
 
 
@@ -79,6 +83,21 @@ inline void LRossler<T>::changeparameters(T a, T b, T c)
 }
 
 
+template<typename T>
+bool LRossler<T>::fingerprint(Fingerprint &fingerprint) const
+{
+	if (typeid(*this) != typeid(LRossler<T>))
+	{
+		return false;
+	}
+	fingerprint.add(typeid(*this).name());
+	fingerprint.add(this->a);
+	fingerprint.add(this->b);
+	fingerprint.add(this->c);
+	return true;
+}
+
+
 template<typename T>
 void LRossler<T>::localf(T t)
 {